@@ -0,0 +1,127 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Checks and microbenchmark for the add/max kernels used in cost
+ * aggregation: repeatedly sum up and take the maximum of many small
+ * cost arrays, with a typical number of event types.
+ * Run with e.g. "-tickcounter" for more precise numbers.
+ */
+
+#include <QTest>
+#include <QVector>
+
+#include "costkernels.h"
+
+Q_DECLARE_METATYPE(CostKernels::Implementation)
+
+class CostKernelsBenchmark: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void check_data() { kernelData(); }
+    void check();
+    void bench_data() { kernelData(); }
+    void bench();
+
+private:
+    void kernelData();
+
+    static const int events = 16, arrays = 4096;
+    QVector<SubCost> _src;
+};
+
+void CostKernelsBenchmark::initTestCase()
+{
+    _src.resize(events * arrays);
+    for(int i=0; i<_src.size(); i++)
+        _src[i] = (uint64)(i * 2654435761u) % 100000;
+
+    // values with top bit set check for unsigned comparison in max
+    _src[1] = 0x8000000000000001ULL;
+    _src[events + 2] = 0xffffffff00000000ULL;
+    _src[2*events + 3] = 0x00000000ffffffffULL;
+}
+
+void CostKernelsBenchmark::cleanupTestCase()
+{
+    CostKernels::setImplementation(CostKernels::best());
+}
+
+// one row per implementation supported by the CPU
+void CostKernelsBenchmark::kernelData()
+{
+    QTest::addColumn<CostKernels::Implementation>("impl");
+
+    for(int impl = 0; impl < CostKernels::ImplementationCount; impl++) {
+        CostKernels::Implementation i = (CostKernels::Implementation) impl;
+        if (CostKernels::isSupported(i))
+            QTest::newRow(CostKernels::name(i)) << i;
+    }
+}
+
+// results have to match a plain loop, also for odd lengths
+void CostKernelsBenchmark::check()
+{
+    QFETCH(CostKernels::Implementation, impl);
+    QVERIFY(CostKernels::setImplementation(impl));
+    QCOMPARE(CostKernels::implementation(), impl);
+
+    for(int n = 1; n <= events; n++) {
+        QVector<uint64> sum(n, 0), max(n, 0);
+        QVector<SubCost> ksum(n), kmax(n);
+        for(int a=0; a<arrays; a++) {
+            const SubCost* src = _src.constData() + a*events;
+            for(int i=0; i<n; i++) {
+                sum[i] += (uint64) src[i];
+                if (max[i] < (uint64) src[i]) max[i] = src[i];
+            }
+            CostKernels::add(ksum.data(), src, n);
+            CostKernels::max(kmax.data(), src, n);
+        }
+        for(int i=0; i<n; i++) {
+            QCOMPARE((uint64) ksum[i], sum[i]);
+            QCOMPARE((uint64) kmax[i], max[i]);
+        }
+    }
+}
+
+void CostKernelsBenchmark::bench()
+{
+    QFETCH(CostKernels::Implementation, impl);
+    QVERIFY(CostKernels::setImplementation(impl));
+
+    QVector<SubCost> sum(events), max(events);
+    QBENCHMARK {
+        for(int a=0; a<arrays; a++) {
+            const SubCost* src = _src.constData() + a*events;
+            CostKernels::add(sum.data(), src, events);
+            CostKernels::max(max.data(), src, events);
+        }
+    }
+    // use results to keep the loops from being optimized away
+    QVERIFY((uint64) max[1] == 0x8000000000000001ULL);
+    QVERIFY((uint64) sum[0] > 0);
+}
+
+QTEST_GUILESS_MAIN(CostKernelsBenchmark)
+
+#include "costkernelsbenchmark.moc"
@@ -0,0 +1,148 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Benchmark of the phases needed to show the function list of a
+ * synthetic profile: loading, cycle detection, cost update, and
+ * sorting in FunctionListModel. Phases are timed separately: cycles
+ * are switched off while loading, as they otherwise are detected at
+ * the end of each load.
+ */
+
+#include <QBuffer>
+#include <QTest>
+
+#include "tracedata.h"
+#include "loader.h"
+#include "globalconfig.h"
+#include "functionlistmodel.h"
+#include "profilegenerator.h"
+
+class FunctionListBenchmark: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void load();
+    void cycles();
+    void update();
+    void sort_data();
+    void sort();
+
+private:
+    // load <_profile> without cycle detection
+    TraceData* loadProfile();
+
+    QByteArray _profile;
+    TraceData* _data;
+    bool _showCycles;
+};
+
+void FunctionListBenchmark::initTestCase()
+{
+    Loader::initLoaders();
+    _showCycles = GlobalConfig::showCycles();
+
+    ProfileGenerator generator;
+    QVERIFY(generator.setSpecification(
+                QStringLiteral("functions=10000,backcalls=0.05")));
+    QBuffer buffer(&_profile);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(generator.write(&buffer));
+
+    _data = loadProfile();
+    QVERIFY(_data->functionMap().count() > 0);
+}
+
+void FunctionListBenchmark::cleanupTestCase()
+{
+    delete _data;
+    GlobalConfig::setShowCycles(_showCycles);
+}
+
+TraceData* FunctionListBenchmark::loadProfile()
+{
+    GlobalConfig::setShowCycles(false);
+    TraceData* d = new TraceData;
+    d->setWriteCache(false);
+    QBuffer buffer(&_profile);
+    d->load(&buffer, QStringLiteral("synthetic.out"));
+    GlobalConfig::setShowCycles(true);
+    return d;
+}
+
+void FunctionListBenchmark::load()
+{
+    QBENCHMARK {
+        delete loadProfile();
+    }
+}
+
+void FunctionListBenchmark::cycles()
+{
+    QBENCHMARK {
+        _data->updateFunctionCycles();
+    }
+}
+
+// inclusive costs and call counts, as shown in the list
+void FunctionListBenchmark::update()
+{
+    EventType* et = _data->eventTypes()->realType(0);
+    QBENCHMARK {
+        _data->invalidateDynamicCost();
+        TraceFunctionMap::Iterator it;
+        for(it = _data->functionMap().begin();
+            it != _data->functionMap().end(); ++it) {
+            (*it).inclusive()->subCost(et);
+            (*it).calledCount();
+        }
+    }
+}
+
+void FunctionListBenchmark::sort_data()
+{
+    QTest::addColumn<int>("column");
+
+    QTest::newRow("inclusive") << 0;
+    QTest::newRow("self") << 1;
+    QTest::newRow("called") << 2;
+    QTest::newRow("name") << 3;
+}
+
+// switching the order sorts the whole candidate list each time
+void FunctionListBenchmark::sort()
+{
+    QFETCH(int, column);
+
+    EventType* et = _data->eventTypes()->realType(0);
+    FunctionListModel model;
+    model.resetModelData(_data, nullptr, QString(), et);
+
+    QBENCHMARK {
+        model.sort(column, Qt::AscendingOrder);
+        model.sort(column, Qt::DescendingOrder);
+    }
+    QVERIFY(model.rowCount() > 0);
+}
+
+QTEST_GUILESS_MAIN(FunctionListBenchmark)
+
+#include "functionlistbenchmark.moc"
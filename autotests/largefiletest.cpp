@@ -0,0 +1,174 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Regression test for profile data files larger than 4 GB
+ *
+ * Loading such a file parses the whole hole in it, which takes long
+ * and fills the page cache: this is only done if the environment
+ * variable KCACHEGRIND_LONG_TESTS is set.
+ */
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "tracedata.h"
+#include "loader.h"
+#include "utils.h"
+
+// profile data after the hole starts beyond this offset
+static const uint64 holeEnd = 0x100000000ULL + 4096;
+
+class LargeFileTest: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void positions();
+    void offset();
+    void load();
+
+private:
+    QTemporaryDir _dir;
+    QString _filename;
+};
+
+/*
+ * A callgrind file with a comment line containing a hole of more
+ * than 4 GB: as sparse file, this does not need any disk space.
+ */
+void LargeFileTest::initTestCase()
+{
+    if (sizeof(void*) < 8)
+        QSKIP("Files larger than 4 GB cannot be mapped on 32-bit hosts");
+
+    Loader::initLoaders();
+
+    QVERIFY(_dir.isValid());
+    _filename = _dir.filePath(QStringLiteral("callgrind.out.large"));
+
+    QFile file(_filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("# callgrind format\n"
+               "version: 1\n"
+               "creator: largefiletest\n"
+               "positions: instr line\n"
+               "events: Ir\n"
+               "ob=large\n"
+               "fl=large.c\n"
+               "fn=before\n"
+               "0x1000 1 7\n"
+               "# hole:");
+    if (!file.resize(holeEnd) || !file.seek(holeEnd))
+        QSKIP("Cannot create sparse file larger than 4 GB");
+    file.write("\n"
+               "fn=after4g\n"
+               "0x123456789a 20 5000000000\n"
+               "cfn=before\n"
+               "calls=3 0x1000 1\n"
+               "0x123456789b 21 21\n");
+    file.close();
+    QVERIFY(file.size() > (qint64) holeEnd);
+}
+
+// seek to and read lines beyond 4 GB without scanning the hole
+void LargeFileTest::positions()
+{
+    QFile file(_filename);
+    FixFile f(&file, _filename);
+    QVERIFY(f.exists());
+    QCOMPARE(f.len(), (uint64) file.size());
+
+    FixString line;
+    QVERIFY(f.nextLine(line));
+    QVERIFY(line.stripPrefix("# callgrind format"));
+
+    // the line starts right after the hole and its newline
+    QVERIFY(f.setCurrent(holeEnd + 1));
+    QCOMPARE(f.current(), (uint64) holeEnd + 1);
+    QVERIFY(f.nextLine(line));
+    QVERIFY(line.stripPrefix("fn=after4g"));
+    QCOMPARE(f.current(), (uint64) holeEnd + 12);
+
+    QVERIFY(f.nextLine(line));
+    Addr addr;
+    QVERIFY(addr.set(line));
+    QCOMPARE(addr.value(), (uint64) 0x123456789aULL);
+
+    QVERIFY(!f.setCurrent(f.len() + 1));
+}
+
+// only the data after the current position of the file is mapped
+void LargeFileTest::offset()
+{
+    QFile file(_filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.seek(holeEnd + 1));
+
+    FixFile f(&file, _filename);
+    QVERIFY(f.exists());
+    QCOMPARE(f.len(), (uint64) file.size() - holeEnd - 1);
+
+    FixString line;
+    QVERIFY(f.nextLine(line));
+    QVERIFY(line.stripPrefix("fn=after4g"));
+    QVERIFY(f.nextLine(line));
+    Addr addr;
+    QVERIFY(addr.set(line));
+    QCOMPARE(addr.value(), (uint64) 0x123456789aULL);
+}
+
+void LargeFileTest::load()
+{
+    if (!qEnvironmentVariableIsSet("KCACHEGRIND_LONG_TESTS"))
+        QSKIP("Parses more than 4 GB, set KCACHEGRIND_LONG_TESTS to run");
+
+    TraceData d;
+    d.setWriteCache(false);
+    QCOMPARE(d.load(_filename), 1);
+
+    EventType* ir = d.eventTypes()->realType(0);
+    QVERIFY(ir);
+
+    TraceFunction* before = nullptr;
+    TraceFunction* after = nullptr;
+    TraceFunctionMap::Iterator it;
+    for(it = d.functionMap().begin(); it != d.functionMap().end(); ++it) {
+        if ((*it).name() == QLatin1String("before")) before = &(*it);
+        if ((*it).name() == QLatin1String("after4g")) after = &(*it);
+    }
+    QVERIFY(before);
+    QVERIFY(after);
+
+    QCOMPARE((uint64) before->subCost(ir), (uint64) 7);
+    QCOMPARE((uint64) after->subCost(ir), (uint64) 5000000000ULL);
+    QCOMPARE((uint64) after->inclusive()->subCost(ir), (uint64) 5000000021ULL);
+    QVERIFY(after->instrMap()->contains(Addr(0x123456789aULL)));
+
+    QCOMPARE(after->callings().count(), 1);
+    TraceCall* call = after->callings().first();
+    QCOMPARE(call->called(), before);
+    QCOMPARE((uint64) call->callCount(), (uint64) 3);
+    QCOMPARE((uint64) call->subCost(ir), (uint64) 21);
+}
+
+QTEST_GUILESS_MAIN(LargeFileTest)
+
+#include "largefiletest.moc"
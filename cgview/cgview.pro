@@ -14,3 +14,11 @@ SOURCES += main.cpp
 
 # makes headers visible in qt-creator
 HEADERS += $$NHEADERS
+
+# query server mode (--serve) needs QtNetwork
+qtHaveModule(network) {
+    QT += network
+    DEFINES += HAVE_QTNETWORK
+    SOURCES += queryserver.cpp
+    HEADERS += queryserver.h
+}
@@ -16,14 +16,31 @@
    Boston, MA 02110-1301, USA.
 */
 
+#include <algorithm>
+
+#include <QAtomicInt>
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QTextStream>
+#include <QVector>
 
 #include "tracedata.h"
 #include "loader.h"
 #include "config.h"
 #include "globalconfig.h"
 #include "logger.h"
+#include "foldedwriter.h"
+#include "callgrindwriter.h"
+#include "reportwriter.h"
+#include "profilediff.h"
+#ifdef HAVE_QTNETWORK
+#include "queryserver.h"
+#endif
+#include "profilegenerator.h"
+#include "stacksamples.h"
+#include "parallel.h"
 
 /*
  * Just a simple command line tool using libcore
@@ -43,11 +60,424 @@ void showHelp(QTextStream& out, bool fullHelp = true)
                " -s <ev>   Sort and show counters for event <ev>\n"
                " -c        Sort by call count\n"
                " -b        Show butterfly (callers and callees)\n"
-               " -n        Do not detect recursive cycles" << endl;
+               " -n        Do not detect recursive cycles\n"
+               " -f <file> Write folded call stacks for event to <file> and exit\n"
+               " -w <file> Write all parts merged in callgrind format to <file> and exit\n"
+               " -p        With -w, write parts separately instead of merged\n"
+               " -o <obj>  With -w, only write functions of ELF object <obj>\n"
+               " -m <file> Merge all files into one part written to <file> and exit\n"
+               " -t <n>    Show the <n> items with highest cost (default 50, 0: all)\n"
+               " -g <grp>  Group by 'function' (default), 'object', 'file' or 'class'\n"
+               "           (machine readable formats only)\n"
+               " --format=<fmt> Output as 'text' (default), 'json', 'csv' or 'ndjson'\n"
+               " --diff    Compare functions of two profiles <base> <current>,\n"
+               "           sorted by largest regression. Exit code is 2 if\n"
+               "   --max-total=<pct>    total cost grew by more than <pct> percent\n"
+               "   --max-function=<pct> a function grew by more than <pct> percent\n"
+               "                        of the base total\n"
+               " --serve <socket> Answer JSON queries on local socket (see queryserver.h)\n"
+               " --generate <file> Write a synthetic profile to <file> and exit, with\n"
+               "   --spec=<name>=<value>,... parameters (see libcore/profilegenerator.h)\n"
+               " --bench <json> Benchmark loading and updates of all files, results\n"
+               "           written as JSON to file <json> ('-' for stdout)\n"
+               "   --rounds=<n>  Number of runs per file (default 3)\n"
+               " --stats   Print statistics of loading to stderr\n"
+               " --no-cache Do not write cache files for large profile data" << endl;
 
     exit(1);
 }
 
+/*
+ * Logger keeping statistics of loads, for printing with --stats
+ */
+class StatsLogger: public Logger
+{
+public:
+    void loadStats(const LoadStats& stats) override { _stats.append(stats); }
+    void print(QTextStream& out);
+
+private:
+    QList<LoadStats> _stats;
+};
+
+void StatsLogger::print(QTextStream& out)
+{
+    foreach(const LoadStats& s, _stats) {
+        out << "Load statistics for " << s.name << ":\n";
+        for(int i = 0; i < s.phases.count(); i++)
+            out << "  " << s.phases.at(i).first.leftJustified(12)
+                << QString::number(s.phases.at(i).second, 'f', 3) << " ms\n";
+        out << "  input       " << SubCost((uint64) s.bytes).pretty() << " bytes, "
+            << SubCost((uint64) s.lines).pretty() << " lines\n"
+            << "  cost items  " << s.parts << " parts, "
+            << SubCost(s.functions).pretty() << " functions, "
+            << SubCost(s.calls).pretty() << " calls\n"
+            << "  fix pool    " << SubCost((uint64) s.poolObjects).pretty() << " objects, "
+            << SubCost((uint64) s.poolBytes).pretty() << " bytes in "
+            << s.poolChunks << " chunks\n"
+            << "  peak RSS    " << SubCost((uint64) s.peakRSS).pretty() << " bytes" << endl;
+    }
+}
+
+/*
+ * Merge the profile data of <files> into one part in callgrind format,
+ * as cg_merge does. Files are loaded in worker threads, and each worker
+ * folds the costs of its file into hash tables per position and frees
+ * the cost items right after loading. These per-file sums are merged
+ * in order of files, for reproducible output: memory needed depends on
+ * the number of distinct positions and the number of threads, not on
+ * the number of files.
+ */
+int mergeFiles(QTextStream& out, const QStringList& files, const QString& outFile)
+{
+    // result of a worker: costs of one file
+    struct Input {
+        StackSamples* samples;
+        LogBuffer* log;
+        int parts;
+        QString command;
+        TraceData::Arch arch;
+    };
+
+    int count = files.count();
+    QVector<Input> inputs(count);
+    QVector<QAtomicInt> done(count);
+    Input* input = inputs.data();
+    QAtomicInt* finished = done.data();
+
+    StackSamples samples;
+    Logger logger;
+    QString command;
+    TraceData::Arch arch = TraceData::ArchUnknown;
+    int partsMerged = 0;
+
+    // fold at most two files per thread ahead of merging
+    ParallelJobs jobs;
+    int window = 2 * jobs.maxThreads();
+    int next = 0, merged = 0;
+    auto startJobs = [&]() {
+        for(; (next < count) && (next - merged < window); next++) {
+            int i = next;
+            QString filename = files.at(i);
+            input[i].log = new LogBuffer;
+            jobs.add([=]() {
+                // inputs of a merge are read once: no cache files
+                TraceData* d = new TraceData(input[i].log);
+                d->setWriteCache(false);
+                QFile file(filename);
+                d->load(&file, filename);
+
+                StackSamples* s = new StackSamples;
+                input[i].parts = s->add(s->part(0), d);
+                input[i].command = d->command();
+                input[i].arch = d->architecture();
+                input[i].samples = s;
+                delete d;
+                finished[i].storeRelease(1);
+            });
+        }
+    };
+
+    // merge in order of files, for reproducible output
+    auto mergeFolded = [&]() {
+        while((merged < count) && finished[merged].loadAcquire()) {
+            Input& in = input[merged];
+            samples.merge(*in.samples);
+            partsMerged += in.parts;
+            if (command.isEmpty()) command = in.command;
+            if (in.arch != TraceData::ArchUnknown)
+                arch = in.arch;
+            delete in.samples;
+            in.log->forward(&logger);
+            delete in.log;
+            merged++;
+        }
+        startJobs();
+    };
+
+    startJobs();
+    while(merged < count)
+        jobs.wait(mergeFolded);
+
+    if (partsMerged == 0) {
+        out << "Error: No profile data found." << endl;
+        return 1;
+    }
+
+    TraceData* d = new TraceData;
+    d->setCommand(command);
+    d->setArchitecture(arch);
+    samples.addTo(d, outFile);
+
+    QFile file(outFile);
+    CallgrindWriter writer(d);
+    if (!file.open(QIODevice::WriteOnly) || !writer.write(&file)) {
+        out << "Error: Cannot write '" << outFile << "'." << endl;
+        return 1;
+    }
+    out << "Merged " << partsMerged << " parts of " << count << " files into '"
+        << outFile << "' (" << samples.frameCount() << " positions)." << endl;
+    delete d;
+    return 0;
+}
+
+// signed, with digits grouped as in SubCost::pretty()
+static QString prettyDelta(qint64 v)
+{
+    if (v < 0) return '-' + SubCost((uint64) -v).pretty();
+    return '+' + SubCost((uint64) v).pretty();
+}
+
+static QString prettyRelative(double r)
+{
+    QString s = QString::number(100.0 * r, 'f', 1) + '%';
+    return (r < 0) ? s : '+' + s;
+}
+
+/*
+ * Compare the functions of profiles <files> (base and current) loaded in
+ * parallel. Returns 2 if a threshold for a regression of the sort event
+ * is exceeded (given in percent, negative to ignore).
+ */
+int diffProfiles(QTextStream& out, const QStringList& files,
+                 const QString& showEvent, bool sortByExcl, int topCount,
+                 const QString& format, double maxTotal, double maxFunction)
+{
+    if (files.count() != 2) {
+        out << "Error: --diff needs a base and a current profile." << endl;
+        return 1;
+    }
+
+    TraceData* data[2];
+    LogBuffer* logs[2];
+    TraceData** loaded = data;
+    ParallelJobs jobs(2);
+    for(int i = 0; i < 2; i++) {
+        QString filename = files.at(i);
+        LogBuffer* log = logs[i] = new LogBuffer;
+        jobs.add([=]() {
+            TraceData* d = new TraceData(log);
+            d->setWriteCache(false);
+            d->load(filename);
+            loaded[i] = d;
+        });
+    }
+    jobs.wait();
+
+    Logger logger;
+    for(int i = 0; i < 2; i++) {
+        logs[i]->forward(&logger);
+        delete logs[i];
+        if (data[i]->parts().isEmpty()) {
+            out << "Error: No profile data found in '" << files.at(i) << "'." << endl;
+            return 1;
+        }
+    }
+
+    ProfileDiff diff(data[0], data[1]);
+    int event = showEvent.isEmpty() ? 0 : diff.eventIndex(showEvent);
+    if ((event < 0) || diff.events().isEmpty()) {
+        out << "Error: event '" << showEvent << "' not found in both profiles." << endl;
+        return 1;
+    }
+    EventType* et = data[1]->eventTypes()->type(diff.events().at(event));
+    bool inclusive = !sortByExcl;
+    diff.sort(event, inclusive);
+
+    if (format != QLatin1String("text")) {
+        ReportWriter::Format f;
+        if (!ReportWriter::format(format, f)) {
+            out << "Error: unknown output format '" << format << "'." << endl;
+            return 1;
+        }
+        ReportWriter writer(nullptr, f);
+        writer.setSortEvent(et, sortByExcl);
+        writer.setTopCount(topCount);
+        QFile file;
+        if (!file.open(stdout, QIODevice::WriteOnly) || !writer.writeDiff(&file, diff))
+            return 1;
+    }
+    else {
+        out << "Base:    " << data[0]->traceName() << "\n"
+            << "Current: " << data[1]->traceName() << "\n\n"
+            << "Totals for event types:\n"
+            << "          Base       Current           Delta     Rel.  Event\n";
+        out.setFieldAlignment(QTextStream::AlignRight);
+        for(int e = 0; e < diff.events().count(); e++) {
+            out.setFieldWidth(14);
+            out << diff.baseTotal(e).pretty() << diff.currentTotal(e).pretty()
+                << prettyDelta(diff.totalDelta(e));
+            out.setFieldWidth(9);
+            out << prettyRelative(diff.totalRelative(e));
+            out.setFieldWidth(0);
+            out << "  " << diff.events().at(e) << "\n";
+        }
+
+        out << "\nSorted by: " << (sortByExcl ? "Exclusive ":"Inclusive ")
+            << et->longName() << " (" << et->name() << ") delta\n\n"
+            << "     Incl. delta     Rel.      Self delta     Rel.  Function name (DSO)\n"
+            << " ======================================================================\n";
+
+        int count = diff.count();
+        if ((topCount > 0) && (topCount < count)) count = topCount;
+        for(int i = 0; i < count; i++) {
+            const ProfileDiff::Entry& entry = diff.entry(i);
+            TraceFunction* f = entry.current ? entry.current : entry.base;
+            out.setFieldWidth(16);
+            out << prettyDelta(diff.delta(i, event, true));
+            out.setFieldWidth(9);
+            out << (entry.base ? prettyRelative(diff.relative(i, event, true)) :
+                                 QStringLiteral("new"));
+            out.setFieldWidth(16);
+            out << prettyDelta(diff.delta(i, event, false));
+            out.setFieldWidth(9);
+            out << (entry.base ? prettyRelative(diff.relative(i, event, false)) :
+                                 QStringLiteral("new"));
+            out.setFieldWidth(0);
+            out << "  " << f->name() << " (" << f->object()->name() << ")";
+            if (!entry.current) out << " [removed]";
+            out << "\n";
+        }
+        out << flush;
+    }
+
+    // thresholds are checked relative to the base total
+    QTextStream err(stderr);
+    int result = 0;
+    double total = (double)(uint64) diff.baseTotal(event);
+    if ((maxTotal >= 0) && (100.0 * diff.totalRelative(event) > maxTotal)) {
+        err << "Regression: total " << et->name() << " grew by "
+            << prettyRelative(diff.totalRelative(event))
+            << " (threshold " << maxTotal << "%)" << endl;
+        result = 2;
+    }
+    if ((maxFunction >= 0) && (total > 0)) {
+        for(int i = 0; i < diff.count(); i++) {
+            double r = diff.delta(i, event, inclusive) / total;
+            // entries are sorted by delta
+            if (100.0 * r <= maxFunction) break;
+            const ProfileDiff::Entry& entry = diff.entry(i);
+            TraceFunction* f = entry.current ? entry.current : entry.base;
+            err << "Regression: " << f->name() << " grew by "
+                << prettyRelative(r) << " of total " << et->name()
+                << " (threshold " << maxFunction << "%)" << endl;
+            result = 2;
+        }
+    }
+    return result;
+}
+
+/*
+ * Benchmark for loading and cost updates: each file is loaded <rounds>
+ * times from memory (no disk I/O, no binary cache), and the time of the
+ * phases is measured. Results are written as JSON, for trend tracking.
+ */
+int benchLoading(QTextStream& out, const QStringList& files, int rounds,
+                 const QString& jsonFile)
+{
+    static const char* phaseNames[] = {
+        "load", "cycles", "update", "instrmap", "sort"
+    };
+    const int phases = 5;
+
+    QFile json(jsonFile);
+    bool ok = (jsonFile == QLatin1String("-")) ?
+              json.open(stdout, QIODevice::WriteOnly) :
+              json.open(QIODevice::WriteOnly);
+    if (!ok) {
+        out << "Error: Cannot write '" << jsonFile << "'." << endl;
+        return 1;
+    }
+    QTextStream js(&json);
+    js << "{\"rounds\":" << rounds << ",\"results\":[";
+
+    // cycles are detected at the end of loading if switched on:
+    // switch off while loading to time cycle detection separately
+    bool showCycles = GlobalConfig::showCycles();
+
+    for(int fi = 0; fi < files.count(); fi++) {
+        QFile file(files.at(fi));
+        if (!file.open(QIODevice::ReadOnly)) {
+            out << "Error: Cannot read '" << files.at(fi) << "'." << endl;
+            return 1;
+        }
+        QByteArray content = file.readAll();
+        file.close();
+
+        QVector<double> minTime(phases, -1.0), sumTime(phases, 0.0);
+        int functions = 0, parts = 0;
+        for(int r = 0; r < rounds; r++) {
+            double t[phases];
+            QElapsedTimer timer;
+            LogBuffer log;
+            TraceData* d = new TraceData(&log);
+
+            QBuffer buffer(&content);
+            GlobalConfig::setShowCycles(false);
+            timer.start();
+            d->load(&buffer, files.at(fi));
+            t[0] = timer.nsecsElapsed() / 1000000.0;
+
+            GlobalConfig::setShowCycles(showCycles);
+            timer.start();
+            d->updateFunctionCycles();
+            t[1] = timer.nsecsElapsed() / 1000000.0;
+
+            QVector<TraceFunction*> flist;
+            TraceFunctionMap::Iterator it;
+            for ( it = d->functionMap().begin(); it != d->functionMap().end(); ++it )
+                flist.append(&(*it));
+            EventType* et = d->eventTypes()->realType(0);
+
+            d->invalidateDynamicCost();
+            timer.start();
+            foreach(TraceFunction* f, flist) {
+                f->inclusive()->subCost(et);
+                f->calledCount();
+            }
+            t[2] = timer.nsecsElapsed() / 1000000.0;
+
+            timer.start();
+            foreach(TraceFunction* f, flist)
+                f->instrMap();
+            t[3] = timer.nsecsElapsed() / 1000000.0;
+
+            // as done for the function list, by inclusive cost
+            timer.start();
+            std::sort(flist.begin(), flist.end(), [et](TraceFunction* f1, TraceFunction* f2) {
+                return f1->inclusive()->subCost(et) > f2->inclusive()->subCost(et);
+            });
+            t[4] = timer.nsecsElapsed() / 1000000.0;
+
+            functions = flist.count();
+            parts = d->parts().count();
+            delete d;
+
+            for(int p = 0; p < phases; p++) {
+                if ((minTime[p] < 0) || (t[p] < minTime[p])) minTime[p] = t[p];
+                sumTime[p] += t[p];
+            }
+        }
+
+        js << (fi > 0 ? ",\n" : "\n") << "{\"file\":\""
+           << QString(files.at(fi)).replace('\\', QLatin1String("\\\\"))
+                                   .replace('"', QLatin1String("\\\""))
+           << "\",\"size\":" << content.size()
+           << ",\"functions\":" << functions << ",\"parts\":" << parts
+           << ",\"phases\":{";
+        for(int p = 0; p < phases; p++)
+            js << (p > 0 ? "," : "") << "\"" << phaseNames[p] << "\":{\"min_ms\":"
+               << QString::number(minTime[p], 'f', 3) << ",\"mean_ms\":"
+               << QString::number(sumTime[p] / rounds, 'f', 3) << "}";
+        js << "}}";
+        js.flush();
+    }
+    js << "\n]}\n";
+    js.flush();
+
+    return (json.error() == QFile::NoError) ? 0 : 1;
+}
+
 
 int main(int argc, char** argv)
 {
@@ -66,6 +496,20 @@ int main(int argc, char** argv)
     bool sortByCount = false;
     bool showCalls = false;
     QString showEvent;
+    QString foldedFile;
+    QString outFile;
+    QString mergeFile;
+    QString format = QStringLiteral("text");
+    QString grouping = QStringLiteral("function");
+    int topCount = 50;
+    bool diffMode = false;
+    QString serveSocket;
+    QString generateFile, generateSpec, benchFile;
+    int rounds = 3;
+    bool showStats = false;
+    double maxTotal = -1.0, maxFunction = -1.0;
+    QStringList outObjects;
+    bool mergeParts = true;
     QStringList files;
 
     for(int arg = 0; arg<list.count(); arg++) {
@@ -75,11 +519,62 @@ int main(int argc, char** argv)
         else if (list[arg] == QLatin1String("-b")) showCalls = true;
         else if (list[arg] == QLatin1String("-c")) sortByCount = true;
         else if (list[arg] == QLatin1String("-s")) showEvent = list[++arg];
+        else if (list[arg] == QLatin1String("-f")) foldedFile = list[++arg];
+        else if (list[arg] == QLatin1String("-w")) outFile = list[++arg];
+        else if (list[arg] == QLatin1String("-p")) mergeParts = false;
+        else if (list[arg] == QLatin1String("-o")) outObjects << list[++arg];
+        else if (list[arg] == QLatin1String("-m")) mergeFile = list[++arg];
+        else if (list[arg] == QLatin1String("-t")) topCount = list[++arg].toInt();
+        else if (list[arg] == QLatin1String("-g")) grouping = list[++arg];
+        else if (list[arg].startsWith(QLatin1String("--format=")))
+            format = list[arg].mid(9);
+        else if (list[arg] == QLatin1String("--diff")) diffMode = true;
+        else if (list[arg] == QLatin1String("--serve")) serveSocket = list[++arg];
+        else if (list[arg] == QLatin1String("--generate")) generateFile = list[++arg];
+        else if (list[arg].startsWith(QLatin1String("--spec=")))
+            generateSpec = list[arg].mid(7);
+        else if (list[arg] == QLatin1String("--bench")) benchFile = list[++arg];
+        else if (list[arg] == QLatin1String("--stats")) showStats = true;
+        else if (list[arg] == QLatin1String("--no-cache")) GlobalConfig::setWriteCache(false);
+        else if (list[arg].startsWith(QLatin1String("--rounds=")))
+            rounds = qMax(1, list[arg].mid(9).toInt());
+        else if (list[arg].startsWith(QLatin1String("--max-total=")))
+            maxTotal = list[arg].mid(12).toDouble();
+        else if (list[arg].startsWith(QLatin1String("--max-function=")))
+            maxFunction = list[arg].mid(15).toDouble();
         else
             files << list[arg];
     }
-    TraceData* d = new TraceData(new Logger);
+
+    if (!generateFile.isEmpty()) {
+        ProfileGenerator generator;
+        if (!generator.setSpecification(generateSpec)) {
+            out << "Error: Invalid specification '" << generateSpec << "'." << endl;
+            return 1;
+        }
+        QFile file(generateFile);
+        if (!file.open(QIODevice::WriteOnly) || !generator.write(&file)) {
+            out << "Error: Cannot write '" << generateFile << "'." << endl;
+            return 1;
+        }
+        out << "Written synthetic profile to '" << generateFile << "'." << endl;
+        return 0;
+    }
+    if (!benchFile.isEmpty())
+        return benchLoading(out, files, rounds, benchFile);
+    if (!mergeFile.isEmpty())
+        return mergeFiles(out, files, mergeFile);
+    if (diffMode)
+        return diffProfiles(out, files, showEvent, sortByExcl, topCount,
+                            format, maxTotal, maxFunction);
+
+    StatsLogger* logger = new StatsLogger;
+    TraceData* d = new TraceData(logger);
     d->load(files);
+    if (showStats) {
+        QTextStream err(stderr);
+        logger->print(err);
+    }
 
     EventTypeSet* m = d->eventTypes();
     if (m->realCount() == 0) {
@@ -87,44 +582,110 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    out << "\nTotals for event types:\n";
+    if (!outFile.isEmpty()) {
+        QFile file(outFile);
+        CallgrindWriter writer(d);
+        writer.setMergeParts(mergeParts);
+        writer.setObjects(outObjects);
+        if (!file.open(QIODevice::WriteOnly) || !writer.write(&file)) {
+            out << "Error: Cannot write '" << outFile << "'." << endl;
+            return 1;
+        }
+        out << "Written " << writer.partsWritten() << " parts to '"
+            << outFile << "'." << endl;
+        return 0;
+    }
 
     EventType* et;
+    if (showEvent.isEmpty())
+        et = m->realType(0);
+    else {
+        et = m->type(showEvent);
+        if (!et) {
+            out << "Error: event '" << showEvent << "' not found." << endl;
+            return 1;
+        }
+    }
+    Q_ASSERT( et!=nullptr );
+
+    if (!serveSocket.isEmpty()) {
+#ifdef HAVE_QTNETWORK
+        QueryServer server(d);
+        if (!server.listen(serveSocket)) {
+            out << "Error: Cannot listen on '" << serveSocket << "': "
+                << server.errorString() << endl;
+            return 1;
+        }
+        out << "Serving " << d->traceName() << " on '" << serveSocket << "'." << endl;
+        return app.exec();
+#else
+        out << "Error: --serve is not supported (built without QtNetwork)." << endl;
+        return 1;
+#endif
+    }
+
+    if (format != QLatin1String("text")) {
+        ReportWriter::Format f;
+        ReportWriter::Grouping g;
+        if (!ReportWriter::format(format, f)) {
+            out << "Error: unknown output format '" << format << "'." << endl;
+            return 1;
+        }
+        if (!ReportWriter::grouping(grouping, g)) {
+            out << "Error: unknown grouping '" << grouping << "'." << endl;
+            return 1;
+        }
+        ReportWriter writer(d, f);
+        writer.setGrouping(g);
+        writer.setSortEvent(et, sortByExcl);
+        writer.setSortByCount(sortByCount);
+        writer.setTopCount(topCount);
+        writer.setShowCalls(showCalls);
+        QFile file;
+        if (!file.open(stdout, QIODevice::WriteOnly) || !writer.write(&file))
+            return 1;
+        return 0;
+    }
+
+    out << "\nTotals for event types:\n";
+
+    EventType* t;
     for (int i=0;i<m->realCount();i++) {
-        et = m->realType(i);
+        t = m->realType(i);
         out.setFieldWidth(14);
         out.setFieldAlignment(QTextStream::AlignRight);
-        out << d->subCost(et).pretty();
+        out << d->subCost(t).pretty();
         out.setFieldWidth(0);
-        out << "   " << et->longName() << " (" << et->name() << ")\n";
+        out << "   " << t->longName() << " (" << t->name() << ")\n";
     }
     for (int i=0;i<m->derivedCount();i++) {
-        et = m->derivedType(i);
+        t = m->derivedType(i);
         out.setFieldWidth(14);
         out.setFieldAlignment(QTextStream::AlignRight);
-        out << d->subCost(et).pretty();
+        out << d->subCost(t).pretty();
         out.setFieldWidth(0);
-        out << "   " << et->longName() <<
-               " (" << et->name() << " = " << et->formula() << ")\n";
+        out << "   " << t->longName() <<
+               " (" << t->name() << " = " << t->formula() << ")\n";
     }
     out << endl;
 
-    if (showEvent.isEmpty())
-        et = m->realType(0);
-    else {
-        et = m->type(showEvent);
-        if (!et) {
-            out << "Error: event '" << showEvent << "' not found." << endl;
+    if (!foldedFile.isEmpty()) {
+        QFile file(foldedFile);
+        FoldedWriter writer(d, et);
+        if (!file.open(QIODevice::WriteOnly) || !writer.write(&file)) {
+            out << "Error: Cannot write '" << foldedFile << "'." << endl;
             return 1;
         }
+        out << "Written " << writer.lines() << " call stacks for "
+            << et->longName() << " to '" << foldedFile << "'." << endl;
+        return 0;
     }
-    Q_ASSERT( et!=nullptr );
+
     out << "Sorted by: " << (sortByExcl ? "Exclusive ":"Inclusive ")
         << et->longName() << " (" << et->name() << ")" << endl;
 
     QList<TraceFunction*> flist;
     HighestCostList hc;
-    hc.clear(50);
     TraceFunctionMap::Iterator it;
     for ( it = d->functionMap().begin(); it != d->functionMap().end(); ++it )
         flist.append(&(*it));
@@ -133,6 +694,7 @@ int main(int argc, char** argv)
     foreach(f, d->functionCycles())
         flist.append(f);
 
+    hc.clear((topCount > 0) ? topCount : flist.count());
     foreach(f, flist) {
         if (sortByCount)
             hc.addCost(f, f->calledCount());
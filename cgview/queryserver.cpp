@@ -0,0 +1,463 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Query server for profile data loaded once
+ */
+
+#include "queryserver.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStringList>
+#include <QVector>
+
+#include "tracedata.h"
+
+// answers to "top" without a count
+#define DEFAULT_TOP_COUNT 10
+
+enum { FunctionGroup, ObjectGroup, FileGroup, ClassGroup, GroupCount };
+static const char* groupNames[] = { "function", "object", "file", "class" };
+
+/*
+ * Costs of all cost items, in plain arrays which can be read by
+ * multiple threads. Costs of an item are <events> values.
+ */
+struct QueryServer::Snapshot
+{
+    QStringList events;
+    QVector<SubCost> totals;
+
+    struct Group {
+        QStringList names;
+        QVector<SubCost> self, inclusive;
+        // items with a name (functions can have the same name)
+        QHash<QString, QVector<int> > index;
+    };
+    Group groups[GroupCount];
+
+    // only for functions
+    QStringList objects, files;
+    QVector<SubCost> calledCount;
+    QVector<TraceFunction*> functions;
+
+    // calls between functions: call indexes per function
+    QVector<int> caller, called;
+    QVector<SubCost> callCount, callCost;
+    QVector<QVector<int> > callers, callees;
+};
+
+static QJsonObject costObject(const QStringList& events, const SubCost* costs)
+{
+    QJsonObject o;
+    for(int e = 0; e < events.count(); e++)
+        o.insert(events.at(e), (qint64) (uint64) costs[e]);
+    return o;
+}
+
+static QJsonObject error(const QString& msg)
+{
+    QJsonObject o;
+    o.insert(QStringLiteral("error"), msg);
+    return o;
+}
+
+static int groupIndex(const QJsonObject& query)
+{
+    QString name = query.value(QStringLiteral("grouping")).toString(QStringLiteral("function"));
+    for(int g = 0; g < GroupCount; g++)
+        if (name == QLatin1String(groupNames[g])) return g;
+    return -1;
+}
+
+
+QueryServer::QueryServer(TraceData* data)
+{
+    _data = data;
+    _server = nullptr;
+    _nextSocket = 0;
+
+    takeSnapshot();
+}
+
+QueryServer::~QueryServer()
+{
+    // running queries post their answers to the server
+    _jobs.wait();
+    delete _server;
+}
+
+bool QueryServer::listen(const QString& name)
+{
+    if (!_server) {
+        _server = new QLocalServer;
+        QObject::connect(_server, &QLocalServer::newConnection,
+                         _server, [this]() { newConnection(); });
+    }
+    // remove a socket left over from a previous run
+    QLocalServer::removeServer(name);
+    return _server->listen(name);
+}
+
+QString QueryServer::errorString() const
+{
+    return _server ? _server->errorString() : QString();
+}
+
+void QueryServer::newConnection()
+{
+    while(QLocalSocket* socket = _server->nextPendingConnection()) {
+        int id = _nextSocket++;
+        _sockets.insert(id, socket);
+
+        QObject::connect(socket, &QLocalSocket::disconnected, _server, [this, id, socket]() {
+            _sockets.remove(id);
+            socket->deleteLater();
+        });
+        QObject::connect(socket, &QLocalSocket::readyRead, _server, [this, id, socket]() {
+            while(socket->canReadLine()) {
+                QByteArray query = socket->readLine();
+                _jobs.add([this, id, query]() {
+                    QByteArray a = answer(query);
+                    // sockets are only used in the main thread
+                    QMetaObject::invokeMethod(_server, [this, id, a]() {
+                        QLocalSocket* s = _sockets.value(id);
+                        if (s) s->write(a);
+                    }, Qt::QueuedConnection);
+                });
+            }
+        });
+    }
+}
+
+QSharedPointer<const QueryServer::Snapshot> QueryServer::snapshot()
+{
+    QMutexLocker locker(&_snapshotMutex);
+    return _snapshot;
+}
+
+// needs _dataMutex locked, or no other thread running
+void QueryServer::takeSnapshot()
+{
+    Snapshot* s = new Snapshot;
+
+    EventTypeSet* types = _data->eventTypes();
+    QList<EventType*> eventTypes;
+    for(int i = 0; i < types->realCount(); i++)
+        eventTypes.append(types->realType(i));
+    for(int i = 0; i < types->derivedCount(); i++)
+        eventTypes.append(types->derivedType(i));
+    foreach(EventType* t, eventTypes) {
+        s->events.append(t->name());
+        s->totals.append(_data->subCost(t));
+    }
+
+    // item costs, and function indexes
+    QHash<TraceFunction*, int> functionIndex;
+    auto addItem = [&](int g, TraceCostItem* item) {
+        Snapshot::Group& group = s->groups[g];
+        group.index[item->name()].append(group.names.count());
+        group.names.append(item->name());
+        foreach(EventType* t, eventTypes) {
+            group.self.append(item->subCost(t));
+            group.inclusive.append(item->inclusive()->subCost(t));
+        }
+    };
+
+    TraceFunctionMap::Iterator fit;
+    for ( fit = _data->functionMap().begin();
+          fit != _data->functionMap().end(); ++fit ) {
+        TraceFunction* f = &(*fit);
+        functionIndex.insert(f, s->functions.count());
+        addItem(FunctionGroup, f);
+        s->functions.append(f);
+        s->objects.append(f->object()->name());
+        s->files.append(f->file()->name());
+        s->calledCount.append(f->calledCount());
+    }
+    TraceObjectMap::Iterator oit;
+    for ( oit = _data->objectMap().begin(); oit != _data->objectMap().end(); ++oit )
+        addItem(ObjectGroup, &(*oit));
+    TraceFileMap::Iterator fiit;
+    for ( fiit = _data->fileMap().begin(); fiit != _data->fileMap().end(); ++fiit )
+        addItem(FileGroup, &(*fiit));
+    TraceClassMap::Iterator cit;
+    for ( cit = _data->classMap().begin(); cit != _data->classMap().end(); ++cit )
+        addItem(ClassGroup, &(*cit));
+
+    s->callers.resize(s->functions.count());
+    s->callees.resize(s->functions.count());
+    for(int i = 0; i < s->functions.count(); i++) {
+        foreach(TraceCall* c, s->functions.at(i)->callings()) {
+            int called = functionIndex.value(c->called(true), -1);
+            if (called < 0) continue;
+            int index = s->caller.count();
+            s->caller.append(i);
+            s->called.append(called);
+            s->callCount.append(c->callCount());
+            foreach(EventType* t, eventTypes)
+                s->callCost.append(c->subCost(t));
+            s->callees[i].append(index);
+            s->callers[called].append(index);
+        }
+    }
+
+    QMutexLocker locker(&_snapshotMutex);
+    _snapshot = QSharedPointer<const Snapshot>(s);
+}
+
+QByteArray QueryServer::answer(const QByteArray& query)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(query, &parseError);
+    QJsonObject q = doc.object();
+    QJsonObject a;
+
+    if (parseError.error != QJsonParseError::NoError)
+        a = error(parseError.errorString());
+    else if (!doc.isObject())
+        a = error(QStringLiteral("query is not an object"));
+    else {
+        QSharedPointer<const Snapshot> s = snapshot();
+        QString type = q.value(QStringLiteral("query")).toString();
+        if (type == QLatin1String("info")) a = info(*s);
+        else if (type == QLatin1String("top")) a = top(*s, q);
+        else if (type == QLatin1String("calls")) a = calls(*s, q);
+        else if (type == QLatin1String("group")) a = group(*s, q);
+        else if (type == QLatin1String("activate")) a = activate(q);
+        else if (type == QLatin1String("lines")) a = lines(*s, q);
+        else a = error(QStringLiteral("unknown query '%1'").arg(type));
+    }
+
+    if (q.contains(QStringLiteral("id")))
+        a.insert(QStringLiteral("id"), q.value(QStringLiteral("id")));
+    return QJsonDocument(a).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QJsonObject QueryServer::info(const Snapshot& s)
+{
+    QJsonObject a;
+    QJsonArray events;
+    for(int e = 0; e < s.events.count(); e++) {
+        QJsonObject o;
+        o.insert(QStringLiteral("name"), s.events.at(e));
+        o.insert(QStringLiteral("total"), (qint64) (uint64) s.totals.at(e));
+        events.append(o);
+    }
+    a.insert(QStringLiteral("events"), events);
+
+    // parts are not changed after loading
+    QJsonArray parts;
+    int index = 0;
+    QMutexLocker locker(&_dataMutex);
+    foreach(TracePart* p, _data->parts()) {
+        QJsonObject o;
+        o.insert(QStringLiteral("index"), index++);
+        o.insert(QStringLiteral("name"), p->prettyName());
+        o.insert(QStringLiteral("active"), p->isActive());
+        parts.append(o);
+    }
+    a.insert(QStringLiteral("parts"), parts);
+    a.insert(QStringLiteral("functions"), s.functions.count());
+    return a;
+}
+
+QJsonObject QueryServer::top(const Snapshot& s, const QJsonObject& query)
+{
+    int g = groupIndex(query);
+    if (g < 0) return error(QStringLiteral("unknown grouping"));
+    int event = s.events.indexOf(query.value(QStringLiteral("event")).toString(s.events.value(0)));
+    if (event < 0) return error(QStringLiteral("unknown event"));
+    bool exclusive = query.value(QStringLiteral("exclusive")).toBool(false);
+
+    const Snapshot::Group& group = s.groups[g];
+    int events = s.events.count();
+    const QVector<SubCost>& costs = exclusive ? group.self : group.inclusive;
+    QVector<int> order(group.names.count());
+    for(int i = 0; i < order.count(); i++)
+        order[i] = i;
+    int count = query.value(QStringLiteral("count")).toInt(DEFAULT_TOP_COUNT);
+    if ((count <= 0) || (count > order.count())) count = order.count();
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [&](int i1, int i2) {
+        SubCost c1 = costs.at(i1 * events + event);
+        SubCost c2 = costs.at(i2 * events + event);
+        return (c1 > c2) || ((c1 == c2) && (i1 < i2));
+    });
+
+    QJsonArray items;
+    for(int i = 0; i < count; i++) {
+        int item = order.at(i);
+        QJsonObject o;
+        o.insert(QStringLiteral("name"), group.names.at(item));
+        if (g == FunctionGroup) {
+            o.insert(QStringLiteral("object"), s.objects.at(item));
+            o.insert(QStringLiteral("file"), s.files.at(item));
+            o.insert(QStringLiteral("called"), (qint64) (uint64) s.calledCount.at(item));
+        }
+        o.insert(QStringLiteral("exclusive"),
+                 costObject(s.events, group.self.constData() + item * events));
+        o.insert(QStringLiteral("inclusive"),
+                 costObject(s.events, group.inclusive.constData() + item * events));
+        items.append(o);
+    }
+
+    QJsonObject a;
+    a.insert(QStringLiteral("items"), items);
+    return a;
+}
+
+// functions with name of query, optionally only in an object
+QVector<int> QueryServer::findFunctions(const Snapshot& s, const QJsonObject& query)
+{
+    QVector<int> functions;
+    QString object = query.value(QStringLiteral("object")).toString();
+    foreach(int f, s.groups[FunctionGroup].index.value(query.value(QStringLiteral("function")).toString()))
+        if (object.isEmpty() || (s.objects.at(f) == object))
+            functions.append(f);
+    return functions;
+}
+
+QJsonObject QueryServer::calls(const Snapshot& s, const QJsonObject& query)
+{
+    QVector<int> found = findFunctions(s, query);
+    if (found.isEmpty()) return error(QStringLiteral("function not found"));
+
+    int events = s.events.count();
+    auto callList = [&](const QVector<int>& calls, bool callers) {
+        QJsonArray list;
+        foreach(int c, calls) {
+            int f = callers ? s.caller.at(c) : s.called.at(c);
+            QJsonObject o;
+            o.insert(QStringLiteral("name"), s.groups[FunctionGroup].names.at(f));
+            o.insert(QStringLiteral("object"), s.objects.at(f));
+            o.insert(QStringLiteral("count"), (qint64) (uint64) s.callCount.at(c));
+            o.insert(QStringLiteral("cost"),
+                     costObject(s.events, s.callCost.constData() + c * events));
+            list.append(o);
+        }
+        return list;
+    };
+
+    QJsonArray functions;
+    foreach(int f, found) {
+        QJsonObject o;
+        o.insert(QStringLiteral("name"), s.groups[FunctionGroup].names.at(f));
+        o.insert(QStringLiteral("object"), s.objects.at(f));
+        o.insert(QStringLiteral("file"), s.files.at(f));
+        o.insert(QStringLiteral("callers"), callList(s.callers.at(f), true));
+        o.insert(QStringLiteral("callees"), callList(s.callees.at(f), false));
+        functions.append(o);
+    }
+
+    QJsonObject a;
+    a.insert(QStringLiteral("functions"), functions);
+    return a;
+}
+
+QJsonObject QueryServer::group(const Snapshot& s, const QJsonObject& query)
+{
+    int g = groupIndex(query);
+    if (g < 0) return error(QStringLiteral("unknown grouping"));
+
+    const Snapshot::Group& group = s.groups[g];
+    QVector<int> found = group.index.value(query.value(QStringLiteral("name")).toString());
+    if (found.isEmpty()) return error(QStringLiteral("item not found"));
+
+    // functions with same name in different objects are summed up
+    int events = s.events.count();
+    QVector<SubCost> self(events), inclusive(events);
+    foreach(int item, found)
+        for(int e = 0; e < events; e++) {
+            self[e] += group.self.at(item * events + e);
+            inclusive[e] += group.inclusive.at(item * events + e);
+        }
+
+    QJsonObject a;
+    a.insert(QStringLiteral("name"), group.names.at(found.first()));
+    a.insert(QStringLiteral("exclusive"), costObject(s.events, self.constData()));
+    a.insert(QStringLiteral("inclusive"), costObject(s.events, inclusive.constData()));
+    return a;
+}
+
+QJsonObject QueryServer::activate(const QJsonObject& query)
+{
+    QMutexLocker locker(&_dataMutex);
+
+    TracePartList all = _data->parts();
+    TracePartList parts;
+    foreach(const QJsonValue& v, query.value(QStringLiteral("parts")).toArray()) {
+        int index = v.toInt(-1);
+        if ((index < 0) || (index >= all.count()))
+            return error(QStringLiteral("invalid part index %1").arg(index));
+        parts.append(all.at(index));
+    }
+    if (parts.isEmpty()) parts = all;
+
+    _data->activateParts(parts);
+    takeSnapshot();
+
+    QJsonArray active;
+    for(int i = 0; i < all.count(); i++)
+        if (all.at(i)->isActive()) active.append(i);
+    QJsonObject a;
+    a.insert(QStringLiteral("active"), active);
+    return a;
+}
+
+QJsonObject QueryServer::lines(const Snapshot& s, const QJsonObject& query)
+{
+    QVector<int> found = findFunctions(s, query);
+    if (found.isEmpty()) return error(QStringLiteral("function not found"));
+
+    // line costs are calculated on demand in the TraceData
+    QMutexLocker locker(&_dataMutex);
+    EventTypeSet* types = _data->eventTypes();
+    QList<EventType*> eventTypes;
+    foreach(const QString& name, s.events)
+        eventTypes.append(types->type(name));
+
+    QJsonArray lines;
+    QVector<SubCost> costs(s.events.count());
+    foreach(int f, found) {
+        foreach(TraceFunctionSource* sf, s.functions.at(f)->sourceFiles()) {
+            TraceLineMap* lineMap = sf->lineMap();
+            if (!lineMap) continue;
+            TraceLineMap::Iterator it;
+            for ( it = lineMap->begin(); it != lineMap->end(); ++it ) {
+                for(int e = 0; e < eventTypes.count(); e++)
+                    costs[e] = (*it).subCost(eventTypes.at(e));
+                QJsonObject o;
+                o.insert(QStringLiteral("function"), s.groups[FunctionGroup].names.at(f));
+                o.insert(QStringLiteral("file"), sf->file()->name());
+                o.insert(QStringLiteral("line"), (int) (*it).lineno());
+                o.insert(QStringLiteral("cost"), costObject(s.events, costs.constData()));
+                lines.append(o);
+            }
+        }
+    }
+
+    QJsonObject a;
+    a.insert(QStringLiteral("lines"), lines);
+    return a;
+}
@@ -0,0 +1,103 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Query server for profile data loaded once
+ */
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "parallel.h"
+
+class QLocalServer;
+class QLocalSocket;
+class TraceData;
+
+/**
+ * Answers queries on a TraceData from clients of a local socket.
+ *
+ * Each line sent by a client is a query as JSON object, answered by one
+ * line with a JSON object. An "id" given in the query is copied into
+ * the answer, as answers can arrive in a different order than queries.
+ * Errors are answered with {"error": <message>}. Queries ("query"):
+ *
+ *  "info"     - event types with totals, parts and whether active
+ *  "top"      - items with highest cost: "event", "count" (default 10,
+ *               0 for all), "grouping" ("function", "object", "file",
+ *               "class"), "exclusive" (sort by self cost)
+ *  "calls"    - callers and callees of functions named "function"
+ *               (optionally only in "object")
+ *  "group"    - costs of object/file/class "name" of "grouping"
+ *  "activate" - only use the parts with indexes "parts" (all if empty)
+ *  "lines"    - source lines with costs of functions named "function"
+ *
+ * Queries run in worker threads, on a snapshot of all costs taken after
+ * loading and after each part activation: cost items of TraceData are
+ * updated and cached on access and cannot be read concurrently. Only
+ * "activate" and "lines" need the TraceData itself, and are serialized.
+ */
+class QueryServer
+{
+public:
+    explicit QueryServer(TraceData* data);
+    ~QueryServer();
+
+    // start listening on local socket <name>
+    bool listen(const QString& name);
+    QString errorString() const;
+
+    // answer for one query line, can be called from any thread
+    QByteArray answer(const QByteArray& query);
+
+private:
+    struct Snapshot;
+
+    void takeSnapshot();
+    QSharedPointer<const Snapshot> snapshot();
+    void newConnection();
+
+    static QVector<int> findFunctions(const Snapshot& s, const QJsonObject& query);
+    QJsonObject info(const Snapshot& s);
+    QJsonObject top(const Snapshot& s, const QJsonObject& query);
+    QJsonObject calls(const Snapshot& s, const QJsonObject& query);
+    QJsonObject group(const Snapshot& s, const QJsonObject& query);
+    QJsonObject activate(const QJsonObject& query);
+    QJsonObject lines(const Snapshot& s, const QJsonObject& query);
+
+    TraceData* _data;
+    // for access to _data
+    QMutex _dataMutex;
+    QMutex _snapshotMutex;
+    QSharedPointer<const Snapshot> _snapshot;
+
+    QLocalServer* _server;
+    QHash<int, QLocalSocket*> _sockets;
+    int _nextSocket;
+    ParallelJobs _jobs;
+};
+
+#endif // QUERYSERVER_H
@@ -151,9 +151,8 @@ ConfigDlg::ConfigDlg(GlobalGUIConfig* c, TraceData* data,
         item->setText(0, sit->isEmpty() ? QDir::rootPath() : *sit);
     }
     if (data) {
-        for ( oit = data->objectMap().begin();
-              oit != data->objectMap().end(); ++oit ) {
-            const QString n = (*oit).name();
+        foreach(TraceObject* o, data->objectMap().sortedByName()) {
+            const QString n = o->name();
             if (n.isEmpty()) continue;
             i = new QTreeWidgetItem(dirList);
             i->setText(0, n);
@@ -32,12 +32,14 @@
 #include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileSystemWatcher>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMenu>
 #include <QMimeDatabase>
 #include <QProcess>
 #include <QProgressBar>
+#include <QSaveFile>
 #include <QStatusBar>
 #include <QTemporaryFile>
 #include <QTimer>
@@ -72,6 +74,7 @@
 #include "stackselection.h"
 #include "stackbrowser.h"
 #include "tracedata.h"
+#include "callgrindwriter.h"
 #include "globalguiconfig.h"
 #include "config.h"
 #include "configdlg.h"
@@ -89,6 +92,17 @@ TopLevel::TopLevel()
     _statusbar->addWidget(_statusLabel, 1);
     _ccProcess = nullptr;
 
+    // follow mode: changes are collected for one second before loading
+    _followWatcher = new QFileSystemWatcher(this);
+    connect(_followWatcher, &QFileSystemWatcher::fileChanged,
+            this, &TopLevel::followChanged);
+    connect(_followWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &TopLevel::followChanged);
+    _followTimer = new QTimer(this);
+    _followTimer->setSingleShot(true);
+    _followTimer->setInterval(1000);
+    connect(_followTimer, &QTimer::timeout, this, &TopLevel::loadNewParts);
+
     _layoutCount = 1;
     _layoutCurrent = 0;
 
@@ -441,6 +455,16 @@ void TopLevel::createMiscActions()
                 "<p>This loads any new created parts, too.</p>");
     action->setWhatsThis( hint );
 
+    action = actionCollection()->addAction( QStringLiteral("save_profile") );
+    action->setIcon( QIcon::fromTheme(QStringLiteral("document-save-as")) );
+    action->setText( i18n( "&Save Active Parts As..." ) );
+    connect(action, &QAction::triggered, this, &TopLevel::saveProfile);
+    hint = i18n("<b>Save Active Parts</b>"
+                "<p>Writes the active parts of the profile data merged "
+                "into one file in Callgrind format, e.g. to combine "
+                "the profile data of many processes.</p>");
+    action->setWhatsThis( hint );
+
     action = actionCollection()->addAction( QStringLiteral("export") );
     action->setText( i18n( "&Export Graph" ) );
     connect(action, &QAction::triggered, this, &TopLevel::exportGraph);
@@ -480,6 +504,20 @@ void TopLevel::createMiscActions()
                 "of the program.</p>");
     _taDump->setWhatsThis( hint );
 
+    _taFollow = actionCollection()->add<KToggleAction>( QStringLiteral("follow") );
+    _taFollow->setIcon( QIcon::fromTheme(QStringLiteral("media-playback-start")) );
+    _taFollow->setText( i18n( "F&ollow Profile Data" ) );
+    connect(_taFollow, &QAction::triggered, this, &TopLevel::toggleFollow);
+    hint = i18n("<b>Follow Profile Data</b>"
+                "<p>While this is checked, KCachegrind watches the loaded "
+                "profile data files and their directory. Dumps appended "
+                "to loaded files, and new files of the same profile run "
+                "(e.g. created by 'callgrind_control -d' or Callgrind "
+                "option --dump-every-bb) are added as new parts. "
+                "In contrast to Reload, already loaded data is kept, "
+                "which makes this fast for long running programs.</p>");
+    _taFollow->setWhatsThis( hint );
+
     action = KStandardAction::open(this, SLOT(load()), actionCollection());
     hint = i18n("<b>Open Profile Data</b>"
                 "<p>This opens a profile data file, with possible multiple parts</p>");
@@ -1087,6 +1125,23 @@ void TopLevel::exportGraph()
 #endif
 }
 
+void TopLevel::saveProfile()
+{
+    if (!_data || _activeParts.isEmpty()) return;
+
+    QString file = QFileDialog::getSaveFileName(this,
+                                                i18n("Save Active Parts"),
+                                                QString(),
+                                                i18n("Callgrind Profile Data (callgrind.out*);;All Files (*)"));
+    if (file.isEmpty()) return;
+
+    QSaveFile out(file);
+    CallgrindWriter writer(_data);
+    writer.setParts(_activeParts);
+    if (!out.open(QIODevice::WriteOnly) || !writer.write(&out) || !out.commit())
+        KMessageBox::error(this, i18n("Could not write the file \"%1\".", file));
+}
+
 
 bool TopLevel::setEventType(QString s)
 {
@@ -1511,6 +1566,8 @@ void TopLevel::setData(TraceData* data)
     }
     setWindowTitle(caption);
 
+    updateFollowWatcher();
+
     if (!_data || (!_forcePartDock && _data->parts().count()<2)) {
         _partDock->hide();
         _partDockShown->setChecked(false);
@@ -2063,6 +2120,72 @@ void TopLevel::forceTrace()
                       QIODevice::ReadOnly);
 }
 
+void TopLevel::toggleFollow()
+{
+    updateFollowWatcher();
+
+    // pick up data written before following was switched on
+    if (_taFollow->isChecked())
+        loadNewParts();
+}
+
+void TopLevel::updateFollowWatcher()
+{
+    QStringList paths = _followWatcher->files() + _followWatcher->directories();
+    if (!paths.isEmpty())
+        _followWatcher->removePaths(paths);
+    _followTimer->stop();
+
+    if (!_data || !_taFollow->isChecked()) return;
+
+    paths = _data->loadedFiles();
+    QString dir = _data->followDirectory();
+    if (!dir.isEmpty()) paths << dir;
+    if (!paths.isEmpty())
+        _followWatcher->addPaths(paths);
+}
+
+void TopLevel::followChanged()
+{
+    // do not restart: a file written to all the time should be loaded, too
+    if (!_followTimer->isActive())
+        _followTimer->start();
+}
+
+void TopLevel::loadNewParts()
+{
+    if (!_data || !_taFollow->isChecked()) return;
+
+    int parts = _data->loadNewParts();
+    if (parts > 0) {
+        // watch new files, too
+        updateFollowWatcher();
+
+        showMessage(i18np("Loaded %1 new part", "Loaded %1 new parts", parts),
+                    5000);
+
+        // new parts are active
+        _activeParts.clear();
+        foreach(TracePart* part, _data->parts())
+            if (part->isActive())
+                _activeParts.append(part);
+
+        // rebuilds the part items
+        _partSelection->hiddenPartsChangedSlot(_hiddenParts);
+        _partSelection->set(_activeParts);
+        _multiView->set(_activeParts);
+        _functionSelection->set(_activeParts);
+        _stackSelection->refresh();
+
+        updateViewsOnChange(TraceItemView::dataChanged);
+        updateStatusBar();
+    }
+
+    // check again for files still being written
+    if (_data->hasPendingParts())
+        _followTimer->start();
+}
+
 void TopLevel::ccReadOutput()
 {
     QProcess* p = qobject_cast<QProcess*>(sender());
@@ -2352,6 +2475,14 @@ void TopLevel::loadProgress(int progress)
     showStatus(i18n("Loading %1", _filename), progress);
 }
 
+void TopLevel::updateProgress(const QString& what, int progress)
+{
+    if (progress < 100)
+        showStatus(i18n("Updating %1", what), progress);
+    else
+        showStatus(QString(), 0);
+}
+
 void TopLevel::loadError(int line, const QString& msg)
 {
     qCritical() << "Loading" << _filename << ":" << line << ": " << msg;
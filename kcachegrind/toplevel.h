@@ -43,6 +43,8 @@ class QProgressBar;
 class QMenu;
 
 class QUrl;
+class QTimer;
+class QFileSystemWatcher;
 class KSelectAction;
 class KToggleAction;
 class KToolBarPopupAction;
@@ -95,6 +97,7 @@ public:
     void loadWarning(int line, const QString& msg) override;
     void loadError(int line, const QString& msg) override;
     void loadFinished(const QString& msg) override; // msg could be error
+    void updateProgress(const QString& what, int progress) override;
 
 public Q_SLOTS:
     void load();
@@ -110,6 +113,7 @@ public Q_SLOTS:
 
     void reload();
     void exportGraph();
+    void saveProfile();
     void newWindow();
     void configure();
     void querySlot();
@@ -150,6 +154,9 @@ public Q_SLOTS:
     void toggleCycles();
     void toggleHideTemplates();
     void forceTrace();
+    void toggleFollow();
+    void followChanged();
+    void loadNewParts();
     void forwardAboutToShow();
     void forwardTriggered(QAction*);
     void backAboutToShow();
@@ -227,6 +234,7 @@ private:
     void restoreTraceTypes();
     void restoreTraceSettings();
     void updateViewsOnChange(int);
+    void updateFollowWatcher();
     /// open @p file, might be compressed
     /// @return true when the file could be opened, false otherwise.
     bool openDataFile(const QString& file);
@@ -251,7 +259,7 @@ private:
     KToggleAction *_partDockShown, *_stackDockShown;
     KToggleAction *_functionDockShown, *_dumpDockShown;
     KToggleAction *_taPercentage, *_taExpanded, *_taCycles, *_taHideTemplates;
-    KToggleAction *_taDump, *_taSplit, *_taSplitDir;
+    KToggleAction *_taDump, *_taFollow, *_taSplit, *_taSplitDir;
     KToolBarPopupAction *_paForward, *_paBack, *_paUp;
 
     TraceFunction* _function;
@@ -293,6 +301,10 @@ private:
     // for running callgrind_control in the background
     QProcess* _ccProcess;
     QString _ccOutput;
+
+    // follow mode: watching for new profile data
+    QFileSystemWatcher* _followWatcher;
+    QTimer* _followTimer;
 };
 
 #endif
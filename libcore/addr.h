@@ -46,6 +46,8 @@ public:
     // returns true if this address is in [a-distance;a+distance]
     bool isInRange(Addr a, int distance);
 
+    uint64 value() const { return _v; }
+
     bool operator==(const Addr& a) const { return (_v == a._v); }
     bool operator!=(const Addr& a) const { return (_v != a._v); }
     bool operator>(const Addr& a) const { return _v > a._v; }
@@ -18,6 +18,9 @@
 
 #include "loader.h"
 
+#include <limits.h>
+#include <string.h>
+
 #include <QIODevice>
 #include <QVector>
 #include <QDebug>
@@ -26,10 +29,46 @@
 #include "tracedata.h"
 #include "utils.h"
 #include "fixcost.h"
+#include "logger.h"
+#include "parallel.h"
 
 
 #define TRACE_LOADER 0
 
+// files are only split for parallel parsing into chunks at least this large
+#define MIN_CHUNK_SIZE (32*1024*1024)
+
+/*
+ * Support for parsing one file in chunks by multiple threads.
+ *
+ * A pre-pass over the file looks for "fn=" lines where parsing can be
+ * started again (the first following position is absolute), and stores
+ * the names of current file and ELF object there. As compressed names
+ * may be defined in another chunk than where they are used, all name
+ * definitions are collected in the pre-pass, too.
+ */
+struct CompressedFunctionName {
+    QString name, file, object;
+};
+
+struct CompressedNames {
+    QVector<QString> objects, files;
+    QVector<CompressedFunctionName> functions;
+};
+
+struct ChunkStart {
+    uint64 offset;
+    int lineNo;
+    // raw names as given in file (null if not set)
+    QString file, functionFile, object;
+};
+
+struct ChunkInfo {
+    QString events, positions;
+    QVector<ChunkStart> starts;
+    CompressedNames names;
+};
+
 /*
  * Loader for Callgrind Profile data (format based on Cachegrind format).
  * See Callgrind documentation for the file format.
@@ -48,6 +87,15 @@ private:
     void warning(QString);
 
     int loadInternal(TraceData*, QIODevice* file, const QString& filename);
+    bool parse(FixFile& file);
+
+    // parallel parsing of large files
+    bool splitIntoChunks(FixFile& file, ChunkInfo& info);
+    bool parseInChunks(FixFile& file, const ChunkInfo& info);
+    bool loadChunk(TraceData*, const QString& filename,
+                   const char* data, uint64 len,
+                   const ChunkInfo& info, int chunk);
+    void setPositions(const QString&);
 
     enum lineType { SelfCost, CallCost, BoringJump, CondJump };
 
@@ -58,12 +106,12 @@ private:
     void ensureObject();
     void ensureFile();
     void ensureFunction();
-    void setObject(const QString&);
-    void setCalledObject(const QString&);
-    void setFile(const QString&);
-    void setCalledFile(const QString&);
-    void setFunction(const QString&);
-    void setCalledFunction(const QString&);
+    void setObject(FixString);
+    void setCalledObject(FixString);
+    void setFile(FixString);
+    void setCalledFile(FixString);
+    void setFunction(FixString);
+    void setCalledFunction(FixString);
 
     void prepareNewPart();
 
@@ -125,12 +173,16 @@ private:
    */
     void clearCompression();
     const QString& checkUnknown(const QString& n);
-    TraceObject* compressedObject(const QString& name);
-    TraceFile* compressedFile(const QString& name);
-    TraceFunction* compressedFunction(const QString& name,
+    int nameId(FixString name);
+    TraceObject* compressedObject(FixString name);
+    TraceFile* compressedFile(FixString name);
+    TraceFunction* compressedFunction(FixString name,
                                       TraceFile*, TraceObject*);
 
     QVector<TraceCostItem*> _objectVector, _fileVector, _functionVector;
+
+    // if parsing a chunk: name definitions found in the whole file
+    const CompressedNames* _names;
 };
 
 
@@ -144,6 +196,7 @@ CachegrindLoader::CachegrindLoader()
     : Loader(QStringLiteral("Callgrind"),
              QObject::tr( "Import filter for Cachegrind/Callgrind generated profile data files") )
 {
+    _names = nullptr;
 }
 
 bool CachegrindLoader::canLoad(QIODevice* file)
@@ -157,8 +210,9 @@ bool CachegrindLoader::canLoad(QIODevice* file)
      * - it starts with a line "# callgrind format", or
      * - if the first 2047 bytes contain either "\nevents:" or "\ncreator:"
      */
+    // peek: sequential devices cannot seek back for loading
     char buf[2048];
-    int read = file->read(buf,2047);
+    int read = file->peek(buf,2047);
     if (read < 0)
         return false;
     buf[read] = 0;
@@ -188,7 +242,7 @@ int CachegrindLoader::load(TraceData* d,
    */
     CachegrindLoader l;
 
-    l.setLogger(_logger);
+    l.setLogger(d->logger());
 
     return l.loadInternal(d, file, filename);
 }
@@ -354,21 +408,62 @@ const QString& CachegrindLoader::checkUnknown(const QString& n)
     return n;
 }
 
-TraceObject* CachegrindLoader::compressedObject(const QString& name)
+/**
+ * ID of a name from the profile data in the name table of _data.
+ * Names are given in local 8-bit encoding: only convert if not ASCII.
+ */
+int CachegrindLoader::nameId(FixString name)
+{
+    const char* s = name.ascii();
+    int len = (int) name.len();
+
+    // checkUnknown()
+    if ((len == 3) && (memcmp(s, "???", 3) == 0)) len = 0;
+
+    for(int i=0; i<len; i++)
+        if (s[i] & 0x80)
+            return _data->names()->intern(QString(name));
+
+    return _data->names()->intern(s, len);
+}
+
+/**
+ * Strip index of a compressed name specification "(<index>) <name>".
+ * Returns false if <s> is not compressed. Otherwise, <s> is left with
+ * <name> (may be empty), and <index> is -1 if the index is invalid.
+ */
+static bool stripCompressedIndex(FixString& s, int& index)
+{
+    if ((s.len() < 2) || (s.ascii()[0] != '(') ||
+        (s.ascii()[1] < '0') || (s.ascii()[1] > '9'))
+        return false;
+
+    char c;
+    uint i;
+    s.stripFirst(c);
+    if (!s.stripUInt(i, false) || (i > INT_MAX) || !s.stripPrefix(")")) {
+        index = -1;
+        return true;
+    }
+    s.stripSpaces();
+    index = (int) i;
+    return true;
+}
+
+TraceObject* CachegrindLoader::compressedObject(FixString name)
 {
-    if ((name[0] != '(') || !name[1].isDigit()) return _data->object(checkUnknown(name));
+    FixString spec = name;
+    int index;
+    if (!stripCompressedIndex(name, index))
+        return _data->object(nameId(name));
 
     // compressed format using _objectVector
-    int p = name.indexOf(')');
-    if (p<2) {
-        error(QStringLiteral("Invalid compressed ELF object ('%1')").arg(name));
+    if (index < 0) {
+        error(QStringLiteral("Invalid compressed ELF object ('%1')").arg(spec));
         return nullptr;
     }
-    int index = name.midRef(1, p-1).toInt();
     TraceObject* o = nullptr;
-    p++;
-    while((name.length()>p) && name.at(p).isSpace()) p++;
-    if (name.length()>p) {
+    if (!name.isEmpty()) {
         if (_objectVector.size() <= index) {
             int newSize = index * 2;
 #if TRACE_LOADER
@@ -378,19 +473,28 @@ TraceObject* CachegrindLoader::compressedObject(const QString& name)
             _objectVector.resize(newSize);
         }
 
-        QString realName = checkUnknown(name.mid(p));
+        int id = nameId(name);
         o = (TraceObject*) _objectVector.at(index);
-        if (o && (o->name() != realName)) {
+        if (o && (o->nameId() != id)) {
             error(QStringLiteral("Redefinition of compressed ELF object index %1 (was '%2') to %3")
-                  .arg(index).arg(o->name()).arg(realName));
+                  .arg(index).arg(o->name()).arg(_data->names()->name(id)));
         }
 
-        o = _data->object(realName);
+        o = _data->object(id);
         _objectVector.replace(index, o);
     }
     else {
-        if ((_objectVector.size() <= index) ||
-            ( (o=(TraceObject*)_objectVector.at(index)) == nullptr)) {
+        if (_objectVector.size() > index)
+            o = (TraceObject*)_objectVector.at(index);
+        if (!o && _names && (_names->objects.size() > index) &&
+            !_names->objects.at(index).isNull()) {
+            // defined in another chunk
+            o = _data->object(checkUnknown(_names->objects.at(index)));
+            if (_objectVector.size() <= index)
+                _objectVector.resize(index * 2);
+            _objectVector.replace(index, o);
+        }
+        if (!o) {
             error(QStringLiteral("Undefined compressed ELF object index %1").arg(index));
             return nullptr;
         }
@@ -402,21 +506,20 @@ TraceObject* CachegrindLoader::compressedObject(const QString& name)
 
 // Note: Callgrind sometimes gives different IDs for same file
 // (when references to same source file come from different ELF objects)
-TraceFile* CachegrindLoader::compressedFile(const QString& name)
+TraceFile* CachegrindLoader::compressedFile(FixString name)
 {
-    if ((name[0] != '(') || !name[1].isDigit()) return _data->file(checkUnknown(name));
+    FixString spec = name;
+    int index;
+    if (!stripCompressedIndex(name, index))
+        return _data->file(nameId(name));
 
     // compressed format using _fileVector
-    int p = name.indexOf(')');
-    if (p<2) {
-        error(QStringLiteral("Invalid compressed file ('%1')").arg(name));
+    if (index < 0) {
+        error(QStringLiteral("Invalid compressed file ('%1')").arg(spec));
         return nullptr;
     }
-    int index = name.midRef(1, p-1).toUInt();
     TraceFile* f = nullptr;
-    p++;
-    while((name.length()>p) && name.at(p).isSpace()) p++;
-    if (name.length()>p) {
+    if (!name.isEmpty()) {
         if (_fileVector.size() <= index) {
             int newSize = index * 2;
 #if TRACE_LOADER
@@ -426,19 +529,28 @@ TraceFile* CachegrindLoader::compressedFile(const QString& name)
             _fileVector.resize(newSize);
         }
 
-        QString realName = checkUnknown(name.mid(p));
+        int id = nameId(name);
         f = (TraceFile*) _fileVector.at(index);
-        if (f && (f->name() != realName)) {
+        if (f && (f->nameId() != id)) {
             error(QStringLiteral("Redefinition of compressed file index %1 (was '%2') to %3")
-                  .arg(index).arg(f->name()).arg(realName));
+                  .arg(index).arg(f->name()).arg(_data->names()->name(id)));
         }
 
-        f = _data->file(realName);
+        f = _data->file(id);
         _fileVector.replace(index, f);
     }
     else {
-        if ((_fileVector.size() <= index) ||
-            ( (f=(TraceFile*)_fileVector.at(index)) == nullptr)) {
+        if (_fileVector.size() > index)
+            f = (TraceFile*)_fileVector.at(index);
+        if (!f && _names && (_names->files.size() > index) &&
+            !_names->files.at(index).isNull()) {
+            // defined in another chunk
+            f = _data->file(checkUnknown(_names->files.at(index)));
+            if (_fileVector.size() <= index)
+                _fileVector.resize(index * 2);
+            _fileVector.replace(index, f);
+        }
+        if (!f) {
             error(QStringLiteral("Undefined compressed file index %1").arg(index));
             return nullptr;
         }
@@ -450,26 +562,22 @@ TraceFile* CachegrindLoader::compressedFile(const QString& name)
 // Note: Callgrind gives different IDs even for same function
 // when parts of the function are from different source files.
 // Thus, it is no error when multiple indexes map to same function.
-TraceFunction* CachegrindLoader::compressedFunction(const QString& name,
+TraceFunction* CachegrindLoader::compressedFunction(FixString name,
                                                     TraceFile* file,
                                                     TraceObject* object)
 {
-    if ((name[0] != '(') || !name[1].isDigit())
-        return _data->function(checkUnknown(name), file, object);
+    FixString spec = name;
+    int index;
+    if (!stripCompressedIndex(name, index))
+        return _data->function(nameId(name), file, object);
 
     // compressed format using _functionVector
-    int p = name.indexOf(')');
-    if (p<2) {
-        error(QStringLiteral("Invalid compressed function ('%1')").arg(name));
+    if (index < 0) {
+        error(QStringLiteral("Invalid compressed function ('%1')").arg(spec));
         return nullptr;
     }
-
-
-    int index = name.midRef(1, p-1).toUInt();
     TraceFunction* f = nullptr;
-    p++;
-    while((name.length()>p) && name.at(p).isSpace()) p++;
-    if (name.length()>p) {
+    if (!name.isEmpty()) {
         if (_functionVector.size() <= index) {
             int newSize = index * 2;
 #if TRACE_LOADER
@@ -479,14 +587,14 @@ TraceFunction* CachegrindLoader::compressedFunction(const QString& name,
             _functionVector.resize(newSize);
         }
 
-        QString realName = checkUnknown(name.mid(p));
+        int id = nameId(name);
         f = (TraceFunction*) _functionVector.at(index);
-        if (f && (f->name() != realName)) {
+        if (f && (f->nameId() != id)) {
             error(QStringLiteral("Redefinition of compressed function index %1 (was '%2') to %3")
-                  .arg(index).arg(f->name()).arg(realName));
+                  .arg(index).arg(f->name()).arg(_data->names()->name(id)));
         }
 
-        f = _data->function(realName, file, object);
+        f = _data->function(id, file, object);
         _functionVector.replace(index, f);
 
 #if TRACE_LOADER
@@ -498,8 +606,20 @@ TraceFunction* CachegrindLoader::compressedFunction(const QString& name,
 #endif
     }
     else {
-        if ((_functionVector.size() <= index) ||
-            ( (f=(TraceFunction*)_functionVector.at(index)) == nullptr)) {
+        if (_functionVector.size() > index)
+            f = (TraceFunction*)_functionVector.at(index);
+        if (!f && _names && (_names->functions.size() > index) &&
+            !_names->functions.at(index).name.isNull()) {
+            // defined in another chunk, with file/object given there
+            const CompressedFunctionName& fn = _names->functions.at(index);
+            f = _data->function(checkUnknown(fn.name),
+                                _data->file(checkUnknown(fn.file)),
+                                _data->object(checkUnknown(fn.object)));
+            if (_functionVector.size() <= index)
+                _functionVector.resize(index * 2);
+            _functionVector.replace(index, f);
+        }
+        if (!f) {
             error(QStringLiteral("Undefined compressed function index %1").arg(index));
             return nullptr;
         }
@@ -523,7 +643,7 @@ void CachegrindLoader::ensureObject()
     currentPartObject = currentObject->partObject(_part);
 }
 
-void CachegrindLoader::setObject(const QString& name)
+void CachegrindLoader::setObject(FixString name)
 {
     currentObject = compressedObject(name);
     if (!currentObject) {
@@ -537,7 +657,7 @@ void CachegrindLoader::setObject(const QString& name)
     currentPartFunction = nullptr;
 }
 
-void CachegrindLoader::setCalledObject(const QString& name)
+void CachegrindLoader::setCalledObject(FixString name)
 {
     currentCalledObject = compressedObject(name);
 
@@ -560,7 +680,7 @@ void CachegrindLoader::ensureFile()
     currentPartFile = currentFile->partFile(_part);
 }
 
-void CachegrindLoader::setFile(const QString& name)
+void CachegrindLoader::setFile(FixString name)
 {
     currentFile = compressedFile(name);
 
@@ -575,7 +695,7 @@ void CachegrindLoader::setFile(const QString& name)
     currentPartLine = nullptr;
 }
 
-void CachegrindLoader::setCalledFile(const QString& name)
+void CachegrindLoader::setCalledFile(FixString name)
 {
     currentCalledFile = compressedFile(name);
 
@@ -606,7 +726,7 @@ void CachegrindLoader::ensureFunction()
                                                         currentPartObject);
 }
 
-void CachegrindLoader::setFunction(const QString& name)
+void CachegrindLoader::setFunction(FixString name)
 {
     ensureFile();
     ensureObject();
@@ -632,7 +752,7 @@ void CachegrindLoader::setFunction(const QString& name)
     currentPartLine = nullptr;
 }
 
-void CachegrindLoader::setCalledFunction(const QString& name)
+void CachegrindLoader::setCalledFunction(FixString name)
 {
     // if called object/file not set, use current object/file
     if (!currentCalledObject) {
@@ -742,6 +862,56 @@ int CachegrindLoader::loadInternal(TraceData* data,
         return 0;
     }
 
+    _part = nullptr;
+    partsAdded = 0;
+    prepareNewPart();
+
+    // default if there is no "positions:" line
+    hasLineInfo = true;
+    hasAddrInfo = false;
+
+    bool ok;
+    ChunkInfo chunks;
+    if (splitIntoChunks(file, chunks))
+        ok = parseInChunks(file, chunks);
+    else {
+        file.rewind();
+        ok = parse(file);
+    }
+
+    if (!ok) {
+        delete _part;
+        return false;
+    }
+    // lines of other chunks were added when merging
+    data->loadStats().lines += _lineNo;
+
+    loadFinished();
+
+    if (mapping) {
+        _part->invalidate();
+        _part->totals()->clear();
+        _part->totals()->addCost(_part);
+        data->addPart(_part);
+        partsAdded++;
+    }
+    else {
+        error(QStringLiteral("No data found. Skipping file"));
+        delete _part;
+    }
+
+    device->close();
+
+    return partsAdded;
+}
+
+/**
+ * Parse lines of <file> into current part, starting with the current
+ * position state. Returns false on fatal error: loading should be
+ * aborted, and the current part is not valid.
+ */
+bool CachegrindLoader::parse(FixFile& file)
+{
     int statusProgress = 0;
 
 #if USE_FIXCOST
@@ -749,18 +919,11 @@ int CachegrindLoader::loadInternal(TraceData* data,
     FixPool* pool = _data->fixPool();
 #endif
 
-    _part = nullptr;
-    partsAdded = 0;
-    prepareNewPart();
-
     FixString line;
     char c;
 
     // current position
     nextLineType  = SelfCost;
-    // default if there is no "positions:" line
-    hasLineInfo = true;
-    hasAddrInfo = false;
 
     while (file.nextLine(line)) {
 
@@ -820,7 +983,7 @@ int CachegrindLoader::loadInternal(TraceData* data,
                     setFunction(line);
 
                     // on a new function, update status
-                    int progress = (int)(100.0 * file.current() / file.len() +.5);
+                    int progress = file.progress();
                     if (progress != statusProgress) {
                         statusProgress = progress;
 
@@ -1055,9 +1218,7 @@ int CachegrindLoader::loadInternal(TraceData* data,
                 // positions:
                 if (line.stripPrefix("ositions:")) {
                     prepareNewPart();
-                    QString positions(line);
-                    hasLineInfo = positions.contains(QLatin1String("line"));
-                    hasAddrInfo = positions.contains(QLatin1String("instr"));
+                    setPositions(line);
                     continue;
                 }
                 break;
@@ -1077,7 +1238,6 @@ int CachegrindLoader::loadInternal(TraceData* data,
                 if (line.stripPrefix("ummary:")) {
                     if (!mapping) {
                         error(QStringLiteral("Invalid format: summary before data. Skipping file"));
-                        delete _part;
                         return false;
                     }
 
@@ -1110,7 +1270,6 @@ int CachegrindLoader::loadInternal(TraceData* data,
 
         if (!mapping) {
             error(QStringLiteral("Invalid format: data found before 'events' line. Skipping file"));
-            delete _part;
             return false;
         }
 
@@ -1187,7 +1346,7 @@ int CachegrindLoader::loadInternal(TraceData* data,
 
                 if (hasLineInfo) {
                     // we need to set <line> back after reading for the line
-                    int l = line.len();
+                    int64 l = line.len();
                     const char* s = line.ascii();
 
                     partInstr->addCost(mapping, line);
@@ -1237,7 +1396,7 @@ int CachegrindLoader::loadInternal(TraceData* data,
 
                 if (hasLineInfo) {
                     // we need to set <line> back after reading for the line
-                    int l = line.len();
+                    int64 l = line.len();
                     const char* s = line.ascii();
 
                     partInstrCall->addCost(mapping, line);
@@ -1358,22 +1517,380 @@ int CachegrindLoader::loadInternal(TraceData* data,
         }
     }
 
-    loadFinished();
+    return true;
+}
 
-    if (mapping) {
-        _part->invalidate();
-        _part->totals()->clear();
-        _part->totals()->addCost(_part);
-        data->addPart(_part);
-        partsAdded++;
+void CachegrindLoader::setPositions(const QString& positions)
+{
+    hasLineInfo = positions.contains(QLatin1String("line"));
+    hasAddrInfo = positions.contains(QLatin1String("instr"));
+}
+
+
+// name for a (possibly compressed) name specification, see compressedObject()
+static QString compressedName(FixString s, QVector<QString>& names)
+{
+    char c;
+    if ((s.len() < 2) || (s.ascii()[0] != '(') ||
+        (s.ascii()[1] < '0') || (s.ascii()[1] > '9'))
+        return s;
+
+    uint index;
+    s.stripFirst(c);
+    if (!s.stripUInt(index, false) || !s.stripFirst(c) || (c != ')'))
+        return QString();
+
+    s.stripSpaces();
+    if (s.isEmpty())
+        return ((int)index < names.size()) ? names.at(index) : QString();
+
+    if ((int)index >= names.size())
+        names.resize(qMax((int)index + 1, 2 * names.size()));
+    names[index] = s;
+    return names.at(index);
+}
+
+static void compressedFunctionName(FixString s,
+                                   QVector<CompressedFunctionName>& names,
+                                   const QString& file, const QString& object)
+{
+    char c;
+    if ((s.len() < 2) || (s.ascii()[0] != '(') ||
+        (s.ascii()[1] < '0') || (s.ascii()[1] > '9'))
+        return;
+
+    uint index;
+    s.stripFirst(c);
+    if (!s.stripUInt(index, false) || !s.stripFirst(c) || (c != ')'))
+        return;
+
+    s.stripSpaces();
+    if (s.isEmpty()) return;
+
+    if ((int)index >= names.size())
+        names.resize(qMax((int)index + 1, 2 * names.size()));
+    CompressedFunctionName& fn = names[index];
+    fn.name = s;
+    fn.file = file;
+    fn.object = object;
+}
+
+// does a position specification not depend on the previous one?
+static bool isAbsolutePosition(FixString s, bool hasAddrInfo, bool hasLineInfo)
+{
+    char c;
+    int count = (hasAddrInfo ? 1 : 0) + (hasLineInfo ? 1 : 0);
+    for(int i=0; i<count; i++) {
+        if (!s.first(c) || (c < '0') || (c > '9')) return false;
+        s.stripUntil(' ');
+        s.stripSpaces();
     }
-    else {
-        error(QStringLiteral("No data found. Skipping file"));
-        delete _part;
+    return true;
+}
+
+/**
+ * Pre-pass for parallel parsing of a large file: fill <info> with
+ * positions to split the file at, see ChunkInfo.
+ * Returns false if the file should be parsed sequentially.
+ *
+ * This mirrors the handling of file/object/function names in parse().
+ * Only files with one part are split.
+ */
+bool CachegrindLoader::splitIntoChunks(FixFile& file, ChunkInfo& info)
+{
+#if USE_FIXCOST
+    // chunks need the whole file in memory
+    if (file.isStreaming()) return false;
+
+    int chunks = ParallelJobs::idealThreadCount();
+    if (file.len() / MIN_CHUNK_SIZE < (uint64) chunks)
+        chunks = file.len() / MIN_CHUNK_SIZE;
+    if (chunks < 2) return false;
+
+    // current names (null if not set)
+    QString fnFile, currFile, partFile, object;
+    QString calledFile, calledObject, jumpFile;
+    lineType nextType = SelfCost;
+    bool lineInfo = true, addrInfo = false;
+    bool seenEvents = false, seenFunction = false;
+
+    ChunkStart candidate;
+    bool hasCandidate = false;
+    uint64 nextSplit = file.len() / chunks;
+
+    FixString line;
+    char c;
+    int lineNo = 0;
+
+    while(1) {
+        uint64 offset = file.current();
+        if (!file.nextLine(line)) break;
+        lineNo++;
+
+        if (!line.first(c)) continue;
+
+        if (c <= '9') {
+            if (c == '#') continue;
+
+            if (hasCandidate) {
+                if (isAbsolutePosition(line, addrInfo, lineInfo)) {
+                    info.starts.append(candidate);
+                    nextSplit = file.len() * (info.starts.count()+1) / chunks;
+                }
+                hasCandidate = false;
+            }
+
+            if (nextType == CallCost) {
+                calledFile = QString();
+                calledObject = QString();
+            }
+            else if (nextType != SelfCost)
+                jumpFile = QString();
+            nextType = SelfCost;
+            continue;
+        }
+
+        line.stripFirst(c);
+        switch(c) {
+        case 'f':
+            // fl=, fi=, fe=
+            if (line.stripPrefix("l=")) {
+                currFile = partFile = fnFile = compressedName(line, info.names.files);
+                continue;
+            }
+            if (line.stripPrefix("i=") || line.stripPrefix("e=")) {
+                currFile = partFile = compressedName(line, info.names.files);
+                continue;
+            }
+            // fn=
+            if (line.stripPrefix("n=")) {
+                seenFunction = true;
+                if ((offset >= nextSplit) && (info.starts.count() < chunks-1)) {
+                    candidate.offset = offset;
+                    candidate.lineNo = lineNo - 1;
+                    candidate.file = partFile;
+                    candidate.functionFile = fnFile;
+                    candidate.object = object;
+                    hasCandidate = true;
+                }
+
+                currFile = fnFile;
+                if (currFile.isNull())
+                    currFile = partFile = QLatin1String("");
+                if (object.isNull())
+                    object = QLatin1String("");
+                compressedFunctionName(line, info.names.functions,
+                                       currFile, object);
+                continue;
+            }
+            break;
+
+        case 'c':
+            // cob=, cfi=, cfl=, cfn=, calls=
+            if (line.stripPrefix("ob=")) {
+                calledObject = compressedName(line, info.names.objects);
+                continue;
+            }
+            if (line.stripPrefix("fl=") || line.stripPrefix("fi=")) {
+                calledFile = compressedName(line, info.names.files);
+                continue;
+            }
+            if (line.stripPrefix("fn=")) {
+                if (calledObject.isNull()) calledObject = object;
+                if (calledFile.isNull()) calledFile = currFile;
+                compressedFunctionName(line, info.names.functions,
+                                       calledFile, calledObject);
+                continue;
+            }
+            if (line.stripPrefix("alls=")) nextType = CallCost;
+            continue;
+
+        case 'j':
+            // jumps need the previous position: no split before
+            hasCandidate = false;
+            if (line.stripPrefix("fi=")) {
+                jumpFile = compressedName(line, info.names.files);
+                continue;
+            }
+            if (line.stripPrefix("fn=")) {
+                if (jumpFile.isNull()) jumpFile = currFile;
+                compressedFunctionName(line, info.names.functions,
+                                       jumpFile, object);
+                continue;
+            }
+            if (line.stripPrefix("cnd=")) nextType = CondJump;
+            else if (line.stripPrefix("ump=")) nextType = BoringJump;
+            continue;
+
+        case 'o':
+            if (line.stripPrefix("b="))
+                object = compressedName(line, info.names.objects);
+            continue;
+
+        case 'e':
+            if (line.stripPrefix("vents:")) {
+                if (seenEvents || seenFunction) return false;
+                seenEvents = true;
+                info.events = line;
+            }
+            continue;
+
+        case 'p':
+            if (line.stripPrefix("ositions:")) {
+                if (seenEvents || seenFunction) return false;
+                info.positions = line;
+                lineInfo = info.positions.contains(QLatin1String("line"));
+                addrInfo = info.positions.contains(QLatin1String("instr"));
+                continue;
+            }
+            if (line.stripPrefix("art:") || line.stripPrefix("id:")) {
+                if (seenEvents || seenFunction) return false;
+            }
+            continue;
+
+        case 't':
+            if (line.stripPrefix("hread:")) {
+                if (seenEvents || seenFunction) return false;
+            }
+            continue;
+
+        default:
+            continue;
+        }
     }
 
-    device->close();
+    if (0) qDebug("CachegrindLoader: splitting into %d chunks",
+                  info.starts.count() + 1);
 
-    return partsAdded;
+    return seenEvents && !info.starts.isEmpty();
+#else
+    Q_UNUSED(file);
+    Q_UNUSED(info);
+    return false;
+#endif
+}
+
+/**
+ * Parse <file> in chunks given by <info>, all in worker threads. The
+ * first chunk, including the header, is parsed into the current part,
+ * the others into separate traces, merged in afterwards.
+ * Returns false if any chunk failed: nothing of the others is merged.
+ */
+bool CachegrindLoader::parseInChunks(FixFile& file, const ChunkInfo& info)
+{
+    int count = info.starts.count();
+    QVector<uint64> chunkEnd(count);
+    for(int i=0; i<count; i++)
+        chunkEnd[i] = (i+1 < count) ? info.starts.at(i+1).offset : file.len();
+
+    QVector<TraceData*> traces(count, nullptr);
+    QVector<LogBuffer*> logs(count);
+    QVector<char> chunkOk(count, 0);
+    TraceData** trace = traces.data();
+    char* result = chunkOk.data();
+
+    // notifications of the first chunk are buffered as for the others,
+    // to only report combined progress from this thread
+    Logger* logger = _logger;
+    LogBuffer firstLog;
+    setLogger(&firstLog);
+    FixFile first(file.data(), info.starts.at(0).offset, _filename);
+    bool firstOk = false;
+
+    ParallelJobs jobs;
+    jobs.add([this, &first, &firstOk]() {
+        firstOk = parse(first);
+    });
+    for(int i=0; i<count; i++) {
+        LogBuffer* log = new LogBuffer;
+        logs[i] = log;
+
+        QString filename = _filename;
+        const char* data = file.data() + info.starts.at(i).offset;
+        uint64 len = chunkEnd.at(i) - info.starts.at(i).offset;
+        const ChunkInfo* chunkInfo = &info;
+        jobs.add([=]() {
+            TraceData* d = new TraceData(log);
+            CachegrindLoader l;
+            l.setLogger(log);
+            result[i] = l.loadChunk(d, filename, data, len, *chunkInfo, i);
+            trace[i] = d;
+        });
+    }
+
+    jobs.wait([&]() {
+        if (!logger) return;
+        uint64 done = info.starts.at(0).offset * firstLog.progress() / 100;
+        for(int i=0; i<count; i++)
+            done += (chunkEnd.at(i) - info.starts.at(i).offset) *
+                    logs.at(i)->progress() / 100;
+        logger->loadProgress((int)(100.0 * done / file.len() + .5));
+    });
+
+    setLogger(logger);
+    firstLog.forward(_logger);
+
+    bool ok = firstOk;
+    for(int i=0; i<count; i++)
+        if (!result[i]) ok = false;
+    for(int i=0; i<count; i++) {
+        if (ok && mapping)
+            _data->mergeParts(traces.at(i), _part);
+        delete traces.at(i);
+
+        logs.at(i)->forward(_logger);
+        delete logs.at(i);
+    }
+
+    return ok;
+}
+
+/**
+ * Parse one chunk of a file, starting with parser state as found in the
+ * pre-pass. Results are put into a new part of <data>.
+ * Returns false on fatal error, with no part added.
+ */
+bool CachegrindLoader::loadChunk(TraceData* data, const QString& filename,
+                                 const char* buffer, uint64 len,
+                                 const ChunkInfo& info, int chunk)
+{
+    const ChunkStart& start = info.starts.at(chunk);
+
+    _data = data;
+    _filename = filename;
+    _lineNo = start.lineNo;
+    _names = &info.names;
+
+    _part = nullptr;
+    partsAdded = 0;
+    prepareNewPart();
+
+    hasLineInfo = true;
+    hasAddrInfo = false;
+    if (!info.positions.isNull())
+        setPositions(info.positions);
+    mapping = _data->eventTypes()->createMapping(info.events);
+    _part->setEventMapping(mapping);
+
+    if (!start.file.isNull()) {
+        currentFile = _data->file(checkUnknown(start.file));
+        currentPartFile = currentFile->partFile(_part);
+    }
+    if (!start.functionFile.isNull())
+        currentFunctionFile = _data->file(checkUnknown(start.functionFile));
+    if (!start.object.isNull()) {
+        currentObject = _data->object(checkUnknown(start.object));
+        currentPartObject = currentObject->partObject(_part);
+    }
+
+    FixFile file(buffer, len, _filename);
+    if (!parse(file)) {
+        delete _part;
+        return false;
+    }
+    _data->loadStats().lines += _lineNo - start.lineNo;
+    // totals are not needed: costs get merged into another part
+    _data->addPart(_part);
+    return true;
 }
 
@@ -0,0 +1,603 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Export of profile data in callgrind format
+ */
+
+#include "callgrindwriter.h"
+
+#include <algorithm>
+
+#include <QIODevice>
+#include <QMap>
+
+#include "fixcost.h"
+
+// output buffer is written to device when reaching this size
+#define BUFFER_SIZE (256*1024)
+
+/*
+ * Keys for summing up costs of a function from multiple parts.
+ * Sorted by file first to need as few "fi=" lines as possible.
+ */
+struct CostKey {
+    TraceFile* file;
+    Addr fromAddr, toAddr;
+    uint fromLine, toLine;
+
+    bool operator<(const CostKey& k) const {
+        if (file != k.file) return (quintptr) file < (quintptr) k.file;
+        if (fromAddr != k.fromAddr) return fromAddr < k.fromAddr;
+        if (fromLine != k.fromLine) return fromLine < k.fromLine;
+        if (toAddr != k.toAddr) return toAddr < k.toAddr;
+        return toLine < k.toLine;
+    }
+};
+
+struct CallKey {
+    TraceFile* file;
+    Addr addr;
+    uint line;
+    TraceFunction* called;
+
+    bool operator<(const CallKey& k) const {
+        if (file != k.file) return (quintptr) file < (quintptr) k.file;
+        if (addr != k.addr) return addr < k.addr;
+        if (line != k.line) return line < k.line;
+        return (quintptr) called < (quintptr) k.called;
+    }
+};
+
+struct JumpKey {
+    TraceFile* file;
+    Addr addr;
+    uint line;
+    TraceFunction* target;
+    TraceFile* targetFile;
+    Addr targetAddr;
+    uint targetLine;
+    bool isCondJump;
+
+    bool operator<(const JumpKey& k) const {
+        if (file != k.file) return (quintptr) file < (quintptr) k.file;
+        if (addr != k.addr) return addr < k.addr;
+        if (line != k.line) return line < k.line;
+        if (target != k.target) return (quintptr) target < (quintptr) k.target;
+        if (targetFile != k.targetFile)
+            return (quintptr) targetFile < (quintptr) k.targetFile;
+        if (targetAddr != k.targetAddr) return targetAddr < k.targetAddr;
+        if (targetLine != k.targetLine) return targetLine < k.targetLine;
+        return isCondJump < k.isCondJump;
+    }
+};
+
+// index of cost array for <key>, appended to <costs> with <size> zeros if new
+template<class Key>
+static int costIndex(QMap<Key, int>& index, const Key& key,
+                     QVector<SubCost>& costs, int size)
+{
+    typename QMap<Key, int>::const_iterator it = index.constFind(key);
+    if (it != index.constEnd()) return it.value();
+
+    int i = index.count();
+    index.insert(key, i);
+    costs.resize(costs.size() + size);
+    return i;
+}
+
+static inline void appendNumber(QByteArray& b, uint64 v)
+{
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    do {
+        *--p = '0' + (v % 10);
+        v /= 10;
+    } while(v > 0);
+    b.append(p, buf + sizeof(buf) - p);
+}
+
+static inline void appendHex(QByteArray& b, uint64 v)
+{
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    do {
+        *--p = "0123456789abcdef"[v & 15];
+        v >>= 4;
+    } while(v > 0);
+    *--p = 'x';
+    *--p = '0';
+    b.append(p, buf + sizeof(buf) - p);
+}
+
+
+CallgrindWriter::CallgrindWriter(TraceData* data)
+{
+    _data = data;
+    if (_data)
+        _parts = _data->parts();
+    _mergeParts = true;
+    _partsWritten = 0;
+
+    _object = nullptr;
+    _file = nullptr;
+    _functionFile = nullptr;
+    _fromLine = _toLine = 0;
+    _hasAddr = false;
+    _hasLine = true;
+    _columnCount = 0;
+    _device = nullptr;
+    _error = false;
+}
+
+bool CallgrindWriter::write(QIODevice* device)
+{
+    if (!_data || !device) return false;
+
+    _device = device;
+    _error = false;
+    _partsWritten = 0;
+    _buffer.reserve(BUFFER_SIZE + 4096);
+
+    _buffer += "# callgrind format\n"
+               "version: 1\n"
+               "creator: KCachegrind\n";
+    if (!_data->command().isEmpty()) {
+        _buffer += "cmd: ";
+        _buffer += _data->command().toLocal8Bit();
+        _buffer += '\n';
+    }
+    if (_data->architecture() == TraceData::ArchARM)
+        _buffer += "arch: arm\n";
+
+    // long names of used event types
+    EventTypeSet* types = _data->eventTypes();
+    QVector<bool> used(types->realCount(), false);
+    foreach(TracePart* p, _parts) {
+        EventTypeMapping* m = p->eventTypeMapping();
+        for(int i = 0; m && (i < m->count()); i++)
+            if ((m->realIndex(i) >= 0) && (m->realIndex(i) < used.count()))
+                used[m->realIndex(i)] = true;
+    }
+    for(int i = 0; i < used.count(); i++) {
+        EventType* t = types->realType(i);
+        if (!used.at(i) || !t || t->longName().isEmpty() ||
+            (t->longName() == t->name()))
+            continue;
+        _buffer += "event: ";
+        _buffer += t->name().toLocal8Bit();
+        _buffer += " : ";
+        _buffer += t->longName().toLocal8Bit();
+        _buffer += '\n';
+    }
+
+    if (_mergeParts)
+        writeSection(_parts);
+    else {
+        foreach(TracePart* p, _parts)
+            writeSection(TracePartList() << p);
+    }
+    flush(true);
+
+    return !_error;
+}
+
+bool CallgrindWriter::isSelected(TraceFunction* f) const
+{
+    if (_objects.isEmpty()) return true;
+
+    TraceObject* o = f->object();
+    if (!o) return false;
+    return _objects.contains(o->name()) || _objects.contains(o->shortName());
+}
+
+/* Write <parts> as one part. As the loader starts a new part with
+ * a "part:" line after the first, we always start with it if not merging.
+ */
+void CallgrindWriter::writeSection(const TracePartList& parts)
+{
+    if (parts.isEmpty()) return;
+    _partsWritten++;
+
+    _objectIds.clear();
+    _fileIds.clear();
+    _functionIds.clear();
+    _object = nullptr;
+    _file = nullptr;
+    _functionFile = nullptr;
+    _fromAddr = _toAddr = Addr(0);
+    _fromLine = _toLine = 0;
+
+    // event types of all parts, as ordered in the event type set
+    EventTypeSet* types = _data->eventTypes();
+    _columns.fill(-1, types->realCount());
+    foreach(TracePart* p, parts) {
+        EventTypeMapping* m = p->eventTypeMapping();
+        for(int i = 0; m && (i < m->count()); i++)
+            if ((m->realIndex(i) >= 0) && (m->realIndex(i) < _columns.count()))
+                _columns[m->realIndex(i)] = 0;
+    }
+    QByteArray events;
+    _columnCount = 0;
+    for(int i = 0; i < _columns.count(); i++) {
+        if (_columns.at(i) < 0) continue;
+        _columns[i] = _columnCount++;
+        events += ' ';
+        events += types->realType(i)->name().toLocal8Bit();
+    }
+    _totals.fill(0, _columnCount);
+
+    // positions given in the parts
+    _hasAddr = false;
+    _hasLine = false;
+    foreach(TracePart* p, parts) {
+        foreach(ProfileCostArray* dep, p->deps()) {
+            TracePartFunction* pf = (TracePartFunction*) dep;
+            for(FixCost* fc = pf->firstFixCost(); fc; fc = fc->nextCostOfPartFunction()) {
+                if (fc->fromAddr() != Addr(0)) _hasAddr = true;
+                if (fc->fromLine() != 0) _hasLine = true;
+                if (_hasAddr && _hasLine) break;
+            }
+            if (_hasAddr && _hasLine) break;
+        }
+    }
+    if (!_hasAddr) _hasLine = true;
+
+    // header
+    TracePart* first = parts.first();
+    if (!_mergeParts) {
+        _buffer += "\npart: ";
+        appendNumber(_buffer, (first->partNumber() > 0) ? first->partNumber() :
+                                                          _parts.indexOf(first) + 1);
+        _buffer += '\n';
+    }
+    bool samePid = true, sameTid = true;
+    foreach(TracePart* p, parts) {
+        if (p->processID() != first->processID()) samePid = false;
+        if (p->threadID() != first->threadID()) sameTid = false;
+    }
+    if (samePid && (first->processID() > 0)) {
+        _buffer += "pid: ";
+        appendNumber(_buffer, first->processID());
+        _buffer += '\n';
+    }
+    if (sameTid && (first->threadID() > 0)) {
+        _buffer += "thread: ";
+        appendNumber(_buffer, first->threadID());
+        _buffer += '\n';
+    }
+    if ((parts.count() == 1) && !first->trigger().isEmpty()) {
+        _buffer += "desc: Trigger: ";
+        _buffer += first->trigger().toLocal8Bit();
+        _buffer += '\n';
+    }
+    _buffer += "\npositions:";
+    if (_hasAddr) _buffer += " instr";
+    if (_hasLine) _buffer += " line";
+    _buffer += "\nevents:";
+    _buffer += events;
+    _buffer += "\n";
+
+    // functions sorted by object and file, to need few "ob=" and "fl=" lines
+    QVector<TraceFunction*> functions;
+    TraceFunctionMap::Iterator it;
+    for ( it = _data->functionMap().begin();
+          it != _data->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        if (isSelected(f)) functions.append(f);
+    }
+    std::sort(functions.begin(), functions.end(),
+              [](TraceFunction* f1, TraceFunction* f2) {
+        if (f1->object()->nameId() != f2->object()->nameId())
+            return f1->object()->nameId() < f2->object()->nameId();
+        return f1->file()->nameId() < f2->file()->nameId();
+    });
+
+    foreach(TraceFunction* f, functions) {
+        writeFunction(f, parts);
+        if (_error) return;
+    }
+
+    _buffer += "\ntotals:";
+    writeCosts(_totals.constData(), _columnCount);
+    _buffer += '\n';
+}
+
+void CallgrindWriter::writeFunction(TraceFunction* f, const TracePartList& parts)
+{
+    int count = _columnCount;
+    QMap<CostKey, int> costs;
+    QMap<CallKey, int> calls;
+    QMap<JumpKey, int> jumps;
+    QVector<SubCost> costValues, callValues, jumpValues;
+    QVector<int> column;
+
+    foreach(TracePart* p, parts) {
+        TracePartFunction* pf = (TracePartFunction*) f->findDepFromPart(p);
+        if (!pf) continue;
+
+        EventTypeMapping* m = p->eventTypeMapping();
+        int n = m ? m->count() : 0;
+        column.resize(n);
+        for(int i = 0; i < n; i++)
+            column[i] = _columns.value(m->realIndex(i), -1);
+
+        for(FixCost* fc = pf->firstFixCost(); fc; fc = fc->nextCostOfPartFunction()) {
+            CostKey k;
+            k.file = fc->functionSource()->file();
+            k.fromAddr = fc->fromAddr();
+            k.toAddr = fc->toAddr();
+            k.fromLine = fc->fromLine();
+            k.toLine = fc->toLine();
+            int index = costIndex(costs, k, costValues, count);
+            SubCost* c = costValues.data() + count * index;
+            for(int i = 0; (i < fc->costCount()) && (i < n); i++)
+                if (column.at(i) >= 0)
+                    c[column.at(i)] += fc->costs()[i];
+        }
+
+        foreach(TracePartCall* pc, pf->partCallings()) {
+            for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                fcc = fcc->nextCostOfPartCall()) {
+                CallKey k;
+                k.file = fcc->functionSource()->file();
+                k.addr = fcc->addr();
+                k.line = fcc->line();
+                k.called = pc->call()->called(true);
+                // call count follows the costs
+                int index = costIndex(calls, k, callValues, count+1);
+                SubCost* c = callValues.data() + (count+1) * index;
+                for(int i = 0; (i < fcc->costCount()) && (i < n); i++)
+                    if (column.at(i) >= 0)
+                        c[column.at(i)] += fcc->costs()[i];
+                c[count] += fcc->callCount();
+            }
+        }
+
+        for(FixJump* fj = pf->firstFixJump(); fj; fj = fj->nextJumpOfPartFunction()) {
+            JumpKey k;
+            k.file = fj->source()->file();
+            k.addr = fj->addr();
+            k.line = fj->line();
+            k.target = fj->targetFunction();
+            k.targetFile = fj->targetSource()->file();
+            k.targetAddr = fj->targetAddr();
+            k.targetLine = fj->targetLine();
+            k.isCondJump = fj->isCondJump();
+            int index = costIndex(jumps, k, jumpValues, 2);
+            SubCost* c = jumpValues.data() + 2 * index;
+            c[0] += fj->executedCount();
+            c[1] += fj->followedCount();
+        }
+    }
+    if (costs.isEmpty() && calls.isEmpty() && jumps.isEmpty()) return;
+
+    if (f->object() != _object) {
+        writeObject("ob=", f->object());
+        _object = f->object();
+    }
+    if (f->file() != _functionFile) {
+        writeFile("fl=", f->file());
+        _functionFile = f->file();
+    }
+    writeFunctionName("fn=", f);
+    _file = _functionFile;
+
+    QMap<CostKey, int>::const_iterator cit;
+    for(cit = costs.constBegin(); cit != costs.constEnd(); ++cit) {
+        const CostKey& k = cit.key();
+        if (k.file != _file) {
+            writeFile("fi=", k.file);
+            _file = k.file;
+        }
+        const SubCost* c = costValues.constData() + count * cit.value();
+        writePosition(k.fromAddr, k.toAddr, k.fromLine, k.toLine);
+        writeCosts(c, count);
+        _buffer += '\n';
+        for(int i = 0; i < count; i++)
+            _totals[i] += c[i];
+    }
+
+    QMap<CallKey, int>::const_iterator callIt;
+    for(callIt = calls.constBegin(); callIt != calls.constEnd(); ++callIt) {
+        const CallKey& k = callIt.key();
+        if (k.file != _file) {
+            writeFile("fi=", k.file);
+            _file = k.file;
+        }
+        // the loader defaults to object and file of the caller
+        if (k.called->object() != _object)
+            writeObject("cob=", k.called->object());
+        if (k.called->file() != _file)
+            writeFile("cfi=", k.called->file());
+        writeFunctionName("cfn=", k.called);
+
+        // the target position is not stored
+        const SubCost* c = callValues.constData() + (count+1) * callIt.value();
+        _buffer += "calls=";
+        appendNumber(_buffer, c[count]);
+        _buffer += ' ';
+        writeAbsolutePosition(Addr(0), 0);
+        _buffer += '\n';
+        writePosition(k.addr, k.addr, k.line, k.line);
+        writeCosts(c, count);
+        _buffer += '\n';
+    }
+
+    QMap<JumpKey, int>::const_iterator jit;
+    for(jit = jumps.constBegin(); jit != jumps.constEnd(); ++jit) {
+        const JumpKey& k = jit.key();
+
+        /* A function first named in "jfn=" is created with the object
+         * of the current function: skip jumps this would get wrong.
+         */
+        if ((k.target != f) && !_functionIds.contains(k.target) &&
+            ((k.target->object() != _object) || (k.target->file() != k.targetFile)))
+            continue;
+
+        if (k.file != _file) {
+            writeFile("fi=", k.file);
+            _file = k.file;
+        }
+        if ((k.target != f) || (k.targetFile != _file)) {
+            writeFile("jfi=", k.targetFile);
+            writeFunctionName("jfn=", k.target);
+        }
+        const SubCost* c = jumpValues.constData() + 2 * jit.value();
+        if (k.isCondJump) {
+            _buffer += "jcnd=";
+            appendNumber(_buffer, c[1]);
+            _buffer += '/';
+        }
+        else
+            _buffer += "jump=";
+        appendNumber(_buffer, c[0]);
+        _buffer += ' ';
+        writeAbsolutePosition(k.targetAddr, k.targetLine);
+        _buffer += '\n';
+        writePosition(k.addr, k.addr, k.line, k.line);
+        _buffer += '\n';
+    }
+
+    flush();
+}
+
+/* Name compression: "(<id>) <name>" on first use, "(<id>)" afterwards.
+ * An empty name is written as "???", which the loader maps back.
+ */
+void CallgrindWriter::writeName(const char* prefix, QHash<const void*, int>& ids,
+                                const void* item, const QString& name)
+{
+    _buffer += prefix;
+    _buffer += '(';
+
+    QHash<const void*, int>::const_iterator it = ids.constFind(item);
+    if (it != ids.constEnd()) {
+        appendNumber(_buffer, it.value());
+        _buffer += ")\n";
+        return;
+    }
+
+    int id = ids.count() + 1;
+    ids.insert(item, id);
+    appendNumber(_buffer, id);
+    _buffer += ") ";
+    if (name.isEmpty())
+        _buffer += "???";
+    else
+        _buffer += name.toLocal8Bit();
+    _buffer += '\n';
+}
+
+void CallgrindWriter::writeObject(const char* prefix, TraceObject* o)
+{
+    writeName(prefix, _objectIds, o, o ? o->name() : QString());
+}
+
+void CallgrindWriter::writeFile(const char* prefix, TraceFile* f)
+{
+    writeName(prefix, _fileIds, f, f ? f->name() : QString());
+}
+
+void CallgrindWriter::writeFunctionName(const char* prefix, TraceFunction* f)
+{
+    writeName(prefix, _functionIds, f, f->name());
+}
+
+/* Relative to the previous position: "*" if unchanged, "+<diff>" or
+ * "-<diff>" if shorter than the absolute value.
+ */
+void CallgrindWriter::writePosition(Addr fromAddr, Addr toAddr,
+                                    uint fromLine, uint toLine)
+{
+    if (_hasAddr) {
+        uint64 from = fromAddr.value(), last = _fromAddr.value();
+        if ((fromAddr == _fromAddr) && (toAddr == _toAddr))
+            _buffer += '*';
+        else if ((from > last) && (from - last < 0x80000000ULL)) {
+            _buffer += '+';
+            appendNumber(_buffer, from - last);
+        }
+        else if ((from < last) && (last - from < 0x80000000ULL)) {
+            _buffer += '-';
+            appendNumber(_buffer, last - from);
+        }
+        else
+            appendHex(_buffer, from);
+
+        if (toAddr != fromAddr) {
+            _buffer += ':';
+            appendHex(_buffer, toAddr.value());
+        }
+        _fromAddr = fromAddr;
+        _toAddr = toAddr;
+    }
+
+    if (_hasLine) {
+        if (_hasAddr) _buffer += ' ';
+        if ((fromLine == _fromLine) && (toLine == _toLine))
+            _buffer += '*';
+        else if ((fromLine > _fromLine) && (fromLine - _fromLine < fromLine / 10)) {
+            _buffer += '+';
+            appendNumber(_buffer, fromLine - _fromLine);
+        }
+        else if ((fromLine < _fromLine) && (_fromLine - fromLine < fromLine / 10)) {
+            _buffer += '-';
+            appendNumber(_buffer, _fromLine - fromLine);
+        }
+        else
+            appendNumber(_buffer, fromLine);
+
+        if (toLine != fromLine) {
+            _buffer += ':';
+            appendNumber(_buffer, toLine);
+        }
+        _fromLine = fromLine;
+        _toLine = toLine;
+    }
+}
+
+// absolute position, not changing the base of relative positions
+void CallgrindWriter::writeAbsolutePosition(Addr addr, uint line)
+{
+    if (_hasAddr)
+        appendHex(_buffer, addr.value());
+    if (_hasLine) {
+        if (_hasAddr) _buffer += ' ';
+        appendNumber(_buffer, line);
+    }
+}
+
+// trailing zeros are omitted
+void CallgrindWriter::writeCosts(const SubCost* costs, int count)
+{
+    while((count > 0) && (costs[count-1] == 0)) count--;
+    for(int i = 0; i < count; i++) {
+        _buffer += ' ';
+        appendNumber(_buffer, costs[i]);
+    }
+}
+
+void CallgrindWriter::flush(bool force)
+{
+    if (_error || (!force && (_buffer.size() < BUFFER_SIZE))) return;
+
+    if (_device->write(_buffer) != _buffer.size())
+        _error = true;
+    _buffer.resize(0);
+}
@@ -0,0 +1,103 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Export of profile data in callgrind format
+ */
+
+#ifndef CALLGRINDWRITER_H
+#define CALLGRINDWRITER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include "tracedata.h"
+
+class QIODevice;
+
+/**
+ * Writes parts of a TraceData in callgrind format, e.g. to merge
+ * multiple profile data files into one. Costs are taken from the
+ * Fix*Cost items of the parts, so no dynamic cost items are built.
+ *
+ * Output is compact as written by Callgrind itself: names are
+ * compressed as "(<id>) <name>" on first use and "(<id>)" later,
+ * and positions are relative to the previous one. Memory needed
+ * besides the output buffer is bounded by the costs of one function.
+ */
+class CallgrindWriter
+{
+public:
+    explicit CallgrindWriter(TraceData* data);
+
+    // parts to write, default are all parts of the data
+    void setParts(const TracePartList& parts) { _parts = parts; }
+
+    // only write functions of ELF objects with given (full or short) names
+    void setObjects(const QStringList& objects) { _objects = objects; }
+
+    // write all parts merged into one part (default), or each separately
+    void setMergeParts(bool merge) { _mergeParts = merge; }
+
+    // returns false on write error
+    bool write(QIODevice* device);
+    // number of parts in output of last write(): 1 if merged
+    int partsWritten() const { return _partsWritten; }
+
+private:
+    void writeSection(const TracePartList& parts);
+    void writeFunction(TraceFunction* f, const TracePartList& parts);
+    bool isSelected(TraceFunction* f) const;
+
+    void writeName(const char* prefix, QHash<const void*, int>& ids,
+                   const void* item, const QString& name);
+    void writeObject(const char* prefix, TraceObject* o);
+    void writeFile(const char* prefix, TraceFile* f);
+    void writeFunctionName(const char* prefix, TraceFunction* f);
+    void writePosition(Addr fromAddr, Addr toAddr, uint fromLine, uint toLine);
+    void writeAbsolutePosition(Addr addr, uint line);
+    void writeCosts(const SubCost* costs, int count);
+    void flush(bool force = false);
+
+    TraceData* _data;
+    TracePartList _parts;
+    QStringList _objects;
+    bool _mergeParts;
+    int _partsWritten;
+
+    // state of a section, as seen by the loader
+    QHash<const void*, int> _objectIds, _fileIds, _functionIds;
+    TraceObject* _object;
+    TraceFile *_file, *_functionFile;
+    Addr _fromAddr, _toAddr;
+    uint _fromLine, _toLine;
+    bool _hasAddr, _hasLine;
+
+    // output column for real event type index, -1 if not written
+    QVector<int> _columns;
+    int _columnCount;
+    QVector<SubCost> _totals;
+
+    QByteArray _buffer;
+    QIODevice* _device;
+    bool _error;
+};
+
+#endif // CALLGRINDWRITER_H
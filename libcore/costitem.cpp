@@ -21,6 +21,7 @@
 #include <QObject>
 
 #include "tracedata.h"
+#include "costkernels.h"
 
 #define TRACE_DEBUG      0
 #define TRACE_ASSERTIONS 0
@@ -415,30 +416,13 @@ void ProfileCostArray::maxCost(EventTypeMapping* mapping, FixString & s)
 
 void ProfileCostArray::addCost(ProfileCostArray* item)
 {
-    int i;
     if (!item) return;
 
     // we have to update the other item if needed
     // because we access the item costs directly
     if (item->_dirty) item->update();
 
-    // make sure we have enough space allocated
-    reserve(item->_count);
-
-    if (item->_count < _count) {
-        for (i = 0; i<item->_count; ++i)
-            _cost[i] += item->_cost[i];
-    }
-    else {
-        for (i = 0; i<_count; ++i)
-            _cost[i] += item->_cost[i];
-        for (; i<item->_count; ++i)
-            _cost[i] = item->_cost[i];
-        _count = item->_count;
-    }
-
-    Q_ASSERT(_count <= _allocCount);
-    invalidate();
+    addCost(item->_cost, item->_count);
 
 #if TRACE_DEBUG
     _dirty = false; // do not recurse !
@@ -449,33 +433,44 @@ void ProfileCostArray::addCost(ProfileCostArray* item)
 #endif
 }
 
-void ProfileCostArray::maxCost(ProfileCostArray* item)
+void ProfileCostArray::addCostDiff(ProfileCostArray* item, bool subtract)
 {
-    int i;
-
     if (!item) return;
-
-    // we have to update the other item if needed
-    // because we access the item costs directly
     if (item->_dirty) item->update();
 
-    // make sure we have enough space allocated
     reserve(item->_count);
-
-    if (item->_count < _count) {
-        for (i = 0; i<item->_count; ++i)
-            if (_cost[i] < item->_cost[i]) _cost[i] = item->_cost[i];
-    }
-    else {
-        for (i = 0; i<_count; ++i)
-            if (_cost[i] < item->_cost[i]) _cost[i] = item->_cost[i];
-        for (; i<item->_count; ++i)
-            _cost[i] = item->_cost[i];
+    for (int i = _count; i<item->_count; ++i)
+        _cost[i] = 0;
+    if (_count < item->_count)
         _count = item->_count;
+
+    if (subtract) {
+        for (int i = 0; i<item->_count; ++i)
+            _cost[i] -= item->_cost[i];
     }
+    else
+        CostKernels::add(_cost, item->_cost, item->_count);
 
-    Q_ASSERT(_count <= _allocCount);
-    invalidate();
+    // cached value is invalid
+    _cachedType = nullptr;
+}
+
+void ProfileCostArray::updateActivation(ProfileCostArray* item, bool active)
+{
+    if (_dirty) return;
+
+    addCostDiff(item, !active);
+}
+
+void ProfileCostArray::maxCost(ProfileCostArray* item)
+{
+    if (!item) return;
+
+    // we have to update the other item if needed
+    // because we access the item costs directly
+    if (item->_dirty) item->update();
+
+    maxCost(item->_cost, item->_count);
 
 #if TRACE_DEBUG
     _dirty = false; // do not recurse !
@@ -524,6 +519,42 @@ void ProfileCostArray::maxCost(int realIndex, SubCost value)
     invalidate();
 }
 
+void ProfileCostArray::addCost(const SubCost* costs, int count)
+{
+    // make sure we have enough space allocated
+    reserve(count);
+
+    if (count < _count)
+        CostKernels::add(_cost, costs, count);
+    else {
+        CostKernels::add(_cost, costs, _count);
+        for (int i = _count; i<count; ++i)
+            _cost[i] = costs[i];
+        _count = count;
+    }
+
+    Q_ASSERT(_count <= _allocCount);
+    invalidate();
+}
+
+void ProfileCostArray::maxCost(const SubCost* costs, int count)
+{
+    // make sure we have enough space allocated
+    reserve(count);
+
+    if (count < _count)
+        CostKernels::max(_cost, costs, count);
+    else {
+        CostKernels::max(_cost, costs, _count);
+        for (int i = _count; i<count; ++i)
+            _cost[i] = costs[i];
+        _count = count;
+    }
+
+    Q_ASSERT(_count <= _allocCount);
+    invalidate();
+}
+
 
 ProfileCostArray ProfileCostArray::diff(ProfileCostArray* item)
 {
@@ -171,12 +171,24 @@ public:
     // add the cost of another item
     void addCost(ProfileCostArray* item);
     void addCost(int index, SubCost value);
+    // add <count> costs in real index order (identity mapping)
+    void addCost(const SubCost* costs, int count);
 
     // maximal cost
     void maxCost(EventTypeMapping*, FixString&);
     void maxCost(ProfileCostArray* item);
     void maxCost(int index, SubCost value);
+    void maxCost(const SubCost* costs, int count);
     ProfileCostArray diff(ProfileCostArray* item);
+    // add (or subtract) the cost of another item, without invalidation
+    void addCostDiff(ProfileCostArray* item, bool subtract);
+
+    /**
+     * Incremental update after the part of dependency <item> was
+     * (de)activated: add or subtract its cost. Nothing is done if this
+     * cost is invalid, as it gets recalculated on next access anyway.
+     */
+    virtual void updateActivation(ProfileCostArray* item, bool active);
 
     void invalidate() override;
 
@@ -0,0 +1,226 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Vectorized kernels for cost array arithmetic
+ */
+
+#include "costkernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define COSTKERNELS_X86 1
+#include <immintrin.h>
+#else
+#define COSTKERNELS_X86 0
+#endif
+
+// kernels access the 64bit values directly
+static_assert(sizeof(SubCost) == sizeof(uint64), "SubCost must be 64bit");
+
+
+//
+// Scalar versions, always available
+//
+
+static void addScalar(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    for (int i = 0; i < n; i++)
+        d[i] += s[i];
+}
+
+static void maxScalar(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    for (int i = 0; i < n; i++)
+        if (d[i] < s[i]) d[i] = s[i];
+}
+
+
+#if COSTKERNELS_X86
+
+//
+// SSE2: 2 lanes of 64bit
+//
+
+__attribute__((target("sse2")))
+static void addSSE2(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + i));
+        _mm_storeu_si128((__m128i*)(d + i), _mm_add_epi64(a, b));
+    }
+    for (; i < n; i++)
+        d[i] += s[i];
+}
+
+// SSE2 has no 64bit compare: combine unsigned 32bit compares of the
+// high and low halves, which are made signed by flipping the top bit
+__attribute__((target("sse2")))
+static void maxSSE2(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    const __m128i bias = _mm_set1_epi32((int) 0x80000000);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(b, bias),
+                                     _mm_xor_si128(a, bias));
+        __m128i eq = _mm_cmpeq_epi32(a, b);
+        __m128i gtHi = _mm_shuffle_epi32(gt, _MM_SHUFFLE(3,3,1,1));
+        __m128i gtLo = _mm_shuffle_epi32(gt, _MM_SHUFFLE(2,2,0,0));
+        __m128i eqHi = _mm_shuffle_epi32(eq, _MM_SHUFFLE(3,3,1,1));
+        // all bits set in 64bit lanes where b > a
+        __m128i mask = _mm_or_si128(gtHi, _mm_and_si128(eqHi, gtLo));
+        __m128i r = _mm_or_si128(_mm_and_si128(mask, b),
+                                 _mm_andnot_si128(mask, a));
+        _mm_storeu_si128((__m128i*)(d + i), r);
+    }
+    for (; i < n; i++)
+        if (d[i] < s[i]) d[i] = s[i];
+}
+
+
+//
+// AVX2: 4 lanes of 64bit
+//
+
+__attribute__((target("avx2")))
+static void addAVX2(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(d + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(s + i));
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_add_epi64(a, b));
+    }
+    for (; i < n; i++)
+        d[i] += s[i];
+}
+
+// the 64bit compare is signed: flip the top bit for unsigned order
+__attribute__((target("avx2")))
+static void maxAVX2(SubCost* dst, const SubCost* src, int n)
+{
+    uint64* d = (uint64*) dst;
+    const uint64* s = (const uint64*) src;
+    const __m256i bias = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(d + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i mask = _mm256_cmpgt_epi64(_mm256_xor_si256(b, bias),
+                                          _mm256_xor_si256(a, bias));
+        _mm256_storeu_si256((__m256i*)(d + i),
+                            _mm256_blendv_epi8(a, b, mask));
+    }
+    for (; i < n; i++)
+        if (d[i] < s[i]) d[i] = s[i];
+}
+
+#endif // COSTKERNELS_X86
+
+
+//
+// CostKernels
+//
+
+bool CostKernels::isSupported(Implementation impl)
+{
+    switch(impl) {
+    case Scalar:
+        return true;
+#if COSTKERNELS_X86
+    case SSE2:
+        return __builtin_cpu_supports("sse2");
+    case AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        break;
+    }
+    return false;
+}
+
+CostKernels::Implementation CostKernels::best()
+{
+    if (isSupported(AVX2)) return AVX2;
+    if (isSupported(SSE2)) return SSE2;
+    return Scalar;
+}
+
+CostKernels::Implementation CostKernels::implementation()
+{
+    return dispatch().impl;
+}
+
+const char* CostKernels::name(Implementation impl)
+{
+    switch(impl) {
+    case Scalar: return "scalar";
+    case SSE2:   return "SSE2";
+    case AVX2:   return "AVX2";
+    default:     break;
+    }
+    return "unknown";
+}
+
+bool CostKernels::setImplementation(Implementation impl)
+{
+    if (!isSupported(impl)) return false;
+
+    dispatch().set(impl);
+    return true;
+}
+
+CostKernels::Dispatch::Dispatch()
+{
+    set(best());
+}
+
+void CostKernels::Dispatch::set(Implementation i)
+{
+    switch(i) {
+#if COSTKERNELS_X86
+    case SSE2:
+        add = addSSE2;
+        max = maxSSE2;
+        break;
+    case AVX2:
+        add = addAVX2;
+        max = maxAVX2;
+        break;
+#endif
+    default:
+        add = addScalar;
+        max = maxScalar;
+        break;
+    }
+    impl = i;
+}
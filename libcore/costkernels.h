@@ -0,0 +1,79 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Vectorized kernels for cost array arithmetic
+ */
+
+#ifndef COSTKERNELS_H
+#define COSTKERNELS_H
+
+#include "subcost.h"
+
+/**
+ * Element-wise add and maximum of SubCost arrays.
+ *
+ * These are the inner loops of cost aggregation. On x86, SSE2 and AVX2
+ * versions are provided besides a scalar fallback; the best one supported
+ * by the CPU is chosen at runtime on first use. Choosing is thread-safe,
+ * as first use may happen in any loader or update thread.
+ */
+class CostKernels
+{
+public:
+    enum Implementation { Scalar = 0, SSE2, AVX2, ImplementationCount };
+
+    /// dst[i] += src[i] for 0 <= i < n
+    static void add(SubCost* dst, const SubCost* src, int n)
+    { if (n > 0) addFunc()(dst, src, n); }
+
+    /// dst[i] = max(dst[i], src[i]) for 0 <= i < n
+    static void max(SubCost* dst, const SubCost* src, int n)
+    { if (n > 0) maxFunc()(dst, src, n); }
+
+    static bool isSupported(Implementation);
+    static Implementation best();
+    static Implementation implementation();
+    static const char* name(Implementation);
+
+    /**
+     * Force use of an implementation, for benchmarking.
+     * Not thread-safe: no kernels may be used at the same time.
+     * Returns false if not supported by the CPU.
+     */
+    static bool setImplementation(Implementation);
+
+private:
+    typedef void (*Kernel)(SubCost*, const SubCost*, int);
+
+    struct Dispatch
+    {
+        Dispatch(); // chooses best()
+        void set(Implementation);
+
+        Kernel add, max;
+        Implementation impl;
+    };
+
+    // initialization of function-local statics is thread-safe
+    static Dispatch& dispatch() { static Dispatch d; return d; }
+    static Kernel addFunc() { return dispatch().add; }
+    static Kernel maxFunc() { return dispatch().max; }
+};
+
+#endif // COSTKERNELS_H
@@ -0,0 +1,467 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Streaming decompression of profile data files
+ */
+
+#include "decompressdevice.h"
+
+#include <QThread>
+#include <QObject>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+#include <string.h>
+
+// size of decompressed buffers handed to the reader
+#define OUTPUT_BUFFER_SIZE (4*1024*1024)
+// size of compressed input read at once from the source
+#define INPUT_BUFFER_SIZE (256*1024)
+
+
+/**
+ * Decoder for one compression format.
+ *
+ * decode() consumes input from <in> and writes output to <out>, advancing
+ * both. <inputEnd> is set if no more input follows the given one.
+ * Returns false on corrupt data. <finished> is set if all input so far
+ * formed complete compressed streams.
+ */
+class Decoder
+{
+public:
+    virtual ~Decoder() {}
+    virtual bool decode(const char*& in, const char* inEnd, bool inputEnd,
+                        char*& out, char* outEnd, bool& finished) = 0;
+};
+
+
+#ifdef HAVE_ZLIB
+class GzipDecoder: public Decoder
+{
+public:
+    GzipDecoder()
+    {
+        memset(&_z, 0, sizeof(_z));
+        // 16: expect gzip header
+        _ok = (inflateInit2(&_z, 16 + MAX_WBITS) == Z_OK);
+        _streamEnd = false;
+    }
+    ~GzipDecoder() override { if (_ok) inflateEnd(&_z); }
+
+    bool decode(const char*& in, const char* inEnd, bool,
+                char*& out, char* outEnd, bool& finished) override
+    {
+        if (!_ok) return false;
+
+        // gzip files can consist of multiple concatenated members
+        if (_streamEnd && (in < inEnd)) {
+            inflateReset(&_z);
+            _streamEnd = false;
+        }
+
+        _z.next_in = (Bytef*) in;
+        _z.avail_in = (uInt) (inEnd - in);
+        _z.next_out = (Bytef*) out;
+        _z.avail_out = (uInt) (outEnd - out);
+        int res = inflate(&_z, Z_NO_FLUSH);
+        in = (const char*) _z.next_in;
+        out = (char*) _z.next_out;
+
+        if (res == Z_STREAM_END) _streamEnd = true;
+        finished = _streamEnd;
+        return (res == Z_OK) || (res == Z_STREAM_END) || (res == Z_BUF_ERROR);
+    }
+
+private:
+    z_stream _z;
+    bool _ok, _streamEnd;
+};
+#endif
+
+
+#ifdef HAVE_ZSTD
+class ZstdDecoder: public Decoder
+{
+public:
+    ZstdDecoder()
+    {
+        _stream = ZSTD_createDStream();
+        if (_stream) ZSTD_initDStream(_stream);
+        _frameEnd = true;
+    }
+    ~ZstdDecoder() override { ZSTD_freeDStream(_stream); }
+
+    bool decode(const char*& in, const char* inEnd, bool,
+                char*& out, char* outEnd, bool& finished) override
+    {
+        if (!_stream) return false;
+
+        ZSTD_inBuffer input = { in, (size_t) (inEnd - in), 0 };
+        ZSTD_outBuffer output = { out, (size_t) (outEnd - out), 0 };
+        size_t res = ZSTD_decompressStream(_stream, &output, &input);
+        in += input.pos;
+        out += output.pos;
+        if (ZSTD_isError(res)) return false;
+
+        // 0: a frame is completely decoded and flushed
+        if (res == 0) _frameEnd = true;
+        else if (input.pos > 0 || output.pos > 0) _frameEnd = false;
+        finished = _frameEnd;
+        return true;
+    }
+
+private:
+    ZSTD_DStream* _stream;
+    bool _frameEnd;
+};
+#endif
+
+
+#ifdef HAVE_LZMA
+class XzDecoder: public Decoder
+{
+public:
+    XzDecoder()
+    {
+        _stream = LZMA_STREAM_INIT;
+        _ok = (lzma_stream_decoder(&_stream, UINT64_MAX,
+                                   LZMA_CONCATENATED) == LZMA_OK);
+        _streamEnd = false;
+    }
+    ~XzDecoder() override { lzma_end(&_stream); }
+
+    bool decode(const char*& in, const char* inEnd, bool inputEnd,
+                char*& out, char* outEnd, bool& finished) override
+    {
+        if (!_ok) return false;
+
+        _stream.next_in = (const uint8_t*) in;
+        _stream.avail_in = inEnd - in;
+        _stream.next_out = (uint8_t*) out;
+        _stream.avail_out = outEnd - out;
+        // with concatenated streams, the end is only known at input end
+        lzma_ret res = lzma_code(&_stream, inputEnd ? LZMA_FINISH : LZMA_RUN);
+        in = (const char*) _stream.next_in;
+        out = (char*) _stream.next_out;
+
+        if (res == LZMA_STREAM_END) _streamEnd = true;
+        finished = _streamEnd;
+        return (res == LZMA_OK) || (res == LZMA_STREAM_END) ||
+               (res == LZMA_BUF_ERROR && !inputEnd);
+    }
+
+private:
+    lzma_stream _stream;
+    bool _ok, _streamEnd;
+};
+#endif
+
+
+//
+// DecompressDevice
+//
+
+DecompressDevice::DecompressDevice(QIODevice* source, Format format)
+{
+    _source = source;
+    _format = format;
+    _decoder = nullptr;
+    _worker = nullptr;
+    _inPos = _inLen = 0;
+    _inEnd = false;
+    _sourceSize = 0;
+    _readBuffer = 0;
+    _finished = _abort = false;
+}
+
+DecompressDevice::~DecompressDevice()
+{
+    close();
+}
+
+DecompressDevice::Format DecompressDevice::detect(QIODevice* device)
+{
+    if (!device) return None;
+
+    QByteArray magic = device->peek(6);
+    if (magic.startsWith("\x1f\x8b"))
+        return Gzip;
+    if (magic.startsWith("\x28\xb5\x2f\xfd"))
+        return Zstd;
+    if (magic.startsWith(QByteArray("\xfd" "7zXZ\0", 6)))
+        return Xz;
+
+    return None;
+}
+
+bool DecompressDevice::isSupported(Format format)
+{
+    switch(format) {
+#ifdef HAVE_ZLIB
+    case Gzip: return true;
+#endif
+#ifdef HAVE_ZSTD
+    case Zstd: return true;
+#endif
+#ifdef HAVE_LZMA
+    case Xz:   return true;
+#endif
+    default: break;
+    }
+    return false;
+}
+
+QString DecompressDevice::formatName(Format format)
+{
+    switch(format) {
+    case Gzip: return QStringLiteral("gzip");
+    case Zstd: return QStringLiteral("zstd");
+    case Xz:   return QStringLiteral("xz");
+    default: break;
+    }
+    return QString();
+}
+
+bool DecompressDevice::open(OpenMode mode)
+{
+    if (isOpen() || (mode != QIODevice::ReadOnly)) return false;
+
+    if (!_source->isOpen() && !_source->open(QIODevice::ReadOnly)) {
+        setErrorString(_source->errorString());
+        return false;
+    }
+
+    switch(_format) {
+#ifdef HAVE_ZLIB
+    case Gzip: _decoder = new GzipDecoder; break;
+#endif
+#ifdef HAVE_ZSTD
+    case Zstd: _decoder = new ZstdDecoder; break;
+#endif
+#ifdef HAVE_LZMA
+    case Xz:   _decoder = new XzDecoder; break;
+#endif
+    default: break;
+    }
+    if (!_decoder) {
+        setErrorString(QObject::tr("Unsupported compression format"));
+        return false;
+    }
+
+    _in.resize(INPUT_BUFFER_SIZE);
+    _inPos = _inLen = 0;
+    _inEnd = false;
+    _sourceSize = _source->isSequential() ? 0 : _source->size();
+    _progress.storeRelease(0);
+
+    for(int i = 0; i < 2; i++) {
+        _buffers[i].data.resize(OUTPUT_BUFFER_SIZE);
+        _buffers[i].size = _buffers[i].pos = 0;
+        _buffers[i].filled = false;
+    }
+    _readBuffer = 0;
+    _finished = _abort = false;
+    _error.clear();
+
+    _worker = QThread::create([this]() { decompress(); });
+    _worker->start();
+
+    return QIODevice::open(mode);
+}
+
+void DecompressDevice::stopWorker()
+{
+    if (!_worker) return;
+
+    _mutex.lock();
+    _abort = true;
+    _freeCond.wakeAll();
+    _mutex.unlock();
+
+    _worker->wait();
+    delete _worker;
+    _worker = nullptr;
+}
+
+void DecompressDevice::close()
+{
+    if (!isOpen()) return;
+
+    stopWorker();
+    delete _decoder;
+    _decoder = nullptr;
+    _buffers[0].data.clear();
+    _buffers[1].data.clear();
+    _in.clear();
+
+    QIODevice::close();
+}
+
+bool DecompressDevice::atEnd() const
+{
+    if (!QIODevice::atEnd()) return false;
+
+    QMutexLocker locker(&_mutex);
+    const Buffer& b = _buffers[_readBuffer];
+    if (b.filled) return b.pos >= b.size && _finished;
+    return _finished;
+}
+
+int DecompressDevice::progress() const
+{
+    return _progress.loadAcquire();
+}
+
+QString DecompressDevice::errorMessage() const
+{
+    QMutexLocker locker(&_mutex);
+    return _error;
+}
+
+// Fill <b> with decompressed data. Returns false if no more data follows
+bool DecompressDevice::fill(Buffer& b)
+{
+    char* out = b.data.data();
+    char* outEnd = out + b.data.size();
+    bool finished = false;
+
+    while(out < outEnd) {
+        if ((_inPos == _inLen) && !_inEnd) {
+            qint64 read = _source->read(_in.data(), _in.size());
+            if (read < 0) {
+                QMutexLocker locker(&_mutex);
+                _error = _source->errorString();
+                break;
+            }
+            _inPos = 0;
+            _inLen = (int) read;
+            if (read == 0) _inEnd = true;
+            if (_sourceSize > 0)
+                _progress.storeRelease((int)(100.0 * _source->pos() / _sourceSize));
+        }
+
+        const char* in = _in.constData() + _inPos;
+        char* outStart = out;
+        bool ok = _decoder->decode(in, _in.constData() + _inLen, _inEnd,
+                                   out, outEnd, finished);
+        bool progressed = (in != _in.constData() + _inPos) || (out != outStart);
+        _inPos = in - _in.constData();
+
+        if (!ok) {
+            QMutexLocker locker(&_mutex);
+            _error = QObject::tr("Corrupt %1 data").arg(formatName(_format));
+            break;
+        }
+        if (!progressed && (_inPos < _inLen)) {
+            // decoder is stuck: should not happen with valid data
+            QMutexLocker locker(&_mutex);
+            _error = QObject::tr("Corrupt %1 data").arg(formatName(_format));
+            break;
+        }
+        if (_inEnd && (_inPos == _inLen) && !progressed) {
+            if (!finished) {
+                QMutexLocker locker(&_mutex);
+                _error = QObject::tr("Truncated %1 data").arg(formatName(_format));
+            }
+            break;
+        }
+    }
+
+    b.size = out - b.data.data();
+    b.pos = 0;
+    return (out == outEnd);
+}
+
+void DecompressDevice::decompress()
+{
+    int current = 0;
+    bool more = true;
+
+    while(more) {
+        Buffer& b = _buffers[current];
+
+        _mutex.lock();
+        while(b.filled && !_abort)
+            _freeCond.wait(&_mutex);
+        bool abort = _abort;
+        _mutex.unlock();
+        if (abort) return;
+
+        // buffer is owned by us now
+        more = fill(b);
+
+        _mutex.lock();
+        b.filled = true;
+        if (!more) {
+            _finished = true;
+            _progress.storeRelease(100);
+        }
+        _filledCond.wakeAll();
+        _mutex.unlock();
+
+        current = 1 - current;
+    }
+}
+
+qint64 DecompressDevice::readData(char* data, qint64 maxSize)
+{
+    qint64 done = 0;
+
+    while(done < maxSize) {
+        Buffer& b = _buffers[_readBuffer];
+
+        _mutex.lock();
+        while(!b.filled && !_finished)
+            _filledCond.wait(&_mutex);
+        bool filled = b.filled;
+        _mutex.unlock();
+        if (!filled) break; // end of data
+
+        // buffer is owned by us now
+        int len = b.size - b.pos;
+        if (len > maxSize - done) len = (int) (maxSize - done);
+        memcpy(data + done, b.data.constData() + b.pos, len);
+        b.pos += len;
+        done += len;
+
+        if (b.pos < b.size) break;
+
+        // hand buffer back to worker
+        _mutex.lock();
+        b.filled = false;
+        _freeCond.wakeAll();
+        _mutex.unlock();
+        _readBuffer = 1 - _readBuffer;
+    }
+
+    if ((done == 0) && !errorMessage().isEmpty()) {
+        setErrorString(errorMessage());
+        return -1;
+    }
+    return done;
+}
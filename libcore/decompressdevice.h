@@ -0,0 +1,109 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Streaming decompression of profile data files
+ */
+
+#ifndef DECOMPRESSDEVICE_H
+#define DECOMPRESSDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+class QThread;
+class Decoder;
+
+/**
+ * Sequential read-only device decompressing data from another device.
+ *
+ * Decompression runs in a background thread, alternating between two
+ * buffers: while the reader parses one buffer, the next one is filled.
+ * Neither a temporary file nor the whole decompressed data is needed.
+ *
+ * Supported formats depend on the libraries found at build time
+ * (zlib for gzip, libzstd, liblzma for xz).
+ */
+class DecompressDevice: public QIODevice
+{
+public:
+    enum Format { None = 0, Gzip, Zstd, Xz };
+
+    // <source> must stay valid while this device is open
+    DecompressDevice(QIODevice* source, Format format);
+    ~DecompressDevice() override;
+
+    /**
+     * Detect compression from magic bytes at the current position
+     * of <device>, which has to be open. Nothing is consumed.
+     */
+    static Format detect(QIODevice* device);
+    static bool isSupported(Format);
+    static QString formatName(Format);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+
+    /// progress in percent, from consumed compressed input
+    int progress() const;
+    /// empty if no error happened
+    QString errorMessage() const;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    struct Buffer {
+        QByteArray data;
+        int size;     // valid bytes, set by worker
+        int pos;      // read position, used by reader
+        bool filled;  // owned by reader if set, else by worker
+    };
+
+    // runs in worker thread
+    void decompress();
+    bool fill(Buffer& b);
+    void stopWorker();
+
+    QIODevice* _source;
+    Format _format;
+    Decoder* _decoder;
+    QThread* _worker;
+
+    // compressed input, only used by worker
+    QByteArray _in;
+    int _inPos, _inLen;
+    bool _inEnd;
+    qint64 _sourceSize;
+    QAtomicInt _progress;
+
+    mutable QMutex _mutex;
+    QWaitCondition _filledCond, _freeCond;
+    Buffer _buffers[2];
+    int _readBuffer;
+    bool _finished, _abort;
+    QString _error;
+};
+
+#endif // DECOMPRESSDEVICE_H
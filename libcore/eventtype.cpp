@@ -20,6 +20,7 @@
 
 #include <QRegExp>
 #include <QDebug>
+#include <QMutex>
 
 #include "globalconfig.h"
 
@@ -28,6 +29,10 @@
 
 QList<EventType*>* EventType::_knownTypes = nullptr;
 
+// profile data may be loaded by multiple threads in parallel,
+// with "event:" lines adding to the list of known types
+static QMutex knownTypesMutex;
+
 EventType::EventType(const QString& name, const QString& longName,
                      const QString& formula)
 {
@@ -233,6 +238,7 @@ int EventType::histCost(ProfileCostArray* c, double total, double* hist)
 
 bool EventType::hasKnownRealType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -244,6 +250,7 @@ bool EventType::hasKnownRealType(const QString& n)
 
 bool EventType::hasKnownDerivedType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -255,6 +262,7 @@ bool EventType::hasKnownDerivedType(const QString& n)
 
 EventType* EventType::cloneKnownRealType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
 
     foreach (EventType* t, *_knownTypes)
@@ -269,6 +277,7 @@ EventType* EventType::cloneKnownRealType(const QString& n)
 
 EventType* EventType::cloneKnownDerivedType(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
 
     foreach (EventType* t, *_knownTypes)
@@ -287,6 +296,7 @@ void EventType::add(EventType* t, bool overwriteExisting)
 
     t->setEventTypeSet(nullptr);
 
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes)
         _knownTypes = new QList<EventType*>;
 
@@ -311,6 +321,7 @@ void EventType::add(EventType* t, bool overwriteExisting)
 
 int EventType::knownTypeCount()
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return 0;
 
     return _knownTypes->count();
@@ -318,6 +329,7 @@ int EventType::knownTypeCount()
 
 bool EventType::remove(const QString& n)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return false;
 
     foreach (EventType* t, *_knownTypes)
@@ -332,6 +344,7 @@ bool EventType::remove(const QString& n)
 
 EventType* EventType::knownType(int i)
 {
+    QMutexLocker locker(&knownTypesMutex);
     if (!_knownTypes) return nullptr;
     if (i<0 || i>=(int)_knownTypes->count()) return nullptr;
 
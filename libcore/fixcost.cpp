@@ -50,6 +50,33 @@ FixCost::FixCost(TracePart* part, FixPool* pool,
                                   partFunction->setFirstFixCost(this) : nullptr;
 }
 
+FixCost::FixCost(TracePart* part, FixPool* pool,
+                 TraceFunctionSource* functionSource,
+                 TracePartFunction* partFunction,
+                 const FixCost& fc)
+    : FixCost(part, pool, functionSource, fc._pos, partFunction,
+              fc._cost, fc._count)
+{}
+
+FixCost::FixCost(TracePart* part, FixPool* pool,
+                 TraceFunctionSource* functionSource,
+                 const PositionSpec& pos,
+                 TracePartFunction* partFunction,
+                 const SubCost* cost, int count)
+{
+    _part = part;
+    _functionSource = functionSource;
+    _pos = pos;
+    _count = count;
+
+    _cost = (SubCost*) pool->allocate(sizeof(SubCost) * _count);
+    for(int i=0; i<_count; i++)
+        _cost[i] = cost[i];
+
+    _nextCostOfPartFunction = partFunction ?
+                                  partFunction->setFirstFixCost(this) : nullptr;
+}
+
 void* FixCost::operator new(size_t size, FixPool* pool)
 {
     return pool->allocate(size);
@@ -61,6 +88,11 @@ void FixCost::addTo(ProfileCostArray* c)
 
     int i, realIndex;
 
+    if (sm->isIdentity()) {
+        c->addCost(_cost, _count);
+        return;
+    }
+
     c->reserve(sm->maxRealIndex(_count)+1);
     for(i=0; i<_count; i++) {
         realIndex = sm->realIndex(i);
@@ -106,6 +138,34 @@ FixCallCost::FixCallCost(TracePart* part, FixPool* pool,
     _nextCostOfPartCall = partCall ? partCall->setFirstFixCallCost(this) : nullptr;
 }
 
+FixCallCost::FixCallCost(TracePart* part, FixPool* pool,
+                         TraceFunctionSource* functionSource,
+                         TracePartCall* partCall,
+                         const FixCallCost& fcc)
+    : FixCallCost(part, pool, functionSource, fcc._line, fcc._addr,
+                  partCall, fcc._cost, fcc._count)
+{}
+
+FixCallCost::FixCallCost(TracePart* part, FixPool* pool,
+                         TraceFunctionSource* functionSource,
+                         unsigned int line, Addr addr,
+                         TracePartCall* partCall,
+                         const SubCost* cost, int count)
+{
+    _part = part;
+    _functionSource = functionSource;
+    _line = line;
+    _addr = addr;
+    _count = count;
+
+    // includes call count
+    _cost = (SubCost*) pool->allocate(sizeof(SubCost) * (_count+1));
+    for(int i=0; i<=_count; i++)
+        _cost[i] = cost[i];
+
+    _nextCostOfPartCall = partCall ? partCall->setFirstFixCallCost(this) : nullptr;
+}
+
 void* FixCallCost::operator new(size_t size, FixPool* pool)
 {
     return pool->allocate(size);
@@ -117,9 +177,13 @@ void FixCallCost::addTo(TraceCallCost* c)
 
     int i, realIndex;
 
-    for(i=0; i<_count; i++) {
-        realIndex = sm->realIndex(i);
-        c->addCost(realIndex, _cost[i]);
+    if (sm->isIdentity())
+        c->addCost(_cost, _count);
+    else {
+        for(i=0; i<_count; i++) {
+            realIndex = sm->realIndex(i);
+            c->addCost(realIndex, _cost[i]);
+        }
     }
     c->addCallCount(_cost[_count]);
 
@@ -134,6 +198,11 @@ void FixCallCost::setMax(ProfileCostArray* c)
 
     int i, realIndex;
 
+    if (sm->isIdentity()) {
+        c->maxCost(_cost, _count);
+        return;
+    }
+
     for(i=0; i<_count; i++) {
         realIndex = sm->realIndex(i);
         c->maxCost(realIndex, _cost[i]);
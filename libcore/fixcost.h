@@ -59,6 +59,17 @@ public:
             PositionSpec&,
             TracePartFunction*,
             FixString&);
+    // copy cost of <fc> into another trace (same event mapping)
+    FixCost(TracePart*, FixPool*,
+            TraceFunctionSource*,
+            TracePartFunction*,
+            const FixCost& fc);
+    // cost given as array of <count> values
+    FixCost(TracePart*, FixPool*,
+            TraceFunctionSource*,
+            const PositionSpec&,
+            TracePartFunction*,
+            const SubCost* cost, int count);
 
     void *operator new(size_t size, FixPool*);
 
@@ -74,6 +85,8 @@ public:
     Addr addr() const { return _pos.fromAddr; }
     Addr toAddr() const { return _pos.toAddr; }
     TraceFunctionSource* functionSource() const { return _functionSource; }
+    int costCount() const { return _count; }
+    const SubCost* costs() const { return _cost; }
 
     FixCost* nextCostOfPartFunction() const
     { return _nextCostOfPartFunction; }
@@ -103,6 +116,18 @@ public:
                 Addr addr,
                 TracePartCall*,
                 SubCost, FixString&);
+    // copy cost of <fcc> into another trace (same event mapping)
+    FixCallCost(TracePart*, FixPool*,
+                TraceFunctionSource*,
+                TracePartCall*,
+                const FixCallCost& fcc);
+    // cost given as array of <count> values, followed by call count
+    FixCallCost(TracePart*, FixPool*,
+                TraceFunctionSource*,
+                unsigned int line,
+                Addr addr,
+                TracePartCall*,
+                const SubCost* cost, int count);
 
     void *operator new(size_t size, FixPool*);
 
@@ -114,6 +139,9 @@ public:
     Addr addr() const { return _addr; }
     SubCost callCount() const { return _cost[_count]; }
     TraceFunctionSource* functionSource() const	{ return _functionSource; }
+    int costCount() const { return _count; }
+    // includes call count at index costCount()
+    const SubCost* costs() const { return _cost; }
     FixCallCost* nextCostOfPartCall() const
     { return _nextCostOfPartCall; }
 
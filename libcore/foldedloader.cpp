@@ -0,0 +1,313 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Loader for folded call stacks ("collapsed" format of FlameGraph)
+ */
+
+#include "loader.h"
+
+#include <string.h>
+
+#include <QAtomicInt>
+#include <QIODevice>
+#include <QVector>
+
+#include "addr.h"
+#include "tracedata.h"
+#include "utils.h"
+#include "stacksamples.h"
+
+// files are only split for parallel parsing into chunks at least this large
+#define MIN_CHUNK_SIZE (32*1024*1024)
+
+// number of lines checked for the format in canLoad()
+#define CHECK_LINES 10
+
+/*
+ * Folded call stacks, as written by the stackcollapse scripts of
+ * FlameGraph (and many other tools), have one line per distinct stack:
+ *
+ *   <frame>;<frame>;...;<frame> <count>
+ *
+ * with the outermost caller first. A frame may be prefixed with its
+ * module as in "libc.so.6`malloc". Counts are summed up as event
+ * "Samples" in one part.
+ */
+
+static inline bool isBlank(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/* Start of the count at end of line [s;end[ without trailing blanks,
+ * or nullptr if there is no count
+ */
+static const char* countStart(const char* s, const char* end)
+{
+    const char* p = end;
+    while((p > s) && (p[-1] >= '0') && (p[-1] <= '9')) p--;
+    if ((p == end) || (p == s) || !isBlank(p[-1])) return nullptr;
+    return p;
+}
+
+/*
+ * Parser for (a chunk of) folded call stacks into StackSamples.
+ * Multiple parsers can run in parallel on separate StackSamples.
+ */
+class FoldedParser
+{
+public:
+    explicit FoldedParser(StackSamples* samples);
+
+    // <progress> is called with percentage of <file> parsed
+    void parse(FixFile& file, const std::function<void(int)>& progress);
+
+    int invalidLines() const { return _invalidLines; }
+    int firstInvalidLine() const { return _firstInvalidLine; }
+
+private:
+    int frameIndex(const char* s, const char* end);
+
+    StackSamples* _samples;
+    int _part, _event;
+
+    // raw frame text, and index in _samples per ID of raw text
+    NameTable _raw;
+    QVector<int> _frames;
+    QVector<int> _stack;
+
+    int _invalidLines, _firstInvalidLine;
+};
+
+FoldedParser::FoldedParser(StackSamples* samples)
+{
+    _samples = samples;
+    _part = _samples->part(0);
+    _event = _samples->event(QStringLiteral("Samples"));
+    _invalidLines = 0;
+    _firstInvalidLine = 0;
+}
+
+void FoldedParser::parse(FixFile& file, const std::function<void(int)>& progress)
+{
+    FixString line;
+    int lineNo = 0, statusProgress = 0;
+
+    while (file.nextLine(line)) {
+        lineNo++;
+
+        if ((lineNo % 10000) == 0) {
+            int p = file.progress();
+            if (p != statusProgress) {
+                statusProgress = p;
+                progress(p);
+            }
+        }
+
+        const char* s = line.ascii();
+        const char* end = s + line.len();
+        while((end > s) && isBlank(end[-1])) end--;
+        if (s == end) continue;
+
+        const char* count = countStart(s, end);
+        if (!count) {
+            if (_invalidLines == 0) _firstInvalidLine = lineNo;
+            _invalidLines++;
+            continue;
+        }
+
+        SubCost value = 0;
+        for(const char* p = count; p < end; p++)
+            value = 10 * value + (*p - '0');
+
+        end = count;
+        while((end > s) && isBlank(end[-1])) end--;
+
+        _stack.resize(0);
+        while(s < end) {
+            const char* next = (const char*) memchr(s, ';', end - s);
+            if (!next) next = end;
+            _stack.append(frameIndex(s, next));
+            s = next + 1;
+        }
+        if (value > 0)
+            _samples->add(_part, _stack.constData(), _stack.count(),
+                          _event, value);
+    }
+}
+
+// "[<module>`]<function>[+0x<offset>]"
+int FoldedParser::frameIndex(const char* s, const char* end)
+{
+    int raw = _raw.intern(s, end - s);
+    if (raw < _frames.count()) return _frames.at(raw);
+
+    NameTable& names = _samples->names();
+    const char* p = s;
+    const char* tick = (const char*) memchr(s, '`', end - s);
+    if (tick) p = tick + 1;
+    int object = names.intern(s, tick ? tick - s : 0);
+
+    // offset into symbol
+    const char* symEnd = end;
+    const char* q = symEnd;
+    while((q > p) && (((q[-1] >= '0') && (q[-1] <= '9')) ||
+                      ((q[-1] >= 'a') && (q[-1] <= 'f')))) q--;
+    if ((q < symEnd) && (q - p > 3) && (q[-1] == 'x') &&
+        (q[-2] == '0') && (q[-3] == '+'))
+        symEnd = q - 3;
+
+    int function = (symEnd > p) ? names.intern(p, symEnd - p)
+                                : names.intern(QStringLiteral("[unknown]"));
+
+    int index = _samples->frame(function, object, names.intern(QString()));
+    _frames.append(index);
+    return index;
+}
+
+
+/*
+ * Loader for folded call stacks
+ */
+
+class FoldedLoader: public Loader
+{
+public:
+    FoldedLoader();
+
+    bool canLoad(QIODevice* file) override;
+    int  load(TraceData*, QIODevice* file, const QString& filename) override;
+
+private:
+    int loadInternal(TraceData*, QIODevice* file, const QString& filename);
+};
+
+FoldedLoader::FoldedLoader()
+    : Loader(QStringLiteral("Folded"),
+             QObject::tr( "Import filter for folded call stacks (FlameGraph)") )
+{}
+
+bool FoldedLoader::canLoad(QIODevice* file)
+{
+    if (!file) return false;
+
+    Q_ASSERT(file->isOpen());
+
+    /*
+     * We recognize folded call stacks if the first lines all end
+     * with a count separated by space, and at least one line has
+     * a call stack with multiple frames.
+     */
+    // peek: sequential devices cannot seek back for loading
+    char buf[4096];
+    int read = file->peek(buf, 4095);
+    if (read <= 0)
+        return false;
+    buf[read] = 0;
+
+    bool hasCall = false;
+    int lines = 0;
+    const char* s = buf;
+    const char* bufEnd = buf + read;
+    while((s < bufEnd) && (lines < CHECK_LINES)) {
+        const char* next = (const char*) memchr(s, '\n', bufEnd - s);
+        if (!next) {
+            // last line only checked if at end of file
+            if (read == 4095) break;
+            next = bufEnd;
+        }
+        const char* line = s;
+        const char* end = next;
+        s = next + 1;
+        while((end > line) && isBlank(end[-1])) end--;
+        if (line == end) continue;
+
+        if (isBlank(*line)) return false;
+        const char* count = countStart(line, end);
+        if (!count) return false;
+        if (memchr(line, ';', count - line)) hasCall = true;
+        lines++;
+    }
+    return hasCall;
+}
+
+int FoldedLoader::load(TraceData* d,
+                       QIODevice* file, const QString& filename)
+{
+    /* do the loading in a new object so parallel load
+     * operations do not interfere each other.
+     */
+    FoldedLoader l;
+
+    l.setLogger(d->logger());
+
+    return l.loadInternal(d, file, filename);
+}
+
+Loader* createFoldedLoader()
+{
+    return new FoldedLoader();
+}
+
+int FoldedLoader::loadInternal(TraceData* data,
+                               QIODevice* device, const QString& filename)
+{
+    if (!data || !device) return 0;
+
+    loadStart(filename);
+
+    FixFile file(device, filename);
+    if (!file.exists()) {
+        loadFinished(QStringLiteral("File does not exist"));
+        return 0;
+    }
+
+    /* Large files are split at line ends into chunks, parsed by
+     * worker threads. Line numbers are only known for the first chunk.
+     */
+    StackSamples samples;
+    QAtomicInt invalidLines, firstInvalidLine;
+    auto parseChunk = [&](int chunk, FixFile& f, StackSamples& s,
+                          const std::function<void(int)>& progress) {
+        FoldedParser parser(&s);
+        parser.parse(f, progress);
+        invalidLines.fetchAndAddRelaxed(parser.invalidLines());
+        if (chunk == 0)
+            firstInvalidLine.storeRelease(parser.firstInvalidLine());
+    };
+    auto progress = [this](int p) { loadProgress(p); };
+    if (!StackSamples::parseInChunks(file, "\n", MIN_CHUNK_SIZE, samples,
+                                     parseChunk, progress))
+        parseChunk(0, file, samples, progress);
+
+    if (invalidLines.loadAcquire() > 0)
+        loadWarning(firstInvalidLine.loadAcquire(),
+                    QObject::tr("Skipped %n line(s) without count", nullptr,
+                                invalidLines.loadAcquire()));
+
+    int partsAdded = samples.addTo(data, filename);
+    if (partsAdded == 0)
+        loadFinished(QStringLiteral("No samples found"));
+    else
+        loadFinished();
+
+    device->close();
+
+    return partsAdded;
+}
@@ -0,0 +1,171 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Export of call graph as folded call stacks
+ */
+
+#include "foldedwriter.h"
+
+#include <math.h>
+
+#include <QIODevice>
+
+#include "tracedata.h"
+
+// call stacks are cut at this depth
+#define MAX_DEPTH 1024
+
+// output buffer is written to device when reaching this size
+#define BUFFER_SIZE (64*1024)
+
+
+FoldedWriter::FoldedWriter(TraceData* data, EventType* eventType)
+{
+    _data = data;
+    _eventType = eventType;
+    _minFraction = 0.00001;
+    _minFlow = 1.0;
+    _withObjects = true;
+    _device = nullptr;
+    _error = false;
+    _lines = 0;
+}
+
+// self cost of <f> plus cost of calls to other functions
+double FoldedWriter::outCost(TraceFunction* f)
+{
+    QHash<TraceFunction*, double>::const_iterator it = _outCost.constFind(f);
+    if (it != _outCost.constEnd()) return it.value();
+
+    double cost = f->subCost(_eventType);
+    foreach(TraceCall* c, f->callings(true))
+        if (c->called(true) != f)
+            cost += c->subCost(_eventType);
+    _outCost.insert(f, cost);
+    return cost;
+}
+
+// ';' and line ends would break the format
+const QByteArray& FoldedWriter::frameName(TraceFunction* f)
+{
+    QHash<TraceFunction*, QByteArray>::const_iterator it = _frameNames.constFind(f);
+    if (it != _frameNames.constEnd()) return it.value();
+
+    QString name = f->name();
+    if (_withObjects && f->object() && !f->object()->shortName().isEmpty())
+        name = f->object()->shortName() + QLatin1Char('`') + name;
+    QByteArray n = name.toUtf8();
+    for(int i = 0; i < n.size(); i++)
+        if ((n[i] == ';') || (n[i] == '\n') || (n[i] == '\r'))
+            n[i] = (n[i] == ';') ? ':' : ' ';
+
+    return _frameNames.insert(f, n).value();
+}
+
+bool FoldedWriter::write(QIODevice* device)
+{
+    if (!_data || !_eventType || !device) return false;
+
+    _device = device;
+    _error = false;
+    _lines = 0;
+    _buffer.reserve(BUFFER_SIZE + 1024);
+
+    /* Call stacks start at functions with cost not flowing in
+     * from callers, e.g. "main" or thread start functions
+     */
+    QList<TraceFunction*> roots;
+    QList<double> rootFlows;
+    double total = 0.0;
+    TraceFunctionMap::Iterator it;
+    for ( it = _data->functionMap().begin();
+          it != _data->functionMap().end(); ++it ) {
+        TraceFunction* f = &(*it);
+        double in = 0.0;
+        foreach(TraceCall* c, f->callers(true))
+            if (c->caller(true) != f)
+                in += c->subCost(_eventType);
+        double flow = outCost(f) - in;
+        if (flow <= 0.0) continue;
+
+        roots.append(f);
+        rootFlows.append(flow);
+        total += flow;
+    }
+
+    _minFlow = total * _minFraction;
+    if (_minFlow < 1.0) _minFlow = 1.0;
+
+    for(int i = 0; (i < roots.count()) && !_error; i++)
+        writeStack(roots.at(i), rootFlows.at(i), 0);
+
+    if (!_error && !_buffer.isEmpty() &&
+        (_device->write(_buffer) != _buffer.size()))
+        _error = true;
+    _buffer.clear();
+    _outCost.clear();
+    _frameNames.clear();
+
+    return !_error;
+}
+
+void FoldedWriter::writeStack(TraceFunction* f, double flow, int depth)
+{
+    int pathLen = _path.size();
+    if (pathLen > 0) _path += ';';
+    _path += frameName(f);
+    _onPath.insert(f);
+
+    double out = outCost(f);
+    double self = flow;
+    if ((out > 0.0) && (depth < MAX_DEPTH)) {
+        self = flow * f->subCost(_eventType) / out;
+        foreach(TraceCall* c, f->callings(true)) {
+            TraceFunction* called = c->called(true);
+            if (called == f) continue;
+
+            double share = flow * c->subCost(_eventType) / out;
+            if ((share < _minFlow) || _onPath.contains(called))
+                self += share;
+            else
+                writeStack(called, share, depth + 1);
+        }
+    }
+    writeLine(self);
+
+    _onPath.remove(f);
+    _path.truncate(pathLen);
+}
+
+void FoldedWriter::writeLine(double cost)
+{
+    qulonglong c = (qulonglong) llround(cost);
+    if ((c == 0) || _error) return;
+
+    _buffer += _path;
+    _buffer += ' ';
+    _buffer += QByteArray::number(c);
+    _buffer += '\n';
+    _lines++;
+
+    if (_buffer.size() < BUFFER_SIZE) return;
+    if (_device->write(_buffer) != _buffer.size())
+        _error = true;
+    _buffer.resize(0);
+}
@@ -0,0 +1,82 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Export of call graph as folded call stacks
+ */
+
+#ifndef FOLDEDWRITER_H
+#define FOLDEDWRITER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+
+class QIODevice;
+class TraceData;
+class TraceFunction;
+class EventType;
+
+/**
+ * Writes the call graph of a TraceData as folded call stacks
+ * ("<caller>;...;<called> <cost>" per line), as used by FlameGraph.
+ *
+ * Call stacks are not stored in profile data. They are reconstructed
+ * top-down from functions not fully called from others, splitting the
+ * cost of a function among its self cost and its calls in proportion
+ * to their costs. Calls with a cost below a fraction of the total are
+ * not expanded, as well as recursive calls: their cost is added to the
+ * self cost of the caller.
+ */
+class FoldedWriter
+{
+public:
+    FoldedWriter(TraceData* data, EventType* eventType);
+
+    // calls below this fraction of total cost are not expanded
+    void setMinimumFraction(double fraction) { _minFraction = fraction; }
+
+    // frames are written as "<object>`<function>" if set (default)
+    void setWithObjects(bool withObjects) { _withObjects = withObjects; }
+
+    // returns false on write error
+    bool write(QIODevice* device);
+
+    int lines() const { return _lines; }
+
+private:
+    double outCost(TraceFunction* f);
+    const QByteArray& frameName(TraceFunction* f);
+    void writeStack(TraceFunction* f, double flow, int depth);
+    void writeLine(double cost);
+
+    TraceData* _data;
+    EventType* _eventType;
+    double _minFraction, _minFlow;
+    bool _withObjects;
+
+    QHash<TraceFunction*, double> _outCost;
+    QHash<TraceFunction*, QByteArray> _frameNames;
+    QSet<TraceFunction*> _onPath;
+    QByteArray _path, _buffer;
+    QIODevice* _device;
+    bool _error;
+    int _lines;
+};
+
+#endif // FOLDEDWRITER_H
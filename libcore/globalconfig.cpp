@@ -33,6 +33,7 @@
 #define DEFAULT_SHOWEXPANDED     false
 #define DEFAULT_SHOWCYCLES       true
 #define DEFAULT_HIDETEMPLATES    false
+#define DEFAULT_WRITECACHE       true
 #define DEFAULT_CYCLECUT         0.0
 #define DEFAULT_PERCENTPRECISION 2
 #define DEFAULT_MAXSYMBOLLENGTH  30
@@ -127,6 +128,7 @@ GlobalConfig::GlobalConfig()
     _cycleCut         = DEFAULT_CYCLECUT;
     _percentPrecision = DEFAULT_PERCENTPRECISION;
     _hideTemplates    = DEFAULT_HIDETEMPLATES;
+    _writeCache       = DEFAULT_WRITECACHE;
 
     // max symbol count/length in tooltip/popup
     _maxSymbolLength  = DEFAULT_MAXSYMBOLLENGTH;
@@ -193,6 +195,8 @@ void GlobalConfig::saveOptions()
                             DEFAULT_NOCOSTINSIDE);
     generalConfig->setValue(QStringLiteral("HideTemplates"), _hideTemplates,
                             DEFAULT_HIDETEMPLATES);
+    generalConfig->setValue(QStringLiteral("WriteCache"), _writeCache,
+                            DEFAULT_WRITECACHE);
     delete generalConfig;
 
     // store known event types
@@ -264,6 +268,8 @@ void GlobalConfig::readOptions()
                                              DEFAULT_NOCOSTINSIDE).toInt();
     _hideTemplates    = generalConfig->value(QStringLiteral("HideTemplates"),
                                              DEFAULT_HIDETEMPLATES).toBool();
+    _writeCache       = generalConfig->value(QStringLiteral("WriteCache"),
+                                             DEFAULT_WRITECACHE).toBool();
     delete generalConfig;
 
     // event types
@@ -311,11 +317,9 @@ void GlobalConfig::addDefaultTypes()
 QStringList GlobalConfig::sourceDirs(TraceData* data, TraceObject* o)
 {
     QStringList l = config()->_generalSourceDirs, ol, ol2;
-    TraceObjectMap::Iterator oit;
-    for ( oit = data->objectMap().begin();
-          oit != data->objectMap().end(); ++oit ) {
-        ol = config()->_objectSourceDirs[(*oit).name()];
-        if (&(*oit) == o) {
+    foreach(TraceObject* obj, data->objectMap().sortedByName()) {
+        ol = config()->_objectSourceDirs[obj->name()];
+        if (obj == o) {
             ol2 = ol;
             continue;
         }
@@ -383,6 +387,19 @@ void GlobalConfig::setHideTemplates(bool s)
     c->_hideTemplates = s;
 }
 
+bool GlobalConfig::writeCache()
+{
+    return config()->_writeCache;
+}
+
+void GlobalConfig::setWriteCache(bool w)
+{
+    GlobalConfig* c = config();
+    if (c->_writeCache == w) return;
+
+    c->_writeCache = w;
+}
+
 double GlobalConfig::cycleCut()
 {
     return config()->_cycleCut;
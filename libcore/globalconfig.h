@@ -87,6 +87,10 @@ public:
     static void setShowCycles(bool);
 
     static void setHideTemplates(bool);
+
+    // write cache files for large profile data, see TraceCache
+    static bool writeCache();
+    static void setWriteCache(bool);
     // upper limit for cutting of a call in cycle detection
     static double cycleCut();
 
@@ -101,6 +105,7 @@ protected:
     QHash<QString, QStringList> _objectSourceDirs;
 
     bool _showPercentage, _showExpanded, _showCycles, _hideTemplates;
+    bool _writeCache;
     double _cycleCut;
     int _percentPrecision;
     int _maxSymbolLength, _maxSymbolCount, _maxListCount;
@@ -4,34 +4,74 @@ DEPENDPATH += $$PWD
 NHEADERS += \
     $$PWD/context.h \
     $$PWD/costitem.h \
+    $$PWD/costkernels.h \
+    $$PWD/decompressdevice.h \
     $$PWD/subcost.h \
     $$PWD/eventtype.h \
     $$PWD/addr.h \
     $$PWD/config.h \
     $$PWD/globalconfig.h \
+    $$PWD/symboltable.h \
     $$PWD/tracedata.h \
+    $$PWD/tracecache.h \
     $$PWD/utils.h \
     $$PWD/logger.h \
+    $$PWD/parallel.h \
     $$PWD/loader.h \
     $$PWD/fixcost.h \
     $$PWD/pool.h \
+    $$PWD/stacksamples.h \
+    $$PWD/foldedwriter.h \
+    $$PWD/callgrindwriter.h \
+    $$PWD/reportwriter.h \
+    $$PWD/profilediff.h \
+    $$PWD/profilegenerator.h \
     $$PWD/coverage.h \
     $$PWD/stackbrowser.h
 
 SOURCES += \
     $$PWD/context.cpp \
     $$PWD/costitem.cpp \
+    $$PWD/costkernels.cpp \
+    $$PWD/decompressdevice.cpp \
     $$PWD/subcost.cpp \
     $$PWD/eventtype.cpp \
     $$PWD/addr.cpp \
     $$PWD/cachegrindloader.cpp \
+    $$PWD/callgrindwriter.cpp \
     $$PWD/config.cpp \
     $$PWD/coverage.cpp \
     $$PWD/fixcost.cpp \
+    $$PWD/foldedloader.cpp \
+    $$PWD/foldedwriter.cpp \
     $$PWD/globalconfig.cpp \
     $$PWD/loader.cpp \
     $$PWD/logger.cpp \
+    $$PWD/parallel.cpp \
+    $$PWD/perfloader.cpp \
+    $$PWD/pprofloader.cpp \
     $$PWD/pool.cpp \
+    $$PWD/profilediff.cpp \
+    $$PWD/profilegenerator.cpp \
+    $$PWD/reportwriter.cpp \
     $$PWD/stackbrowser.cpp \
+    $$PWD/stacksamples.cpp \
+    $$PWD/symboltable.cpp \
+    $$PWD/tracecache.cpp \
     $$PWD/tracedata.cpp \
     $$PWD/utils.cpp
+
+# optional libraries for loading compressed profile data
+CONFIG += link_pkgconfig
+packagesExist(zlib) {
+    DEFINES += HAVE_ZLIB
+    PKGCONFIG += zlib
+}
+packagesExist(liblzma) {
+    DEFINES += HAVE_LZMA
+    PKGCONFIG += liblzma
+}
+packagesExist(libzstd) {
+    DEFINES += HAVE_ZSTD
+    PKGCONFIG += libzstd
+}
@@ -69,10 +69,16 @@ Loader* Loader::loader(const QString& name)
 
 // factories of available loaders
 Loader* createCachegrindLoader();
+Loader* createPerfLoader();
+Loader* createFoldedLoader();
+Loader* createPProfLoader();
 
 void Loader::initLoaders()
 {
     _loaderList.append(createCachegrindLoader());
+    _loaderList.append(createPerfLoader());
+    _loaderList.append(createFoldedLoader());
+    _loaderList.append(createPProfLoader());
     //_loaderList.append(GProfLoader::createLoader());
 }
 
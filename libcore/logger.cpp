@@ -25,6 +25,23 @@
 #include <QtDebug>
 
 
+/// LoadStats
+
+LoadStats::LoadStats()
+{
+    bytes = lines = 0;
+    parts = functions = calls = 0;
+    poolObjects = poolBytes = poolChunks = 0;
+    peakRSS = 0;
+}
+
+void LoadStats::add(const LoadStats& s)
+{
+    bytes += s.bytes;
+    lines += s.lines;
+}
+
+
 /// Logger
 
 Logger::~Logger()
@@ -67,3 +84,70 @@ void Logger::loadFinished(const QString& msg)
     else
         qDebug() << "Error loading file" << _filename << ":" << qPrintable(msg);
 }
+
+void Logger::loadStats(const LoadStats&)
+{}
+
+void Logger::updateProgress(const QString&, int)
+{}
+
+
+/// LogBuffer
+
+LogBuffer::LogBuffer()
+    : _progress(0)
+{}
+
+LogBuffer::~LogBuffer()
+{}
+
+void LogBuffer::loadStart(const QString& filename)
+{
+    _filename = filename;
+    _progress.storeRelease(0);
+    _messages.append({ Start, 0, filename });
+}
+
+void LogBuffer::loadProgress(int progress)
+{
+    _progress.storeRelease(progress);
+}
+
+void LogBuffer::loadWarning(int line, const QString& msg)
+{
+    _messages.append({ Warning, line, msg });
+}
+
+void LogBuffer::loadError(int line, const QString& msg)
+{
+    _messages.append({ Error, line, msg });
+}
+
+void LogBuffer::loadFinished(const QString& msg)
+{
+    _progress.storeRelease(100);
+    _messages.append({ Finished, 0, msg });
+}
+
+void LogBuffer::loadStats(const LoadStats& stats)
+{
+    _stats.append(stats);
+}
+
+void LogBuffer::forward(Logger* l)
+{
+    if (l) {
+        foreach(const Message& m, _messages) {
+            switch(m.type) {
+            case Start:    l->loadStart(m.msg); break;
+            case Warning:  l->loadWarning(m.line, m.msg); break;
+            case Error:    l->loadError(m.line, m.msg); break;
+            case Finished: l->loadFinished(m.msg); break;
+            }
+        }
+        foreach(const LoadStats& s, _stats)
+            l->loadStats(s);
+    }
+    _messages.clear();
+    _stats.clear();
+}
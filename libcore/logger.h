@@ -28,6 +28,34 @@
 
 #include <qstring.h>
 #include <qtimer.h>
+#include <qlist.h>
+#include <qatomic.h>
+#include <qpair.h>
+
+/**
+ * Statistics of loading profile data into a TraceData,
+ * to find out where time and memory goes.
+ */
+struct LoadStats
+{
+    LoadStats();
+
+    // add counts of a load into a separate TraceData merged into ours
+    void add(const LoadStats& s);
+
+    QString name;
+    // wall time of load phases in ms, in order
+    QList<QPair<QString, double> > phases;
+    // input size (compressed size for compressed files), and lines
+    // for text formats
+    qint64 bytes, lines;
+    // cost items existing after the load
+    int parts, functions, calls;
+    // objects in fix memory pool (FixCost, FixCallCost, FixJump)
+    qint64 poolObjects, poolBytes, poolChunks;
+    // peak resident set size of the process in bytes, 0 if unknown
+    qint64 peakRSS;
+};
 
 class Logger
 {
@@ -40,6 +68,12 @@ public:
     virtual void loadWarning(int line, const QString& msg);
     virtual void loadError(int line, const QString& msg);
     virtual void loadFinished(const QString& msg); // msg could be error
+    // after a load, including updates; default does nothing
+    virtual void loadStats(const LoadStats& stats);
+
+    // Progress of updates of loaded data, e.g. cycle detection, which
+    // also happen after loading; 100 when done. Default does nothing.
+    virtual void updateProgress(const QString& what, int progress);
 
 protected:
     QString _filename;
@@ -48,6 +82,44 @@ private:
     QTimer _timer;
 };
 
+/**
+ * Logger storing notifications instead of presenting them.
+ *
+ * Used for loading in worker threads: the messages are forwarded
+ * to the real logger later from the main thread. The progress of the
+ * last loadProgress() call can be queried from any thread.
+ */
+class LogBuffer: public Logger
+{
+public:
+    LogBuffer();
+    ~LogBuffer() override;
+
+    void loadStart(const QString& filename) override;
+    void loadProgress(int progress) override;
+    void loadWarning(int line, const QString& msg) override;
+    void loadError(int line, const QString& msg) override;
+    void loadFinished(const QString& msg) override;
+    void loadStats(const LoadStats& stats) override;
+
+    int progress() const { return _progress.loadAcquire(); }
+
+    // replay all stored notifications (without progress) to <l>
+    void forward(Logger* l);
+
+private:
+    enum MessageType { Start, Warning, Error, Finished };
+    struct Message {
+        MessageType type;
+        int line;
+        QString msg;
+    };
+
+    QList<Message> _messages;
+    QList<LoadStats> _stats;
+    QAtomicInt _progress;
+};
+
 #endif // LOGGER_H
 
 
@@ -0,0 +1,101 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Helpers for running independent jobs in worker threads
+ */
+
+#include "parallel.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+
+// QRunnable::create() needs Qt 5.15
+class FunctionRunnable: public QRunnable
+{
+public:
+    explicit FunctionRunnable(const std::function<void()>& f)
+        : _f(f) {}
+    void run() override { _f(); }
+
+private:
+    std::function<void()> _f;
+};
+
+
+//
+// ParallelJobs
+//
+
+ParallelJobs::ParallelJobs(int maxThreads)
+{
+    _pool = new QThreadPool;
+    _pool->setMaxThreadCount((maxThreads > 0) ? maxThreads : idealThreadCount());
+}
+
+ParallelJobs::~ParallelJobs()
+{
+    _pool->waitForDone();
+    delete _pool;
+}
+
+int ParallelJobs::maxThreads() const
+{
+    return _pool->maxThreadCount();
+}
+
+void ParallelJobs::add(const std::function<void()>& job)
+{
+    _pool->start(new FunctionRunnable(job));
+}
+
+void ParallelJobs::wait(const std::function<void()>& poll, int interval)
+{
+    while(!_pool->waitForDone(interval))
+        if (poll) poll();
+
+    if (poll) poll();
+}
+
+int ParallelJobs::idealThreadCount()
+{
+    int count = QThread::idealThreadCount();
+    return (count > 0) ? count : 1;
+}
+
+void ParallelJobs::forRanges(int count, int minSize,
+                             const std::function<void(int, int)>& job)
+{
+    int ranges = idealThreadCount();
+    if (minSize > 0 && count / minSize < ranges)
+        ranges = count / minSize;
+    if (ranges <= 1) {
+        if (count > 0) job(0, count);
+        return;
+    }
+
+    ParallelJobs jobs(ranges);
+    for(int r = 0; r < ranges; r++) {
+        int begin = (int)((qint64) count * r / ranges);
+        int end = (int)((qint64) count * (r+1) / ranges);
+        jobs.add([=]() { job(begin, end); });
+    }
+    jobs.wait();
+}
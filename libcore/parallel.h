@@ -0,0 +1,69 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Helpers for running independent jobs in worker threads
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+class QThreadPool;
+
+/**
+ * A set of jobs run on a private thread pool.
+ *
+ * Jobs must not use objects shared with other jobs without locking.
+ * Notifications to the user (e.g. via a Logger) have to be done
+ * from the thread calling wait(), using the <poll> callback.
+ */
+class ParallelJobs
+{
+public:
+    /* maxThreads = 0: use one thread per core */
+    explicit ParallelJobs(int maxThreads = 0);
+    ~ParallelJobs(); // waits for running jobs
+
+    int maxThreads() const;
+    void add(const std::function<void()>& job);
+
+    /**
+     * Wait for all jobs to finish. Meanwhile, <poll> is called every
+     * <interval> milliseconds, and once at the end.
+     */
+    void wait(const std::function<void()>& poll = nullptr,
+              int interval = 100);
+
+    // number of threads available for parallel work
+    static int idealThreadCount();
+
+    /**
+     * Run <job>(begin, end) on disjoint ranges covering [0, count[,
+     * in parallel if there are at least <minSize> indexes per thread.
+     * Returns after all ranges are done.
+     */
+    static void forRanges(int count, int minSize,
+                          const std::function<void(int, int)>& job);
+
+private:
+    QThreadPool* _pool;
+};
+
+#endif // PARALLEL_H
@@ -0,0 +1,498 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Loader for the text output of "perf script" (Linux perf)
+ */
+
+#include "loader.h"
+
+#include <string.h>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QVector>
+
+#include "addr.h"
+#include "tracedata.h"
+#include "utils.h"
+#include "stacksamples.h"
+
+// files are only split for parallel parsing into chunks at least this large
+#define MIN_CHUNK_SIZE (32*1024*1024)
+
+// maximal number of tokens in a sample header line before the event
+#define MAX_HEADER_TOKENS 32
+
+/*
+ * "perf script" prints samples recorded by "perf record [-g]" as
+ *
+ *   <comm> [<pid>/]<tid> [[<cpu>]] <time>: [<period>] <event>: [<ip> <sym>]
+ *           <ip> <sym>+<offset> (<dso>)
+ *           ...
+ *
+ * with the call stack starting at the innermost frame, and an empty
+ * line after each sample. Samples are summed up per thread into
+ * StackSamples, using the sampling period as cost of the event
+ * (1 if not printed). Other lines (e.g. source lines with -F +srcline)
+ * are skipped.
+ */
+
+struct PerfToken {
+    const char* s;
+    int len;
+};
+
+static inline bool isBlank(char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// "<digits>.<digits>:"
+static bool isTime(const PerfToken& t)
+{
+    int i = 0, dots = 0;
+    if ((t.len < 3) || (t.s[t.len-1] != ':')) return false;
+    for(; i < t.len-1; i++) {
+        if (t.s[i] == '.') dots++;
+        else if (t.s[i] < '0' || t.s[i] > '9') return false;
+    }
+    return dots == 1;
+}
+
+// "<digits>" or "<digits>/<digits>": returns last number
+static bool parseNumber(const PerfToken& t, uint64& v)
+{
+    if (t.len == 0) return false;
+    v = 0;
+    for(int i = 0; i < t.len; i++) {
+        if (t.s[i] == '/') { v = 0; continue; }
+        if (t.s[i] < '0' || t.s[i] > '9') return false;
+        v = 10*v + (t.s[i] - '0');
+    }
+    return true;
+}
+
+/*
+ * Parser for (a chunk of) perf script output into StackSamples.
+ * Multiple parsers can run in parallel on separate StackSamples.
+ */
+class PerfParser
+{
+public:
+    explicit PerfParser(StackSamples* samples);
+
+    // <progress> is called with percentage of <file> parsed
+    void parse(FixFile& file, const std::function<void(int)>& progress);
+
+    int invalidLines() const { return _invalidLines; }
+    int firstInvalidLine() const { return _firstInvalidLine; }
+
+private:
+    bool parseHeader(const char* s, const char* end);
+    int frameIndex(const char* s, const char* end);
+    int eventIndex(const char* s, int len);
+    void finishSample();
+
+    StackSamples* _samples;
+
+    // raw frame text, and index in _samples per ID of raw text
+    NameTable _raw;
+    QVector<int> _frames;
+    // raw event name to index in _samples
+    QHash<QByteArray, int> _events;
+    // thread ID to part
+    QHash<uint64, int> _parts;
+
+    // current sample
+    bool _inSample;
+    int _part, _event;
+    SubCost _period;
+    // innermost first, and reversed
+    QVector<int> _stack, _reversed;
+
+    int _lineNo, _invalidLines, _firstInvalidLine;
+};
+
+PerfParser::PerfParser(StackSamples* samples)
+{
+    _samples = samples;
+    _inSample = false;
+    _part = -1;
+    _event = -1;
+    _lineNo = 0;
+    _invalidLines = 0;
+    _firstInvalidLine = 0;
+}
+
+void PerfParser::parse(FixFile& file, const std::function<void(int)>& progress)
+{
+    FixString line;
+    int statusProgress = 0;
+
+    while (file.nextLine(line)) {
+        _lineNo++;
+
+        if ((_lineNo % 10000) == 0) {
+            int p = file.progress();
+            if (p != statusProgress) {
+                statusProgress = p;
+                progress(p);
+            }
+        }
+
+        const char* s = line.ascii();
+        const char* end = s + line.len();
+        while((end > s) && isBlank(end[-1])) end--;
+
+        if (s == end) {
+            finishSample();
+            continue;
+        }
+
+        if (isBlank(*s)) {
+            // a frame of the current call stack?
+            while(isBlank(*s)) s++;
+            if (!_inSample || (hexValue(*s) < 0)) continue;
+            const char* p = s;
+            while((p < end) && (hexValue(*p) >= 0)) p++;
+            if ((p < end) && !isBlank(*p)) continue;
+
+            _stack.append(frameIndex(s, end));
+            continue;
+        }
+
+        if (*s == '#') continue;
+
+        finishSample();
+        if (!parseHeader(s, end)) {
+            if (_invalidLines == 0) _firstInvalidLine = _lineNo;
+            _invalidLines++;
+        }
+    }
+    finishSample();
+}
+
+bool PerfParser::parseHeader(const char* s, const char* end)
+{
+    PerfToken tokens[MAX_HEADER_TOKENS];
+    int count = 0, timeIndex = -1, event = -1;
+
+    const char* p = s;
+    while((p < end) && (count < MAX_HEADER_TOKENS)) {
+        while((p < end) && isBlank(*p)) p++;
+        if (p == end) break;
+        PerfToken& t = tokens[count];
+        t.s = p;
+        while((p < end) && !isBlank(*p)) p++;
+        t.len = p - t.s;
+
+        // the command (first token) may look like anything
+        if ((timeIndex < 0) && (count > 0) && isTime(t))
+            timeIndex = count;
+        count++;
+    }
+
+    // the event follows the time, if there is a time
+    uint64 v;
+    for(int i = (timeIndex < 0) ? 1 : timeIndex + 1; i < count; i++) {
+        const PerfToken& t = tokens[i];
+        if ((t.s[t.len-1] == ':') && !parseNumber(t, v)) {
+            event = i;
+            break;
+        }
+    }
+    if (event < 0) return false;
+    p = tokens[event].s + tokens[event].len;
+
+    // numbers before the event: [<tid> [<cpu>] [<time>:]] [<period>]
+    uint64 period = 1, tid = 0;
+    int i = event - 1;
+    if ((i > timeIndex) && (i > 1) && parseNumber(tokens[i], period))
+        i--;
+    else
+        period = 1;
+    if (timeIndex >= 0) i = timeIndex - 1;
+    if ((i > 0) && (tokens[i].s[0] == '['))
+        i--;
+    if ((i <= 0) || !parseNumber(tokens[i], tid))
+        tid = 0;
+
+    _event = eventIndex(tokens[event].s, tokens[event].len - 1);
+    _period = period;
+
+    QHash<uint64, int>::const_iterator it = _parts.constFind(tid);
+    if (it != _parts.constEnd())
+        _part = it.value();
+    else {
+        _part = _samples->part(tid, (int) tid);
+        _parts.insert(tid, _part);
+    }
+    _inSample = true;
+
+    // without call stack, the sampled instruction is given here
+    while((p < end) && isBlank(*p)) p++;
+    if ((p < end) && (hexValue(*p) >= 0))
+        _stack.append(frameIndex(p, end));
+
+    return true;
+}
+
+/* Event name, without modifiers (e.g. "cycles" for "cycles:u").
+ * Tracepoint names contain ':' themselves, so modifiers are only
+ * stripped if consisting of modifier characters.
+ */
+int PerfParser::eventIndex(const char* s, int len)
+{
+    QByteArray raw = QByteArray::fromRawData(s, len);
+    QHash<QByteArray, int>::const_iterator it = _events.constFind(raw);
+    if (it != _events.constEnd()) return it.value();
+
+    int nameLen = len;
+    int colon = raw.lastIndexOf(':');
+    if (colon > 0) {
+        int i = colon + 1;
+        while((i < len) && strchr("ukhIGHpPSDWe", s[i])) i++;
+        if (i == len) nameLen = colon;
+    }
+
+    int index = _samples->event(QString::fromLatin1(s, nameLen));
+    _events.insert(QByteArray(s, len), index);
+    return index;
+}
+
+// "<ip> <sym>[+<offset>] (<dso>)"
+int PerfParser::frameIndex(const char* s, const char* end)
+{
+    int raw = _raw.intern(s, end - s);
+    if (raw < _frames.count()) return _frames.at(raw);
+
+    NameTable& names = _samples->names();
+    const char* p = s;
+    uint64 ip = 0;
+    while((p < end) && (hexValue(*p) >= 0)) {
+        ip = 16*ip + hexValue(*p);
+        p++;
+    }
+    while((p < end) && isBlank(*p)) p++;
+
+    // shared object in parentheses at end
+    const char* symEnd = end;
+    const char* object = end;
+    int objectLen = 0;
+    if ((end - p > 1) && (end[-1] == ')')) {
+        const char* q = end - 2;
+        while((q > p) && !((*q == '(') && isBlank(q[-1]))) q--;
+        if (*q == '(') {
+            object = q + 1;
+            objectLen = end - q - 2;
+            symEnd = q;
+        }
+    }
+    while((symEnd > p) && isBlank(symEnd[-1])) symEnd--;
+
+    // offset into symbol
+    const char* q = symEnd;
+    while((q > p) && (hexValue(q[-1]) >= 0)) q--;
+    if ((q < symEnd) && (q - p > 3) && (q[-1] == 'x') &&
+        (q[-2] == '0') && (q[-3] == '+'))
+        symEnd = q - 3;
+
+    int function = (symEnd > p) ? names.intern(p, symEnd - p)
+                                : names.intern(QStringLiteral("[unknown]"));
+
+    int index = _samples->frame(function, names.intern(object, objectLen),
+                                names.intern(QString()), 0, Addr(ip));
+    _frames.append(index);
+    return index;
+}
+
+void PerfParser::finishSample()
+{
+    if (_inSample && !_stack.isEmpty()) {
+        int count = _stack.count();
+        _reversed.resize(count);
+        for(int i = 0; i < count; i++)
+            _reversed[i] = _stack.at(count - 1 - i);
+        _samples->add(_part, _reversed.constData(), count, _event, _period);
+    }
+    _inSample = false;
+    _stack.resize(0);
+}
+
+
+/*
+ * Loader for perf script output
+ */
+
+class PerfLoader: public Loader
+{
+public:
+    PerfLoader();
+
+    bool canLoad(QIODevice* file) override;
+    int  load(TraceData*, QIODevice* file, const QString& filename) override;
+
+private:
+    int loadInternal(TraceData*, QIODevice* file, const QString& filename);
+    void reportInvalid(int invalidLines, int firstInvalidLine);
+};
+
+PerfLoader::PerfLoader()
+    : Loader(QStringLiteral("Perf"),
+             QObject::tr( "Import filter for 'perf script' output of Linux perf") )
+{}
+
+bool PerfLoader::canLoad(QIODevice* file)
+{
+    if (!file) return false;
+
+    Q_ASSERT(file->isOpen());
+
+    /*
+     * We recognize output of perf script if the first line which is
+     * no comment has a time stamp "<digits>.<digits>:" followed by an
+     * event, and the next line is empty or a call stack frame.
+     */
+    // peek: sequential devices cannot seek back for loading
+    char buf[4096];
+    int read = file->peek(buf, 4095);
+    if (read <= 0)
+        return false;
+    buf[read] = 0;
+
+    char* s = buf;
+    while(*s == '#') {
+        s = strchr(s, '\n');
+        if (!s) return false;
+        s++;
+    }
+    char* next = strchr(s, '\n');
+    if (!next) return false;
+
+    bool hasTime = false, hasEvent = false;
+    char* p = s;
+    while(p < next) {
+        while((p < next) && isBlank(*p)) p++;
+        PerfToken t;
+        t.s = p;
+        while((p < next) && !isBlank(*p) && (*p != '\r')) p++;
+        t.len = p - t.s;
+        if (t.len == 0) break;
+        if (hasTime) {
+            if (t.s[t.len-1] == ':') hasEvent = true;
+            break;
+        }
+        // the time must not be the first token (the command)
+        if ((t.s != s) && isTime(t)) hasTime = true;
+    }
+    // period before event?
+    if (hasTime && !hasEvent) {
+        while((p < next) && isBlank(*p)) p++;
+        while((p < next) && !isBlank(*p)) p++;
+        hasEvent = (p > s) && (p[-1] == ':');
+    }
+    if (!hasEvent) return false;
+
+    p = next + 1;
+    if ((*p == '\n') || (*p == '\r') || (*p == 0)) return true;
+    if (!isBlank(*p)) return false;
+    while(isBlank(*p)) p++;
+    return hexValue(*p) >= 0;
+}
+
+int PerfLoader::load(TraceData* d,
+                     QIODevice* file, const QString& filename)
+{
+    /* do the loading in a new object so parallel load
+     * operations do not interfere each other.
+     */
+    PerfLoader l;
+
+    l.setLogger(d->logger());
+
+    return l.loadInternal(d, file, filename);
+}
+
+Loader* createPerfLoader()
+{
+    return new PerfLoader();
+}
+
+// line number 0 if unknown
+void PerfLoader::reportInvalid(int invalidLines, int firstInvalidLine)
+{
+    if (invalidLines == 0) return;
+
+    loadWarning(firstInvalidLine,
+                QObject::tr("Skipped %n unknown line(s)", nullptr,
+                            invalidLines));
+}
+
+int PerfLoader::loadInternal(TraceData* data,
+                             QIODevice* device, const QString& filename)
+{
+    if (!data || !device) return 0;
+
+    loadStart(filename);
+
+    FixFile file(device, filename);
+    if (!file.exists()) {
+        loadFinished(QStringLiteral("File does not exist"));
+        return 0;
+    }
+
+    /* Large files are split at empty lines into chunks, parsed by
+     * worker threads. Line numbers are only known for the first chunk.
+     */
+    StackSamples samples;
+    QAtomicInt invalidLines, firstInvalidLine;
+    auto parseChunk = [&](int chunk, FixFile& f, StackSamples& s,
+                          const std::function<void(int)>& progress) {
+        PerfParser parser(&s);
+        parser.parse(f, progress);
+        invalidLines.fetchAndAddRelaxed(parser.invalidLines());
+        if (chunk == 0)
+            firstInvalidLine.storeRelease(parser.firstInvalidLine());
+    };
+    auto progress = [this](int p) { loadProgress(p); };
+    if (!StackSamples::parseInChunks(file, "\n\n", MIN_CHUNK_SIZE, samples,
+                                     parseChunk, progress))
+        parseChunk(0, file, samples, progress);
+    reportInvalid(invalidLines.loadAcquire(), firstInvalidLine.loadAcquire());
+
+    int partsAdded = samples.addTo(data, filename);
+    if (partsAdded == 0)
+        loadFinished(QStringLiteral("No samples found"));
+    else
+        loadFinished();
+
+    device->close();
+
+    return partsAdded;
+}
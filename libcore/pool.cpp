@@ -29,7 +29,7 @@
 struct SpaceChunk
 {
     struct SpaceChunk* next;
-    unsigned int used;
+    size_t used;
     char space[1];
 };
 
@@ -39,6 +39,7 @@ FixPool::FixPool()
     _reservation = 0;
     _count = 0;
     _size = 0;
+    _chunks = 0;
 }
 
 FixPool::~FixPool()
@@ -51,11 +52,11 @@ FixPool::~FixPool()
         chunk = next;
     }
 
-    if (0) qDebug("~FixPool: Had %d objects with total size %d\n",
+    if (0) qDebug("~FixPool: Had %zu objects with total size %zu\n",
                   _count, _size);
 }
 
-void* FixPool::allocate(unsigned int size)
+void* FixPool::allocate(size_t size)
 {
     if (!ensureSpace(size)) return nullptr;
 
@@ -69,7 +70,7 @@ void* FixPool::allocate(unsigned int size)
     return result;
 }
 
-void* FixPool::reserve(unsigned int size)
+void* FixPool::reserve(size_t size)
 {
     if (!ensureSpace(size)) return nullptr;
     _reservation = size;
@@ -78,7 +79,7 @@ void* FixPool::reserve(unsigned int size)
 }
 
 
-bool FixPool::allocateReserved(unsigned int size)
+bool FixPool::allocateReserved(size_t size)
 {
     if (_reservation < size) return false;
 
@@ -91,7 +92,7 @@ bool FixPool::allocateReserved(unsigned int size)
     return true;
 }
 
-bool FixPool::ensureSpace(unsigned int size)
+bool FixPool::ensureSpace(size_t size)
 {
     if (_last && _last->used + size <= CHUNK_SIZE) return true;
 
@@ -110,6 +111,7 @@ bool FixPool::ensureSpace(unsigned int size)
     }
     newChunk->next = nullptr;
     newChunk->used = 0;
+    _chunks++;
 
     if (!_last) {
         _last = _first = newChunk;
@@ -124,6 +126,9 @@ bool FixPool::ensureSpace(unsigned int size)
 
 // DynPool
 
+// objects are prefixed by 2 pointers: forward chain and pointer to ptr
+#define DYN_HEADER (2 * sizeof(char*))
+
 DynPool::DynPool()
 {
     _data = (char*) malloc(CHUNK_SIZE);
@@ -131,7 +136,7 @@ DynPool::DynPool()
     _size = CHUNK_SIZE;
 
     // end marker
-    *(int*)_data = 0;
+    *(char**)_data = nullptr;
 }
 
 DynPool::~DynPool()
@@ -141,25 +146,25 @@ DynPool::~DynPool()
     ::free(_data);
 }
 
-bool DynPool::allocate(char** ptr, unsigned int size)
+bool DynPool::allocate(char** ptr, size_t size)
 {
-    // round up to multiple of 4
-    size = (size+3) & ~3;
+    // round up to multiple of pointer size
+    size = (size + sizeof(char*)-1) & ~(sizeof(char*)-1);
 
-    /* need 12 bytes more:
-     * - 4 bytes for forward chain
-     * - 4 bytes for pointer to ptr
-     * - 4 bytes as end marker (not used for new object)
+    /* need 3 pointers more:
+     * - forward chain
+     * - pointer to ptr
+     * - end marker (not used for new object)
      */
-    if (!ensureSpace(size + 12)) return false;
+    if (!ensureSpace(size + DYN_HEADER + sizeof(char*))) return false;
 
     char** obj = (char**) (_data+_used);
-    obj[0] = (char*)(_data + _used + size + 8);
+    obj[0] = (char*)(_data + _used + size + DYN_HEADER);
     obj[1] = (char*)ptr;
-    *(int*)(_data+_used+size+8) = 0;
-    *ptr = _data+_used+8;
+    *(char**)(_data+_used+size+DYN_HEADER) = nullptr;
+    *ptr = _data+_used+DYN_HEADER;
 
-    _used += size + 8;
+    _used += size + DYN_HEADER;
 
     return true;
 }
@@ -168,24 +173,26 @@ void DynPool::free(char** ptr)
 {
     if (!ptr ||
         !*ptr ||
-        (*(char**)(*ptr - 4)) != (char*)ptr )
+        (*(char**)(*ptr - sizeof(char*))) != (char*)ptr )
         qFatal("Chaining error in DynPool::free");
 
-    (*(char**)(*ptr - 4)) = nullptr;
+    (*(char**)(*ptr - sizeof(char*))) = nullptr;
     *ptr = nullptr;
 }
 
-bool DynPool::ensureSpace(unsigned int size)
+bool DynPool::ensureSpace(size_t size)
 {
     if (_used + size <= _size) return true;
 
-    unsigned int newsize = _size *3/2 + CHUNK_SIZE;
+    size_t newsize = _size *3/2 + CHUNK_SIZE;
+    if (newsize < _used + size) newsize = _used + size + CHUNK_SIZE;
     char* newdata = (char*) malloc(newsize);
+    if (!newdata) return false;
 
-    unsigned int freed = 0, len;
+    size_t freed = 0, len;
     char **p, **pnext, **pnew;
 
-    qDebug("DynPool::ensureSpace size: %d => %d, used %d. %p => %p",
+    qDebug("DynPool::ensureSpace size: %zu => %zu, used %zu. %p => %p",
            _size, newsize, _used, _data, newdata);
 
     pnew = (char**) newdata;
@@ -194,7 +201,7 @@ bool DynPool::ensureSpace(unsigned int size)
         pnext = (char**) *p;
         len = (char*)pnext - (char*)p;
 
-        if (0) qDebug(" [%8p] Len %d (ptr %p), freed %d (=> %p)",
+        if (0) qDebug(" [%8p] Len %zu (ptr %p), freed %zu (=> %p)",
                       p, len, p[1], freed, pnew);
 
         /* skip freed space ? */
@@ -213,21 +220,21 @@ bool DynPool::ensureSpace(unsigned int size)
         // copy object
         pnew[0] = (char*)pnew + len;
         pnew[1] = p[1];
-        memcpy((char*)pnew + 8, (char*)p + 8, len-8);
+        memcpy((char*)pnew + DYN_HEADER, (char*)p + DYN_HEADER, len-DYN_HEADER);
 
         // update pointer to object
         char** ptr = (char**) p[1];
-        if (*ptr != ((char*)p)+8)
+        if (*ptr != ((char*)p)+DYN_HEADER)
             qFatal("Chaining error in DynPool::ensureSpace");
-        *ptr = ((char*)pnew)+8;
+        *ptr = ((char*)pnew)+DYN_HEADER;
 
         pnew = (char**) pnew[0];
         p = pnext;
     }
     pnew[0] = nullptr;
 
-    unsigned int newused = (char*)pnew - (char*)newdata;
-    qDebug("DynPool::ensureSpace size: %d => %d, used %d => %d (%d freed)",
+    size_t newused = (char*)pnew - (char*)newdata;
+    qDebug("DynPool::ensureSpace size: %zu => %zu, used %zu => %zu (%zu freed)",
            _size, newsize, _used, newused, freed);
 
     ::free(_data);
@@ -19,6 +19,8 @@
 #ifndef POOL_H
 #define POOL_H
 
+#include <stddef.h>
+
 /**
  * Pool objects: containers for many small objects.
  */
@@ -41,31 +43,37 @@ public:
      * Take @p size bytes from the pool
      * @param size is the number of bytes
      */
-    void* allocate(unsigned int size);
+    void* allocate(size_t size);
 
     /**
      * Reserve space. If you call allocateReservedSpace(realsize)
      * with realSize < reserved size directly after, you
      * will get the same memory area.
      */
-    void* reserve(unsigned int size);
+    void* reserve(size_t size);
 
     /**
      * Before calling this, you have to reserve at least @p size bytes
      * with reserveSpace().
      * @param size is the number of bytes
      */
-    bool allocateReserved(unsigned int size);
+    bool allocateReserved(size_t size);
+
+    // statistics
+    size_t objects() const { return _count; }
+    size_t bytes() const { return _size; }
+    size_t chunks() const { return _chunks; }
 
 private:
     /* Checks that there is enough space in the last chunk.
      * Returns false if this is not possible.
      */
-    bool ensureSpace(unsigned int);
+    bool ensureSpace(size_t);
 
     struct SpaceChunk *_first, *_last;
-    unsigned int _reservation;
-    int _count, _size;
+    size_t _reservation;
+    // statistics
+    size_t _count, _size, _chunks;
 };
 
 /**
@@ -89,7 +97,7 @@ public:
      * @param *ptr will be changed if the object is moved.
      * Returns false if no space available.
      */
-    bool allocate(char** ptr, unsigned int size);
+    bool allocate(char** ptr, size_t size);
 
     /**
      * To resize, first allocate new space, and free old
@@ -101,10 +109,10 @@ private:
     /* Checks that there is enough space. If not,
      * it compactifies, possibly moving objects.
      */
-    bool ensureSpace(unsigned int);
+    bool ensureSpace(size_t);
 
     char* _data;
-    unsigned int _used, _size;
+    size_t _used, _size;
 };
 
 #endif // POOL_H
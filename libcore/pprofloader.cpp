@@ -0,0 +1,511 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Loader for pprof profiles (profile.proto, as written by Go and gperftools)
+ */
+
+#include "loader.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QPair>
+#include <QVector>
+
+#include "addr.h"
+#include "eventtype.h"
+#include "tracedata.h"
+#include "utils.h"
+#include "stacksamples.h"
+
+// protobuf wire types
+#define WIRE_VARINT 0
+#define WIRE_FIXED64 1
+#define WIRE_LENGTH 2
+#define WIRE_FIXED32 5
+
+// field numbers of message Profile
+#define PROFILE_SAMPLE_TYPE 1
+#define PROFILE_SAMPLE 2
+#define PROFILE_MAPPING 3
+#define PROFILE_LOCATION 4
+#define PROFILE_FUNCTION 5
+#define PROFILE_STRING_TABLE 6
+#define PROFILE_MAX_FIELD 16
+
+/*
+ * A pprof profile is a protobuf message "Profile" (see profile.proto in
+ * github.com/google/pprof), usually gzip compressed (decompression is
+ * done by TraceData). A sample refers to its call stack by location IDs
+ * (innermost first), a location to a mapping (the binary) and to a list
+ * of lines (inlined functions, innermost first), and a line to a function.
+ * All strings are indexes into a string table.
+ *
+ * Messages are decoded directly from the buffer as they are needed,
+ * without building a message tree. The tables are read in a first pass,
+ * as they can come after the samples. Samples are summed up into
+ * StackSamples with one event per sample type.
+ */
+
+/*
+ * Reader for fields of a protobuf message in a buffer
+ */
+class ProtoReader
+{
+public:
+    ProtoReader(const char* data, uint64 len)
+    {
+        _p = (const uchar*) data;
+        _end = _p + len;
+        _start = _p;
+        _data = nullptr;
+        _field = 0;
+        _wireType = 0;
+        _value = 0;
+        _error = false;
+    }
+
+    // go to next field, returns false at end or on error
+    bool next()
+    {
+        if ((_p >= _end) || _error) return false;
+
+        uint64 tag;
+        if (!varint(tag)) return false;
+        _field = (int) (tag >> 3);
+        _wireType = (int) (tag & 7);
+
+        switch(_wireType) {
+        case WIRE_VARINT:
+            return varint(_value);
+        case WIRE_FIXED64:
+        case WIRE_FIXED32: {
+            int size = (_wireType == WIRE_FIXED64) ? 8 : 4;
+            if (_end - _p < size) return fail();
+            _value = 0;
+            for(int i = size-1; i >= 0; i--)
+                _value = (_value << 8) | _p[i];
+            _p += size;
+            return true;
+        }
+        case WIRE_LENGTH:
+            if (!varint(_value)) return false;
+            if ((uint64)(_end - _p) < _value) return fail();
+            _data = (const char*) _p;
+            _p += _value;
+            return true;
+        default:
+            break;
+        }
+        return fail();
+    }
+
+    int field() const { return _field; }
+    int wireType() const { return _wireType; }
+    // value of varint/fixed field, or length of length-delimited field
+    uint64 value() const { return _value; }
+    // content of length-delimited field
+    const char* data() const { return _data; }
+    ProtoReader message() const { return ProtoReader(_data, _value); }
+    QString string() const { return QString::fromUtf8(_data, (int) _value); }
+
+    bool error() const { return _error; }
+    uint64 offset() const { return _p - _start; }
+
+    /* Values of a repeated integer field, which can be packed into
+     * a length-delimited field. Appends to <values>.
+     */
+    bool values(QVector<uint64>& values)
+    {
+        if (_wireType == WIRE_VARINT) {
+            values.append(_value);
+            return true;
+        }
+        if (_wireType != WIRE_LENGTH) return fail();
+
+        ProtoReader packed(_data, _value);
+        uint64 v;
+        while(packed._p < packed._end) {
+            if (!packed.varint(v)) return fail();
+            values.append(v);
+        }
+        return true;
+    }
+
+private:
+    bool fail() { _error = true; return false; }
+
+    bool varint(uint64& v)
+    {
+        v = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            if (_p >= _end) return fail();
+            uchar b = *_p++;
+            v |= (uint64)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return fail();
+    }
+
+    const uchar *_p, *_end, *_start;
+    const char* _data;
+    int _field, _wireType;
+    uint64 _value;
+    bool _error;
+};
+
+
+/*
+ * Loader for pprof profiles
+ */
+
+class PProfLoader: public Loader
+{
+public:
+    PProfLoader();
+
+    bool canLoad(QIODevice* file) override;
+    int  load(TraceData*, QIODevice* file, const QString& filename) override;
+
+private:
+    int loadInternal(TraceData*, QIODevice* file, const QString& filename);
+    bool readTables(const char* data, uint64 len);
+    bool readLocation(ProtoReader r);
+    bool readSamples(const char* data, uint64 len);
+    QString string(uint64 index) const;
+    // ID of string table entry in names of _samples
+    int nameId(uint64 index);
+
+    StackSamples _samples;
+    int _part;
+
+    // sample types as (type, unit) string indexes
+    QVector<QPair<uint64, uint64> > _sampleTypes;
+    // content of string table entries
+    QVector<QPair<const char*, int> > _strings;
+    // mapping ID to file name (string index)
+    QHash<uint64, uint64> _mappings;
+    // function ID to name and file name (string indexes)
+    QHash<uint64, QPair<uint64, uint64> > _functions;
+    // location messages, decoded after all tables are known
+    QVector<QPair<const char*, uint64> > _locationData;
+    // location ID to frames in _locationFrames (start, count)
+    QHash<uint64, QPair<int, int> > _locations;
+    QVector<int> _locationFrames;
+};
+
+PProfLoader::PProfLoader()
+    : Loader(QStringLiteral("PProf"),
+             QObject::tr( "Import filter for pprof profiles (profile.proto)") )
+{
+    _part = -1;
+}
+
+/*
+ * Check that a buffer starts with fields of message Profile, with
+ * a valid ValueType as first field. Only fields completely in the
+ * buffer are checked.
+ */
+static bool isProfile(const char* data, int len)
+{
+    ProtoReader r(data, len);
+    if (!r.next() || (r.field() != PROFILE_SAMPLE_TYPE) ||
+        (r.wireType() != WIRE_LENGTH))
+        return false;
+
+    ProtoReader valueType = r.message();
+    while(valueType.next()) {
+        if (((valueType.field() != 1) && (valueType.field() != 2)) ||
+            (valueType.wireType() != WIRE_VARINT))
+            return false;
+    }
+    if (valueType.error()) return false;
+
+    while(r.next())
+        if ((r.field() < 1) || (r.field() > PROFILE_MAX_FIELD))
+            return false;
+
+    // error expected for a field cut off at end of buffer
+    return true;
+}
+
+bool PProfLoader::canLoad(QIODevice* file)
+{
+    if (!file) return false;
+
+    Q_ASSERT(file->isOpen());
+
+    // peek: sequential devices cannot seek back for loading
+    char buf[4096];
+    int read = file->peek(buf, 4096);
+    if (read <= 0)
+        return false;
+
+    return isProfile(buf, read);
+}
+
+int PProfLoader::load(TraceData* d,
+                      QIODevice* file, const QString& filename)
+{
+    /* do the loading in a new object so parallel load
+     * operations do not interfere each other.
+     */
+    PProfLoader l;
+
+    l.setLogger(d->logger());
+
+    return l.loadInternal(d, file, filename);
+}
+
+Loader* createPProfLoader()
+{
+    return new PProfLoader();
+}
+
+QString PProfLoader::string(uint64 index) const
+{
+    if (index >= (uint64) _strings.count()) return QString();
+
+    const QPair<const char*, int>& s = _strings.at(index);
+    return QString::fromUtf8(s.first, s.second);
+}
+
+int PProfLoader::nameId(uint64 index)
+{
+    if (index >= (uint64) _strings.count())
+        return _samples.names().intern(QString());
+
+    const QPair<const char*, int>& s = _strings.at(index);
+    return _samples.names().intern(s.first, s.second);
+}
+
+bool PProfLoader::readTables(const char* data, uint64 len)
+{
+    ProtoReader r(data, len);
+    while(r.next()) {
+        switch(r.field()) {
+        case PROFILE_SAMPLE_TYPE: {
+            QPair<uint64, uint64> type(0, 0);
+            ProtoReader m = r.message();
+            while(m.next()) {
+                if (m.field() == 1) type.first = m.value();
+                else if (m.field() == 2) type.second = m.value();
+            }
+            _sampleTypes.append(type);
+            break;
+        }
+        case PROFILE_MAPPING: {
+            uint64 id = 0, filename = 0;
+            ProtoReader m = r.message();
+            while(m.next()) {
+                if (m.field() == 1) id = m.value();
+                else if (m.field() == 5) filename = m.value();
+            }
+            _mappings.insert(id, filename);
+            break;
+        }
+        case PROFILE_LOCATION:
+            _locationData.append(qMakePair(r.data(), r.value()));
+            break;
+        case PROFILE_FUNCTION: {
+            uint64 id = 0;
+            QPair<uint64, uint64> function(0, 0);
+            ProtoReader m = r.message();
+            while(m.next()) {
+                if (m.field() == 1) id = m.value();
+                else if (m.field() == 2) function.first = m.value();
+                else if (m.field() == 4) function.second = m.value();
+            }
+            _functions.insert(id, function);
+            break;
+        }
+        case PROFILE_STRING_TABLE:
+            _strings.append(qMakePair(r.data(), (int) r.value()));
+            break;
+        default:
+            break;
+        }
+    }
+    return !r.error();
+}
+
+/* Frames of a location, innermost (inlined) function first.
+ * A location without line info gets a frame named by its address.
+ */
+bool PProfLoader::readLocation(ProtoReader r)
+{
+    uint64 id = 0, mapping = 0, address = 0;
+    QVector<QPair<uint64, uint64> > lines;
+    while(r.next()) {
+        if (r.field() == 1) id = r.value();
+        else if (r.field() == 2) mapping = r.value();
+        else if (r.field() == 3) address = r.value();
+        else if ((r.field() == 4) && (r.wireType() == WIRE_LENGTH)) {
+            QPair<uint64, uint64> line(0, 0);
+            ProtoReader l = r.message();
+            while(l.next()) {
+                if (l.field() == 1) line.first = l.value();
+                else if (l.field() == 2) line.second = l.value();
+            }
+            lines.append(line);
+        }
+    }
+    if (r.error()) return false;
+
+    NameTable& names = _samples.names();
+    int object = nameId(_mappings.value(mapping, 0));
+    int start = _locationFrames.count();
+    typedef QPair<uint64, uint64> Line;
+    foreach(const Line& line, lines) {
+        QPair<uint64, uint64> function = _functions.value(line.first);
+        int name = nameId(function.first);
+        if (names.length(name) == 0)
+            name = names.intern(QStringLiteral("0x") + QString::number(address, 16));
+        _locationFrames.append(_samples.frame(name, object,
+                                              nameId(function.second),
+                                              (uint) line.second,
+                                              Addr(address)));
+    }
+    if (lines.isEmpty())
+        _locationFrames.append(_samples.frame(names.intern(QStringLiteral("0x") +
+                                                           QString::number(address, 16)),
+                                              object, names.intern(QString()), 0,
+                                              Addr(address)));
+
+    _locations.insert(id, qMakePair(start, _locationFrames.count() - start));
+    return true;
+}
+
+bool PProfLoader::readSamples(const char* data, uint64 len)
+{
+    int events = _samples.eventCount();
+    QVector<SubCost> values(events);
+    QVector<uint64> locationIDs, sampleValues;
+    QVector<int> stack;
+    int statusProgress = 0, samples = 0;
+
+    ProtoReader r(data, len);
+    while(r.next()) {
+        if (r.field() != PROFILE_SAMPLE) continue;
+
+        locationIDs.resize(0);
+        sampleValues.resize(0);
+        ProtoReader m = r.message();
+        while(m.next()) {
+            if (m.field() == 1) m.values(locationIDs);
+            else if (m.field() == 2) m.values(sampleValues);
+        }
+        if (m.error()) return false;
+
+        // negative values (e.g. in diff profiles) are not supported
+        for(int e=0; e<events; e++) {
+            qint64 v = (e < sampleValues.count()) ? (qint64) sampleValues.at(e) : 0;
+            values[e] = (v > 0) ? (uint64) v : 0;
+        }
+
+        // outermost caller first
+        stack.resize(0);
+        for(int i = locationIDs.count() - 1; i >= 0; i--) {
+            QHash<uint64, QPair<int, int> >::const_iterator it;
+            it = _locations.constFind(locationIDs.at(i));
+            if (it == _locations.constEnd()) continue;
+            for(int f = it.value().first + it.value().second - 1;
+                f >= it.value().first; f--)
+                stack.append(_locationFrames.at(f));
+        }
+        _samples.add(_part, stack.constData(), stack.count(), values.constData());
+
+        if ((++samples % 10000) == 0) {
+            int p = (int)(100.0 * r.offset() / len);
+            if (p != statusProgress) {
+                statusProgress = p;
+                loadProgress(p);
+            }
+        }
+    }
+    return !r.error();
+}
+
+int PProfLoader::loadInternal(TraceData* data,
+                              QIODevice* device, const QString& filename)
+{
+    if (!data || !device) return 0;
+
+    loadStart(filename);
+
+    // the whole profile is needed: map it, or read it if compressed
+    QByteArray buffer;
+    FixFile* file = nullptr;
+    const char* profile;
+    uint64 len;
+    if (device->isSequential()) {
+        buffer = device->readAll();
+        profile = buffer.constData();
+        len = buffer.size();
+    }
+    else {
+        file = new FixFile(device, filename);
+        if (!file->exists()) {
+            delete file;
+            loadFinished(QStringLiteral("File does not exist"));
+            return 0;
+        }
+        profile = file->data();
+        len = file->len();
+    }
+
+    bool ok = readTables(profile, len);
+    if (ok) {
+        // event names must not contain spaces, and be unique
+        for(int i=0; i<_sampleTypes.count(); i++) {
+            QString name = string(_sampleTypes.at(i).first);
+            QString unit = string(_sampleTypes.at(i).second);
+            name.replace(QLatin1Char(' '), QLatin1Char('_'));
+            if (name.isEmpty() || _samples.events().contains(name))
+                name += QStringLiteral("_%1").arg(i);
+            EventType::add(new EventType(name, unit.isEmpty() ? name :
+                                         QStringLiteral("%1 (%2)").arg(name, unit)),
+                           false);
+            _samples.event(name);
+        }
+        _part = _samples.part(0);
+
+        typedef QPair<const char*, uint64> Location;
+        foreach(const Location& l, _locationData)
+            if (!readLocation(ProtoReader(l.first, l.second))) {
+                ok = false;
+                break;
+            }
+    }
+    if (ok)
+        ok = readSamples(profile, len);
+    if (!ok)
+        loadError(0, QObject::tr("Invalid pprof profile data"));
+
+    int partsAdded = _samples.addTo(data, filename);
+    if (partsAdded == 0)
+        loadFinished(QStringLiteral("No samples found"));
+    else
+        loadFinished();
+
+    delete file;
+    device->close();
+
+    return partsAdded;
+}
@@ -0,0 +1,150 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Comparison of the function costs of two profiles
+ */
+
+#include "profilediff.h"
+
+#include <algorithm>
+
+#include <QHash>
+
+#include "tracedata.h"
+
+
+// functions of different profiles are the same if this matches
+static QString functionKey(TraceFunction* f)
+{
+    return f->name() + '\n' + f->file()->name() + '\n' + f->object()->name();
+}
+
+ProfileDiff::ProfileDiff(TraceData* base, TraceData* current)
+{
+    _base = base;
+    _current = current;
+
+    EventTypeSet* types = current->eventTypes();
+    EventTypeSet* baseTypes = base->eventTypes();
+    for(int i = 0; i < types->realCount() + types->derivedCount(); i++) {
+        EventType* t = (i < types->realCount()) ? types->realType(i) :
+                       types->derivedType(i - types->realCount());
+        EventType* bt = baseTypes->type(t->name());
+        if (!bt) continue;
+        _events.append(t->name());
+        _currentTypes.append(t);
+        _baseTypes.append(bt);
+    }
+
+    // hash join on function keys
+    QHash<QString, TraceFunction*> baseFunctions;
+    TraceFunctionMap::Iterator it;
+    for ( it = base->functionMap().begin();
+          it != base->functionMap().end(); ++it )
+        baseFunctions.insert(functionKey(&(*it)), &(*it));
+
+    for ( it = current->functionMap().begin();
+          it != current->functionMap().end(); ++it ) {
+        Entry e;
+        e.current = &(*it);
+        e.base = baseFunctions.take(functionKey(e.current));
+        _entries.append(e);
+    }
+
+    // removed functions, in order of the base profile
+    for ( it = base->functionMap().begin();
+          it != base->functionMap().end(); ++it ) {
+        if (!baseFunctions.contains(functionKey(&(*it)))) continue;
+        Entry e;
+        e.base = &(*it);
+        e.current = nullptr;
+        _entries.append(e);
+    }
+}
+
+SubCost ProfileDiff::cost(TraceFunction* f, EventType* t, bool inclusive)
+{
+    if (!f) return 0;
+    return inclusive ? f->inclusive()->subCost(t) : f->subCost(t);
+}
+
+void ProfileDiff::sort(int event, bool inclusive)
+{
+    // deltas are calculated once, as getting a cost may update it
+    QVector<qint64> deltas(_entries.count());
+    for(int i = 0; i < _entries.count(); i++)
+        deltas[i] = delta(i, event, inclusive);
+
+    QVector<int> order(_entries.count());
+    for(int i = 0; i < order.count(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&deltas](int i1, int i2) {
+        return deltas.at(i1) > deltas.at(i2);
+    });
+
+    QVector<Entry> entries(_entries.count());
+    for(int i = 0; i < order.count(); i++)
+        entries[i] = _entries.at(order.at(i));
+    _entries = entries;
+}
+
+SubCost ProfileDiff::baseCost(int i, int event, bool inclusive) const
+{
+    return cost(_entries.at(i).base, _baseTypes.at(event), inclusive);
+}
+
+SubCost ProfileDiff::currentCost(int i, int event, bool inclusive) const
+{
+    return cost(_entries.at(i).current, _currentTypes.at(event), inclusive);
+}
+
+qint64 ProfileDiff::delta(int i, int event, bool inclusive) const
+{
+    return (qint64)(uint64) currentCost(i, event, inclusive) -
+           (qint64)(uint64) baseCost(i, event, inclusive);
+}
+
+double ProfileDiff::relative(int i, int event, bool inclusive) const
+{
+    uint64 base = baseCost(i, event, inclusive);
+    if (base == 0) return 0.0;
+    return (double) delta(i, event, inclusive) / base;
+}
+
+SubCost ProfileDiff::baseTotal(int event) const
+{
+    return _base->subCost(_baseTypes.at(event));
+}
+
+SubCost ProfileDiff::currentTotal(int event) const
+{
+    return _current->subCost(_currentTypes.at(event));
+}
+
+qint64 ProfileDiff::totalDelta(int event) const
+{
+    return (qint64)(uint64) currentTotal(event) - (qint64)(uint64) baseTotal(event);
+}
+
+double ProfileDiff::totalRelative(int event) const
+{
+    uint64 base = baseTotal(event);
+    if (base == 0) return 0.0;
+    return (double) totalDelta(event) / base;
+}
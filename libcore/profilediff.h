@@ -0,0 +1,88 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Comparison of the function costs of two profiles
+ */
+
+#ifndef PROFILEDIFF_H
+#define PROFILEDIFF_H
+
+#include <QStringList>
+#include <QVector>
+
+#include "subcost.h"
+
+class TraceData;
+class TraceFunction;
+class EventType;
+
+/**
+ * Matches the functions of a base and a current profile by name, file
+ * and object, and gives the differences of their costs for the event
+ * types found in both profiles.
+ *
+ * Entries are functions found in one or both profiles. Deltas are
+ * current minus base cost, i.e. positive for regressions. Relative
+ * deltas are given as fraction of the base cost, and are 0 for
+ * functions without base cost.
+ */
+class ProfileDiff
+{
+public:
+    ProfileDiff(TraceData* base, TraceData* current);
+
+    struct Entry {
+        TraceFunction* base;    // nullptr for new functions
+        TraceFunction* current; // nullptr for removed functions
+    };
+
+    TraceData* base() const { return _base; }
+    TraceData* current() const { return _current; }
+
+    // names of event types found in both profiles
+    QStringList events() const { return _events; }
+    int eventIndex(const QString& name) const { return _events.indexOf(name); }
+
+    int count() const { return _entries.count(); }
+    const Entry& entry(int i) const { return _entries.at(i); }
+
+    // sort entries by decreasing delta of <event> (largest regression first)
+    void sort(int event, bool inclusive);
+
+    SubCost baseCost(int i, int event, bool inclusive) const;
+    SubCost currentCost(int i, int event, bool inclusive) const;
+    qint64 delta(int i, int event, bool inclusive) const;
+    double relative(int i, int event, bool inclusive) const;
+
+    // for total costs of the profiles
+    SubCost baseTotal(int event) const;
+    SubCost currentTotal(int event) const;
+    qint64 totalDelta(int event) const;
+    double totalRelative(int event) const;
+
+private:
+    static SubCost cost(TraceFunction* f, EventType* t, bool inclusive);
+
+    TraceData *_base, *_current;
+    QStringList _events;
+    QVector<EventType*> _baseTypes, _currentTypes;
+    QVector<Entry> _entries;
+};
+
+#endif // PROFILEDIFF_H
@@ -0,0 +1,252 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Generator of synthetic profile data in callgrind format
+ */
+
+#include "profilegenerator.h"
+
+#include <QIODevice>
+#include <QStringList>
+
+// output buffer is written to device when reaching this size
+#define BUFFER_SIZE (64*1024)
+
+// event type names, further ones are numbered
+static const char* eventNames[] = {
+    "Ir", "Dr", "Dw", "I1mr", "D1mr", "D1mw", "ILmr", "DLmr", "DLmw"
+};
+#define EVENT_NAMES 9
+
+
+ProfileGenerator::ProfileGenerator()
+{
+    _functions = 1000;
+    _files = 50;
+    _objects = 5;
+    _lines = 8;
+    _fanout = 4;
+    _backCalls = 0.0;
+    _parts = 1;
+    _threads = 1;
+    _events = 2;
+    _compression = true;
+    _positions = Lines;
+    _seed = 1;
+    _device = nullptr;
+    _error = false;
+}
+
+bool ProfileGenerator::setSpecification(const QString& spec)
+{
+    foreach(const QString& s, spec.split(QLatin1Char(','))) {
+        if (s.isEmpty()) continue;
+        QString name = s.section(QLatin1Char('='), 0, 0);
+        QString value = s.section(QLatin1Char('='), 1);
+        bool ok = true;
+        int n = value.toInt(&ok);
+
+        if (name == QLatin1String("positions")) {
+            if (value == QLatin1String("line")) _positions = Lines;
+            else if (value == QLatin1String("instr")) _positions = Instructions;
+            else if (value == QLatin1String("both")) _positions = Both;
+            else return false;
+            continue;
+        }
+        if (name == QLatin1String("backcalls")) {
+            _backCalls = value.toDouble(&ok);
+            if (!ok || (_backCalls < 0) || (_backCalls > 1)) return false;
+            continue;
+        }
+        if (!ok) return false;
+
+        if (name == QLatin1String("compression")) {
+            _compression = (n != 0);
+            continue;
+        }
+        if (n < 1) return false;
+        if (name == QLatin1String("functions")) _functions = n;
+        else if (name == QLatin1String("files")) _files = n;
+        else if (name == QLatin1String("objects")) _objects = n;
+        else if (name == QLatin1String("lines")) _lines = n;
+        else if (name == QLatin1String("fanout")) _fanout = n;
+        else if (name == QLatin1String("parts")) _parts = n;
+        else if (name == QLatin1String("threads")) _threads = n;
+        else if (name == QLatin1String("events")) _events = n;
+        else return false;
+    }
+    return true;
+}
+
+// xorshift, for reproducible output
+quint32 ProfileGenerator::random()
+{
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return (quint32) (_seed >> 32);
+}
+
+bool ProfileGenerator::write(QIODevice* device)
+{
+    if (!device) return false;
+
+    _device = device;
+    _error = false;
+    _seed = 1;
+    _buffer.reserve(BUFFER_SIZE + 1024);
+
+    _buffer += "# callgrind format\n"
+               "version: 1\n"
+               "creator: cgview (synthetic profile)\n"
+               "cmd: synthetic\n";
+
+    for(int t = 0; t < _threads; t++)
+        for(int p = 0; p < _parts; p++) {
+            writePart(t * _parts + p + 1, t + 1);
+            if (_error) return false;
+        }
+
+    flush(true);
+    return !_error;
+}
+
+void ProfileGenerator::writePart(int part, int thread)
+{
+    _buffer += "\npart: ";
+    _buffer += QByteArray::number(part);
+    _buffer += "\nthread: ";
+    _buffer += QByteArray::number(thread);
+    _buffer += (_positions == Lines) ? "\npositions: line" :
+               (_positions == Instructions) ? "\npositions: instr" :
+                                             "\npositions: instr line";
+    // a new event list starts a new part: has to be last
+    _buffer += "\nevents:";
+    for(int e = 0; e < _events; e++) {
+        _buffer += ' ';
+        if (e < EVENT_NAMES)
+            _buffer += eventNames[e];
+        else
+            _buffer += "Ev" + QByteArray::number(e);
+    }
+    _buffer += '\n';
+
+    // compressed names are defined per part
+    _written[0].fill(0, _objects);
+    _written[1].fill(0, _files);
+    _written[2].fill(0, _functions);
+
+    for(int f = 0; f < _functions; f++) {
+        int file = f % _files;
+        int object = file % _objects;
+
+        _buffer += '\n';
+        writeName("ob=", 0, object);
+        writeName("fl=", 1, file);
+        writeName("fn=", 2, f);
+        for(int l = 0; l < _lines; l++) {
+            writePosition(f, l);
+            writeCosts(random() % 1000 + 1);
+        }
+
+        for(int c = 0; c < _fanout; c++) {
+            int called;
+            if ((f + 1 >= _functions) ||
+                (random() < _backCalls * 4294967296.0))
+                called = random() % _functions;
+            else
+                called = f + 1 + random() % (_functions - f - 1);
+
+            // called object and file default to the ones of the caller
+            int calledFile = called % _files;
+            if (calledFile % _objects != object)
+                writeName("cob=", 0, calledFile % _objects);
+            if (calledFile != file)
+                writeName("cfi=", 1, calledFile);
+            writeName("cfn=", 2, called);
+            _buffer += "calls=";
+            _buffer += QByteArray::number(random() % 100 + 1);
+            _buffer += ' ';
+            writePosition(called, 0);
+            _buffer += '\n';
+            writePosition(f, c % _lines);
+            writeCosts(random() % 100000 + 1);
+        }
+
+        flush();
+        if (_error) return;
+    }
+}
+
+void ProfileGenerator::writeName(const char* prefix, int kind, int id)
+{
+    _buffer += prefix;
+    if (_compression) {
+        _buffer += '(';
+        _buffer += QByteArray::number(id + 1);
+        _buffer += ')';
+        if (_written[kind].at(id)) {
+            _buffer += '\n';
+            return;
+        }
+        _written[kind][id] = 1;
+        _buffer += ' ';
+    }
+
+    if (kind == 0)
+        _buffer += "/usr/lib/libsynth" + QByteArray::number(id) + ".so";
+    else if (kind == 1)
+        _buffer += "/src/synth/file" + QByteArray::number(id) + ".c";
+    else
+        _buffer += "synth_function_" + QByteArray::number(id);
+    _buffer += '\n';
+}
+
+void ProfileGenerator::writePosition(int function, int line)
+{
+    if (_positions != Lines) {
+        _buffer += "0x";
+        _buffer += QByteArray::number(0x400000 + function * 0x100 + line * 4, 16);
+        if (_positions == Both) _buffer += ' ';
+    }
+    if (_positions != Instructions) {
+        // functions of a file are placed one after the other
+        int first = 10 + (function / _files) * (_lines + 10);
+        _buffer += QByteArray::number(first + line);
+    }
+}
+
+void ProfileGenerator::writeCosts(quint64 base)
+{
+    for(int e = 0; e < _events; e++) {
+        _buffer += ' ';
+        _buffer += QByteArray::number(base / (e + 1) + random() % 8);
+    }
+    _buffer += '\n';
+}
+
+void ProfileGenerator::flush(bool force)
+{
+    if (_error || _buffer.isEmpty()) return;
+    if (!force && (_buffer.size() < BUFFER_SIZE)) return;
+
+    if (_device->write(_buffer) != _buffer.size())
+        _error = true;
+    _buffer.clear();
+}
@@ -0,0 +1,98 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Generator of synthetic profile data in callgrind format
+ */
+
+#ifndef PROFILEGENERATOR_H
+#define PROFILEGENERATOR_H
+
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+
+/**
+ * Writes a synthetic profile in callgrind format, for benchmarks of
+ * loading and cost updates. The output only depends on the parameters
+ * (pseudo random numbers with fixed seed).
+ *
+ * Functions are spread over files and objects. Each has cost lines and
+ * calls to functions with higher index, i.e. the call graph is acyclic
+ * unless a fraction of calls is set to go backwards, which creates
+ * recursive cycles.
+ */
+class ProfileGenerator
+{
+public:
+    enum Positions { Lines, Instructions, Both };
+
+    ProfileGenerator();
+
+    /**
+     * Set parameters from a specification "<name>=<value>,...", with
+     * names of the setters below, e.g. "functions=10000,events=4".
+     * Returns false on unknown names or invalid values.
+     */
+    bool setSpecification(const QString& spec);
+
+    void setFunctions(int n) { _functions = n; }
+    void setFiles(int n) { _files = n; }
+    void setObjects(int n) { _objects = n; }
+    // cost lines per function
+    void setLines(int n) { _lines = n; }
+    // calls per function
+    void setFanout(int n) { _fanout = n; }
+    // fraction of calls to functions with lower index
+    void setBackCalls(double f) { _backCalls = f; }
+    // parts per thread
+    void setParts(int n) { _parts = n; }
+    void setThreads(int n) { _threads = n; }
+    void setEvents(int n) { _events = n; }
+    // name compression "(id) name"
+    void setCompression(bool on) { _compression = on; }
+    // positions "line", "instr" or "both" in a specification
+    void setPositions(Positions p) { _positions = p; }
+
+    // returns false on write error
+    bool write(QIODevice* device);
+
+private:
+    quint32 random();
+    void writePart(int part, int thread);
+    void writeName(const char* prefix, int kind, int id);
+    void writePosition(int function, int line);
+    void writeCosts(quint64 base);
+    void flush(bool force = false);
+
+    int _functions, _files, _objects, _lines, _fanout;
+    double _backCalls;
+    int _parts, _threads, _events;
+    bool _compression;
+    Positions _positions;
+
+    quint64 _seed;
+    // per kind of name (object, file, function): flags for IDs written
+    QByteArray _written[3];
+    QByteArray _buffer;
+    QIODevice* _device;
+    bool _error;
+};
+
+#endif // PROFILEGENERATOR_H
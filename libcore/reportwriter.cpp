@@ -0,0 +1,550 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Machine readable export of cost items with highest cost
+ */
+
+#include "reportwriter.h"
+
+#include <algorithm>
+
+#include <QIODevice>
+#include <QVector>
+
+#include "tracedata.h"
+#include "profilediff.h"
+
+// output buffer is written to device when reaching this size
+#define BUFFER_SIZE (64*1024)
+
+
+ReportWriter::ReportWriter(TraceData* data, Format format)
+{
+    _data = data;
+    _format = format;
+    _grouping = Function;
+    _sortEvent = nullptr;
+    _sortExclusive = false;
+    _sortByCount = false;
+    _showCalls = false;
+    _topCount = 50;
+    _device = nullptr;
+    _error = false;
+    _items = 0;
+}
+
+bool ReportWriter::format(const QString& name, Format& format)
+{
+    if (name == QLatin1String("json")) format = Json;
+    else if (name == QLatin1String("csv")) format = Csv;
+    else if (name == QLatin1String("ndjson")) format = NdJson;
+    else return false;
+    return true;
+}
+
+bool ReportWriter::grouping(const QString& name, Grouping& grouping)
+{
+    if (name == QLatin1String("function")) grouping = Function;
+    else if (name == QLatin1String("object")) grouping = Object;
+    else if (name == QLatin1String("file")) grouping = File;
+    else if (name == QLatin1String("class")) grouping = Class;
+    else return false;
+    return true;
+}
+
+void ReportWriter::setSortEvent(EventType* eventType, bool exclusive)
+{
+    _sortEvent = eventType;
+    _sortExclusive = exclusive;
+}
+
+QList<TraceCostItem*> ReportWriter::sortedItems()
+{
+    QVector<TraceCostItem*> items;
+    switch(_grouping) {
+    case Function: {
+        TraceFunctionMap::Iterator it;
+        for ( it = _data->functionMap().begin();
+              it != _data->functionMap().end(); ++it )
+            items.append(&(*it));
+        foreach(TraceFunction* f, _data->functionCycles())
+            items.append(f);
+        break;
+    }
+    case Object: {
+        TraceObjectMap::Iterator it;
+        for ( it = _data->objectMap().begin();
+              it != _data->objectMap().end(); ++it )
+            items.append(&(*it));
+        break;
+    }
+    case File: {
+        TraceFileMap::Iterator it;
+        for ( it = _data->fileMap().begin();
+              it != _data->fileMap().end(); ++it )
+            items.append(&(*it));
+        break;
+    }
+    case Class: {
+        TraceClassMap::Iterator it;
+        for ( it = _data->classMap().begin();
+              it != _data->classMap().end(); ++it )
+            items.append(&(*it));
+        break;
+    }
+    }
+
+    // sort keys are calculated once, as getting a cost may update it
+    QVector<SubCost> keys(items.count());
+    for(int i = 0; i < items.count(); i++) {
+        TraceCostItem* item = items.at(i);
+        if (_sortByCount && (_grouping == Function))
+            keys[i] = ((TraceFunction*)item)->calledCount();
+        else if (_sortExclusive)
+            keys[i] = item->subCost(_sortEvent);
+        else
+            keys[i] = item->inclusive()->subCost(_sortEvent);
+    }
+
+    QVector<int> order(items.count());
+    for(int i = 0; i < order.count(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&keys](int i1, int i2) {
+        return keys.at(i1) > keys.at(i2);
+    });
+
+    int count = order.count();
+    if ((_topCount > 0) && (_topCount < count)) count = _topCount;
+    QList<TraceCostItem*> sorted;
+    for(int i = 0; i < count; i++)
+        sorted.append(items.at(order.at(i)));
+    return sorted;
+}
+
+bool ReportWriter::write(QIODevice* device)
+{
+    if (!_data || !device) return false;
+
+    _device = device;
+    _error = false;
+    _items = 0;
+    _buffer.reserve(BUFFER_SIZE + 1024);
+
+    EventTypeSet* types = _data->eventTypes();
+    _eventTypes.clear();
+    for(int i = 0; i < types->realCount(); i++)
+        _eventTypes.append(types->realType(i));
+    for(int i = 0; i < types->derivedCount(); i++)
+        _eventTypes.append(types->derivedType(i));
+    if (!_sortEvent && !_eventTypes.isEmpty())
+        _sortEvent = _eventTypes.first();
+
+    writeHeader();
+    foreach(TraceCostItem* item, sortedItems()) {
+        writeItem(item);
+        flush();
+        if (_error) break;
+    }
+
+    if (_format == Json)
+        _buffer += (_items > 0) ? "\n]}\n" : "]}\n";
+    flush(true);
+
+    return !_error;
+}
+
+void ReportWriter::writeHeader()
+{
+    static const char* groupNames[] = { "function", "object", "file", "class" };
+
+    if (_format == Csv) {
+        _buffer += "kind,name,object,file,count";
+        foreach(EventType* t, _eventTypes) {
+            _buffer += ',';
+            writeString(QStringLiteral("excl_") + t->name());
+        }
+        foreach(EventType* t, _eventTypes) {
+            _buffer += ',';
+            writeString(QStringLiteral("incl_") + t->name());
+        }
+        _buffer += '\n';
+        return;
+    }
+
+    _buffer += (_format == NdJson) ? "{\"type\":\"header\",\"command\":" : "{\"command\":";
+    writeString(_data->command());
+    _buffer += ",\"grouping\":\"";
+    _buffer += groupNames[_grouping];
+    _buffer += "\",\"sort\":";
+    if (_sortByCount && (_grouping == Function))
+        _buffer += "\"count\"";
+    else {
+        writeString(_sortEvent ? _sortEvent->name() : QString());
+        _buffer += _sortExclusive ? ",\"sort_by\":\"exclusive\"" :
+                                    ",\"sort_by\":\"inclusive\"";
+    }
+    _buffer += ",\"events\":[";
+    for(int i = 0; i < _eventTypes.count(); i++) {
+        EventType* t = _eventTypes.at(i);
+        if (i > 0) _buffer += ',';
+        _buffer += "{\"name\":";
+        writeString(t->name());
+        _buffer += ",\"long_name\":";
+        writeString(t->longName());
+        _buffer += ",\"total\":";
+        writeNumber(_data->subCost(t));
+        _buffer += '}';
+    }
+    _buffer += (_format == NdJson) ? "]}\n" : "],\n\"items\":[";
+}
+
+void ReportWriter::writeItem(TraceCostItem* item)
+{
+    TraceFunction* f = (_grouping == Function) ? (TraceFunction*) item : nullptr;
+
+    if (_format == Csv) {
+        _buffer += "item,";
+        writeString(item->name());
+        _buffer += ',';
+        if (f) {
+            writeString(f->object()->name());
+            _buffer += ',';
+            writeString(f->file()->name());
+            _buffer += ',';
+            writeNumber(f->calledCount());
+        }
+        else
+            _buffer += ",,";
+        writeCosts(nullptr, item);
+        writeCosts(nullptr, item->inclusive());
+        _buffer += '\n';
+    }
+    else {
+        if (_format == NdJson)
+            _buffer += "{\"type\":\"item\",\"name\":";
+        else
+            _buffer += (_items > 0) ? ",\n{\"name\":" : "\n{\"name\":";
+        writeString(item->name());
+        if (f) {
+            _buffer += ",\"object\":";
+            writeString(f->object()->name());
+            _buffer += ",\"file\":";
+            writeString(f->file()->name());
+            _buffer += ",\"called\":";
+            writeNumber(f->calledCount());
+        }
+        writeCosts("exclusive", item);
+        writeCosts("inclusive", item->inclusive());
+    }
+
+    if (f && _showCalls) {
+        writeCalls(f, true);
+        writeCalls(f, false);
+    }
+
+    if (_format == NdJson)
+        _buffer += "}\n";
+    else if (_format == Json)
+        _buffer += '}';
+    _items++;
+}
+
+void ReportWriter::writeCalls(TraceCostItem* item, bool callers)
+{
+    TraceFunction* f = (TraceFunction*) item;
+    TraceCallList calls = callers ? f->callers() : f->callings();
+
+    if (_format != Csv)
+        _buffer += callers ? ",\"callers\":[" : ",\"callees\":[";
+
+    bool first = true;
+    foreach(TraceCall* c, calls) {
+        TraceFunction* other = callers ? c->caller() : c->called();
+        if (_format == Csv) {
+            _buffer += callers ? "caller," : "callee,";
+            writeString(other->name());
+            _buffer += ',';
+            writeString(other->object()->name());
+            _buffer += ',';
+            writeString(other->file()->name());
+            _buffer += ',';
+            writeNumber(c->callCount());
+            // a call only has inclusive cost
+            for(int i = 0; i < _eventTypes.count(); i++)
+                _buffer += ',';
+            writeCosts(nullptr, c);
+            _buffer += '\n';
+            continue;
+        }
+
+        _buffer += first ? "{\"name\":" : ",{\"name\":";
+        first = false;
+        writeString(other->name());
+        _buffer += ",\"object\":";
+        writeString(other->object()->name());
+        _buffer += ",\"count\":";
+        writeNumber(c->callCount());
+        writeCosts("cost", c);
+        _buffer += '}';
+    }
+
+    if (_format != Csv)
+        _buffer += ']';
+}
+
+// as CSV columns, or JSON object "<key>":{"<event>":<cost>,...}
+void ReportWriter::writeCosts(const char* key, ProfileCostArray* costs)
+{
+    if (_format == Csv) {
+        foreach(EventType* t, _eventTypes) {
+            _buffer += ',';
+            writeNumber(costs->subCost(t));
+        }
+        return;
+    }
+
+    _buffer += ",\"";
+    _buffer += key;
+    _buffer += "\":{";
+    for(int i = 0; i < _eventTypes.count(); i++) {
+        EventType* t = _eventTypes.at(i);
+        if (i > 0) _buffer += ',';
+        writeString(t->name());
+        _buffer += ':';
+        writeNumber(costs->subCost(t));
+    }
+    _buffer += '}';
+}
+
+bool ReportWriter::writeDiff(QIODevice* device, const ProfileDiff& diff)
+{
+    if (!device) return false;
+
+    _device = device;
+    _error = false;
+    _items = 0;
+    _buffer.reserve(BUFFER_SIZE + 1024);
+
+    writeDiffHeader(diff);
+    int count = diff.count();
+    if ((_topCount > 0) && (_topCount < count)) count = _topCount;
+    for(int i = 0; (i < count) && !_error; i++) {
+        writeDiffItem(diff, i);
+        flush();
+    }
+
+    if (_format == Json)
+        _buffer += (_items > 0) ? "\n]}\n" : "]}\n";
+    flush(true);
+
+    return !_error;
+}
+
+void ReportWriter::writeDiffHeader(const ProfileDiff& diff)
+{
+    QStringList events = diff.events();
+
+    if (_format == Csv) {
+        _buffer += "name,object,file,status";
+        for(int excl = 1; excl >= 0; excl--)
+            foreach(const QString& e, events) {
+                QString prefix = QLatin1String(excl ? "excl_" : "incl_");
+                _buffer += ',';
+                writeString(prefix + QLatin1String("base_") + e);
+                _buffer += ',';
+                writeString(prefix + QLatin1String("delta_") + e);
+                _buffer += ',';
+                writeString(prefix + QLatin1String("rel_") + e);
+            }
+        _buffer += '\n';
+        return;
+    }
+
+    _buffer += (_format == NdJson) ? "{\"type\":\"header\",\"base\":" : "{\"base\":";
+    writeString(diff.base()->traceName());
+    _buffer += ",\"current\":";
+    writeString(diff.current()->traceName());
+    _buffer += ",\"sort\":";
+    writeString(_sortEvent ? _sortEvent->name() : QString());
+    _buffer += _sortExclusive ? ",\"sort_by\":\"exclusive\"" :
+                                ",\"sort_by\":\"inclusive\"";
+    _buffer += ",\"events\":[";
+    for(int e = 0; e < events.count(); e++) {
+        if (e > 0) _buffer += ',';
+        _buffer += "{\"name\":";
+        writeString(events.at(e));
+        _buffer += ",\"current\":";
+        writeNumber(diff.currentTotal(e));
+        writeDiffValues(diff.baseTotal(e), diff.totalDelta(e),
+                        diff.totalRelative(e));
+        _buffer += '}';
+    }
+    _buffer += (_format == NdJson) ? "]}\n" : "],\n\"items\":[";
+}
+
+void ReportWriter::writeDiffItem(const ProfileDiff& diff, int i)
+{
+    const ProfileDiff::Entry& e = diff.entry(i);
+    TraceFunction* f = e.current ? e.current : e.base;
+    const char* status = !e.base ? "new" : !e.current ? "removed" : "changed";
+
+    if (_format == Csv) {
+        writeString(f->name());
+        _buffer += ',';
+        writeString(f->object()->name());
+        _buffer += ',';
+        writeString(f->file()->name());
+        _buffer += ',';
+        _buffer += status;
+        writeDiffCosts(nullptr, diff, i, false);
+        writeDiffCosts(nullptr, diff, i, true);
+        _buffer += '\n';
+        _items++;
+        return;
+    }
+
+    if (_format == NdJson)
+        _buffer += "{\"type\":\"item\",\"name\":";
+    else
+        _buffer += (_items > 0) ? ",\n{\"name\":" : "\n{\"name\":";
+    writeString(f->name());
+    _buffer += ",\"object\":";
+    writeString(f->object()->name());
+    _buffer += ",\"file\":";
+    writeString(f->file()->name());
+    _buffer += ",\"status\":\"";
+    _buffer += status;
+    _buffer += '"';
+    writeDiffCosts("exclusive", diff, i, false);
+    writeDiffCosts("inclusive", diff, i, true);
+    _buffer += (_format == NdJson) ? "}\n" : "}";
+    _items++;
+}
+
+// as CSV columns, or "<key>":{"<event>":{"base":..,"delta":..},...}
+void ReportWriter::writeDiffCosts(const char* key, const ProfileDiff& diff,
+                                  int i, bool inclusive)
+{
+    int events = diff.events().count();
+
+    if (_format == Csv) {
+        for(int e = 0; e < events; e++) {
+            _buffer += ',';
+            writeNumber(diff.baseCost(i, e, inclusive));
+            _buffer += ',';
+            writeSigned(diff.delta(i, e, inclusive));
+            _buffer += ',';
+            writeDouble(diff.relative(i, e, inclusive));
+        }
+        return;
+    }
+
+    _buffer += ",\"";
+    _buffer += key;
+    _buffer += "\":{";
+    for(int e = 0; e < events; e++) {
+        if (e > 0) _buffer += ',';
+        writeString(diff.events().at(e));
+        _buffer += ":{\"current\":";
+        writeNumber(diff.currentCost(i, e, inclusive));
+        writeDiffValues(diff.baseCost(i, e, inclusive),
+                        diff.delta(i, e, inclusive),
+                        diff.relative(i, e, inclusive));
+        _buffer += '}';
+    }
+    _buffer += '}';
+}
+
+// JSON members following another one
+void ReportWriter::writeDiffValues(SubCost base, qint64 delta, double relative)
+{
+    _buffer += ",\"base\":";
+    writeNumber(base);
+    _buffer += ",\"delta\":";
+    writeSigned(delta);
+    _buffer += ",\"relative\":";
+    writeDouble(relative);
+}
+
+// quoted for the format (JSON string, or CSV field if needed)
+void ReportWriter::writeString(const QString& s)
+{
+    QByteArray b = s.toUtf8();
+
+    if (_format == Csv) {
+        bool quote = false;
+        for(int i = 0; i < b.size(); i++)
+            if ((b[i] == ',') || (b[i] == '"') ||
+                (b[i] == '\n') || (b[i] == '\r')) {
+                quote = true;
+                break;
+            }
+        if (!quote) {
+            _buffer += b;
+            return;
+        }
+        _buffer += '"';
+        _buffer += b.replace('"', "\"\"");
+        _buffer += '"';
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    _buffer += '"';
+    for(int i = 0; i < b.size(); i++) {
+        unsigned char c = b[i];
+        if (c == '"') _buffer += "\\\"";
+        else if (c == '\\') _buffer += "\\\\";
+        else if (c == '\n') _buffer += "\\n";
+        else if (c == '\t') _buffer += "\\t";
+        else if (c < 0x20) {
+            _buffer += "\\u00";
+            _buffer += hex[c >> 4];
+            _buffer += hex[c & 15];
+        }
+        else
+            _buffer += (char) c;
+    }
+    _buffer += '"';
+}
+
+void ReportWriter::writeNumber(quint64 v)
+{
+    _buffer += QByteArray::number(v);
+}
+
+void ReportWriter::writeSigned(qint64 v)
+{
+    _buffer += QByteArray::number(v);
+}
+
+void ReportWriter::writeDouble(double v)
+{
+    _buffer += QByteArray::number(v, 'g', 6);
+}
+
+void ReportWriter::flush(bool force)
+{
+    if (_error || _buffer.isEmpty()) return;
+    if (!force && (_buffer.size() < BUFFER_SIZE)) return;
+
+    if (_device->write(_buffer) != _buffer.size())
+        _error = true;
+    _buffer.clear();
+}
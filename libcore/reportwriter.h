@@ -0,0 +1,120 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Machine readable export of cost items with highest cost
+ */
+
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "subcost.h"
+
+class QIODevice;
+class TraceData;
+class TraceCostItem;
+class ProfileCostArray;
+class EventType;
+class ProfileDiff;
+
+/**
+ * Writes cost items of a TraceData sorted by cost as JSON, CSV or
+ * newline delimited JSON (NDJSON), with exclusive and inclusive costs
+ * for all event types and optionally the callers and callees of
+ * functions.
+ *
+ * Items are formatted one by one into a small buffer which is written
+ * to the device when full, so output size is not limited by memory.
+ *
+ * JSON is one object with a header and an "items" array. NDJSON has
+ * the header on the first line, followed by one item per line. CSV has
+ * a row per item ("kind" column "item"), optionally followed by rows
+ * for its calls ("caller" or "callee", with call costs as inclusive
+ * costs and the call count in the "count" column).
+ *
+ * Alternatively, the functions of a ProfileDiff can be written, with
+ * base cost, delta and relative delta instead of costs.
+ */
+class ReportWriter
+{
+public:
+    enum Format { Json, Csv, NdJson };
+    enum Grouping { Function, Object, File, Class };
+
+    ReportWriter(TraceData* data, Format format);
+
+    // format/grouping by name (e.g. "json", "object"), false if unknown
+    static bool format(const QString& name, Format& format);
+    static bool grouping(const QString& name, Grouping& grouping);
+
+    void setGrouping(Grouping grouping) { _grouping = grouping; }
+
+    // sort by exclusive/inclusive cost of <eventType>, or call count
+    void setSortEvent(EventType* eventType, bool exclusive);
+    void setSortByCount(bool byCount) { _sortByCount = byCount; }
+
+    // number of items written, 0 for all (default 50)
+    void setTopCount(int count) { _topCount = count; }
+
+    // with function grouping, also write callers and callees
+    void setShowCalls(bool showCalls) { _showCalls = showCalls; }
+
+    // returns false on write error
+    bool write(QIODevice* device);
+
+    // write entries of <diff> in its order, up to the top count
+    bool writeDiff(QIODevice* device, const ProfileDiff& diff);
+
+    int items() const { return _items; }
+
+private:
+    QList<TraceCostItem*> sortedItems();
+    void writeHeader();
+    void writeItem(TraceCostItem* item);
+    void writeCalls(TraceCostItem* item, bool callers);
+    void writeCosts(const char* key, ProfileCostArray* costs);
+    void writeDiffHeader(const ProfileDiff& diff);
+    void writeDiffItem(const ProfileDiff& diff, int i);
+    void writeDiffCosts(const char* key, const ProfileDiff& diff,
+                        int i, bool inclusive);
+    void writeDiffValues(SubCost base, qint64 delta, double relative);
+    void writeString(const QString& s);
+    void writeNumber(quint64 v);
+    void writeSigned(qint64 v);
+    void writeDouble(double v);
+    void flush(bool force = false);
+
+    TraceData* _data;
+    Format _format;
+    Grouping _grouping;
+    EventType* _sortEvent;
+    bool _sortExclusive, _sortByCount, _showCalls;
+    int _topCount;
+
+    QList<EventType*> _eventTypes;
+    QByteArray _buffer;
+    QIODevice* _device;
+    bool _error;
+    int _items;
+};
+
+#endif // REPORTWRITER_H
@@ -0,0 +1,495 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Aggregation of sampled call stacks
+ */
+
+#include "stacksamples.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <QAtomicInt>
+
+#include "tracedata.h"
+#include "fixcost.h"
+#include "utils.h"
+#include "parallel.h"
+
+
+StackSamples::StackSamples()
+{
+    _stride = 1;
+    _samples = 0;
+}
+
+int StackSamples::event(const QString& name)
+{
+    int index = _events.indexOf(name);
+    if (index >= 0) return index;
+
+    _events.append(name);
+    if (_events.count() > _stride)
+        setStride(2 * _stride);
+    return _events.count() - 1;
+}
+
+// space for more event types in cost arrays of all parts
+void StackSamples::setStride(int stride)
+{
+    for(int i=0; i<_parts.count(); i++) {
+        Part& p = _parts[i];
+
+        QVector<SubCost> self(p.selfSlot.count() * stride);
+        for(int s=0; s<p.selfSlot.count(); s++)
+            for(int e=0; e<_stride; e++)
+                self[s*stride + e] = p.self.at(s*_stride + e);
+        p.self = self;
+
+        // sample count of calls stays last
+        QVector<SubCost> calls(p.callSlot.count() * (stride+1));
+        for(int s=0; s<p.callSlot.count(); s++) {
+            for(int e=0; e<_stride; e++)
+                calls[s*(stride+1) + e] = p.calls.at(s*(_stride+1) + e);
+            calls[s*(stride+1) + stride] = p.calls.at(s*(_stride+1) + _stride);
+        }
+        p.calls = calls;
+    }
+    _stride = stride;
+}
+
+int StackSamples::frame(int function, int object, int file,
+                        uint line, Addr addr, int source)
+{
+    Frame f;
+    f.function = function;
+    f.object = object;
+    f.file = file;
+    f.source = (source < 0) ? file : source;
+    f.line = line;
+    f.addr = addr;
+
+    int& index = _frameIndex[f];
+    if (index == 0) {
+        _frames.append(f);
+        // stored with offset 1, as 0 marks a new entry
+        index = _frames.count();
+    }
+    return index - 1;
+}
+
+int StackSamples::part(qint64 key, int threadID)
+{
+    QHash<qint64, int>::const_iterator it = _partIndex.constFind(key);
+    if (it != _partIndex.constEnd()) return it.value();
+
+    Part p;
+    p.key = key;
+    p.threadID = threadID;
+    _parts.append(p);
+    _partIndex.insert(key, _parts.count() - 1);
+    return _parts.count() - 1;
+}
+
+SubCost* StackSamples::selfCost(Part& p, int frame)
+{
+    int slot = p.selfSlot.value(frame, -1);
+    if (slot < 0) {
+        slot = p.selfSlot.count();
+        p.selfSlot.insert(frame, slot);
+        p.self.resize((slot+1) * _stride);
+    }
+    return p.self.data() + slot * _stride;
+}
+
+int StackSamples::callSlot(Part& p, int caller, int called)
+{
+    quint64 key = ((quint64) caller << 32) | (quint32) called;
+    int slot = p.callSlot.value(key, -1);
+    if (slot < 0) {
+        slot = p.callSlot.count();
+        p.callSlot.insert(key, slot);
+        p.calls.resize((slot+1) * (_stride+1));
+        p.lastSample.resize(slot+1);
+    }
+    return slot;
+}
+
+void StackSamples::add(int part, const int* frames, int count,
+                       int event, SubCost value)
+{
+    if (count <= 0) return;
+
+    Part& p = _parts[part];
+    _samples++;
+
+    selfCost(p, frames[count-1])[event] += value;
+
+    for(int i=0; i+1 < count; i++) {
+        int slot = callSlot(p, frames[i], frames[i+1]);
+
+        // with recursion, a call can appear multiple times in a stack:
+        // add the sample only once
+        if (p.lastSample.at(slot) == _samples) continue;
+        p.lastSample[slot] = _samples;
+
+        SubCost* c = p.calls.data() + slot * (_stride+1);
+        c[event] += value;
+        c[_stride] += 1;
+    }
+}
+
+void StackSamples::add(int part, const int* frames, int count,
+                       const SubCost* values)
+{
+    if (count <= 0) return;
+
+    Part& p = _parts[part];
+    int events = _events.count();
+    _samples++;
+
+    SubCost* self = selfCost(p, frames[count-1]);
+    for(int e=0; e<events; e++)
+        self[e] += values[e];
+
+    for(int i=0; i+1 < count; i++) {
+        int slot = callSlot(p, frames[i], frames[i+1]);
+        if (p.lastSample.at(slot) == _samples) continue;
+        p.lastSample[slot] = _samples;
+
+        SubCost* c = p.calls.data() + slot * (_stride+1);
+        for(int e=0; e<events; e++)
+            c[e] += values[e];
+        c[_stride] += 1;
+    }
+}
+
+void StackSamples::merge(const StackSamples& s)
+{
+    QVector<int> events(s._events.count());
+    for(int e=0; e<s._events.count(); e++)
+        events[e] = event(s._events.at(e));
+
+    QVector<int> names(s._names.count());
+    for(int n=0; n<s._names.count(); n++)
+        names[n] = _names.intern(s._names.utf8(n), s._names.length(n));
+
+    QVector<int> frames(s._frames.count());
+    for(int f=0; f<s._frames.count(); f++) {
+        const Frame& fr = s._frames.at(f);
+        frames[f] = frame(names.at(fr.function), names.at(fr.object),
+                          names.at(fr.file), fr.line, fr.addr,
+                          names.at(fr.source));
+    }
+
+    foreach(const Part& sp, s._parts) {
+        Part& p = _parts[part(sp.key, sp.threadID)];
+
+        QHash<int, int>::const_iterator it;
+        for(it = sp.selfSlot.constBegin(); it != sp.selfSlot.constEnd(); ++it) {
+            const SubCost* from = sp.self.constData() + it.value() * s._stride;
+            SubCost* to = selfCost(p, frames.at(it.key()));
+            for(int e=0; e<s._events.count(); e++)
+                to[events.at(e)] += from[e];
+        }
+
+        QHash<quint64, int>::const_iterator cit;
+        for(cit = sp.callSlot.constBegin(); cit != sp.callSlot.constEnd(); ++cit) {
+            const SubCost* from = sp.calls.constData() + cit.value() * (s._stride+1);
+            int slot = callSlot(p, frames.at(cit.key() >> 32),
+                                frames.at(cit.key() & 0xffffffff));
+            SubCost* to = p.calls.data() + slot * (_stride+1);
+            for(int e=0; e<s._events.count(); e++)
+                to[events.at(e)] += from[e];
+            to[_stride] += from[s._stride];
+        }
+    }
+
+    _samples += s._samples;
+}
+
+int StackSamples::add(int part, TraceData* data)
+{
+#if USE_FIXCOST
+    EventTypeSet* types = data->eventTypes();
+    QVector<int> events;
+    QVector<TraceFunction*> functions;
+    TraceFunctionMap::Iterator fit;
+    for ( fit = data->functionMap().begin();
+          fit != data->functionMap().end(); ++fit )
+        functions.append(&(*fit));
+
+    // our IDs for names of <data>, -1 if not interned yet
+    const NameTable* dataNames = data->names();
+    QVector<int> names(dataNames->count(), -1);
+    auto ourId = [&](int id) {
+        if (id < 0) return _names.intern(QString());
+        int& n = names[id];
+        if (n < 0) n = _names.intern(dataNames->utf8(id), dataNames->length(id));
+        return n;
+    };
+
+    int partsAdded = 0;
+    foreach(TracePart* tp, data->parts()) {
+        EventTypeMapping* m = tp->eventTypeMapping();
+        int n = m ? m->count() : 0;
+        events.resize(n);
+        for(int i = 0; i < n; i++) {
+            EventType* t = types->realType(m->realIndex(i));
+            events[i] = t ? event(t->name()) : -1;
+        }
+
+        // reference only valid after adding event types
+        Part& p = _parts[part];
+        foreach(TraceFunction* f, functions) {
+            TracePartFunction* pf = (TracePartFunction*) f->findDepFromPart(tp);
+            if (!pf) continue;
+
+            int function = ourId(f->nameId());
+            int object = ourId(f->object()->nameId());
+            int file = ourId(f->file()->nameId());
+
+            // positions may be in other files, e.g. inlined from headers
+            for(FixCost* fc = pf->firstFixCost(); fc; fc = fc->nextCostOfPartFunction()) {
+                int fr = frame(function, object, file,
+                               fc->fromLine(), fc->fromAddr(),
+                               ourId(fc->functionSource()->file()->nameId()));
+                SubCost* c = selfCost(p, fr);
+                for(int i = 0; (i < fc->costCount()) && (i < n); i++)
+                    if (events.at(i) >= 0)
+                        c[events.at(i)] += fc->costs()[i];
+            }
+
+            foreach(TracePartCall* pc, pf->partCallings()) {
+                TraceFunction* called = pc->call()->called(true);
+                int calledFrame = frame(ourId(called->nameId()),
+                                        ourId(called->object()->nameId()),
+                                        ourId(called->file()->nameId()));
+
+                for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                    fcc = fcc->nextCostOfPartCall()) {
+                    int fr = frame(function, object, file,
+                                   fcc->line(), fcc->addr(),
+                                   ourId(fcc->functionSource()->file()->nameId()));
+                    int slot = callSlot(p, fr, calledFrame);
+                    SubCost* c = p.calls.data() + slot * (_stride+1);
+                    for(int i = 0; (i < fcc->costCount()) && (i < n); i++)
+                        if (events.at(i) >= 0)
+                            c[events.at(i)] += fcc->costs()[i];
+                    c[_stride] += fcc->callCount();
+                }
+            }
+        }
+        _samples++;
+        partsAdded++;
+    }
+
+    return partsAdded;
+#else
+    Q_UNUSED(part);
+    Q_UNUSED(data);
+    return 0;
+#endif
+}
+
+int StackSamples::addTo(TraceData* data, const QString& name) const
+{
+#if USE_FIXCOST
+    if (_events.isEmpty() || (_samples == 0)) return 0;
+
+    FixPool* pool = data->fixPool();
+    QString eventNames = _events.join(QLatin1Char(' '));
+    int count = _events.count();
+
+    // IDs in <data> for our names, -1 if not interned yet
+    NameTable* dataNames = data->names();
+    QVector<int> names(_names.count(), -1);
+    auto dataId = [&](int id) {
+        int& n = names[id];
+        if (n < 0) n = dataNames->intern(_names.utf8(id), _names.length(id));
+        return n;
+    };
+
+    // cost items of frames: functions only depend on their own file,
+    // the file of the position gives the function source
+    int frameCount = _frames.count();
+    QVector<TraceObject*> objects(frameCount);
+    QVector<TraceFile*> files(frameCount);
+    QVector<TraceFunction*> functions(frameCount);
+    QVector<TraceFunctionSource*> sources(frameCount);
+    for(int f=0; f<frameCount; f++) {
+        const Frame& fr = _frames.at(f);
+        objects[f] = data->object(dataId(fr.object));
+        files[f] = data->file(dataId(fr.file));
+        functions[f] = data->function(dataId(fr.function), files[f], objects[f]);
+        TraceFile* source = files[f];
+        if (fr.source != fr.file)
+            source = data->file(dataId(fr.source));
+        sources[f] = functions[f]->sourceFile(source, true);
+    }
+
+    QVector<int> order(_parts.count());
+    for(int i=0; i<order.count(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](int i1, int i2) {
+        return _parts.at(i1).key < _parts.at(i2).key;
+    });
+
+    QVector<SubCost> callCost(count + 1);
+    int partsAdded = 0;
+    foreach(int i, order) {
+        const Part& p = _parts.at(i);
+
+        EventTypeMapping* mapping = data->eventTypes()->createMapping(eventNames);
+        if (!mapping) break;
+
+        TracePart* part = new TracePart(data);
+        part->setName(name);
+        part->setEventMapping(mapping);
+        if (p.threadID > 0)
+            part->setThreadID(p.threadID);
+
+        QVector<TracePartFunction*> partFunctions(frameCount, nullptr);
+        auto partFunction = [&](int f) {
+            TracePartFunction*& pf = partFunctions[f];
+            if (!pf)
+                pf = functions.at(f)->partFunction(part,
+                                                   files.at(f)->partFile(part),
+                                                   objects.at(f)->partObject(part));
+            return pf;
+        };
+
+        QHash<int, int>::const_iterator it;
+        for(it = p.selfSlot.constBegin(); it != p.selfSlot.constEnd(); ++it) {
+            const Frame& fr = _frames.at(it.key());
+            PositionSpec pos(fr.line, fr.line, fr.addr, fr.addr);
+            new (pool) FixCost(part, pool, sources.at(it.key()), pos,
+                               partFunction(it.key()),
+                               p.self.constData() + it.value() * _stride, count);
+        }
+
+        QHash<quint64, int>::const_iterator cit;
+        for(cit = p.callSlot.constBegin(); cit != p.callSlot.constEnd(); ++cit) {
+            int caller = cit.key() >> 32;
+            int called = cit.key() & 0xffffffff;
+
+            // call count follows the costs
+            const SubCost* c = p.calls.constData() + cit.value() * (_stride+1);
+            for(int e=0; e<count; e++)
+                callCost[e] = c[e];
+            callCost[count] = c[_stride];
+
+            TraceCall* call = functions.at(caller)->calling(functions.at(called));
+            TracePartCall* partCall = call->partCall(part, partFunction(caller),
+                                                     partFunction(called));
+            const Frame& fr = _frames.at(caller);
+            FixCallCost* fcc;
+            fcc = new (pool) FixCallCost(part, pool, sources.at(caller),
+                                         fr.line, fr.addr, partCall,
+                                         callCost.constData(), count);
+            fcc->setMax(data->callMax());
+            data->updateMaxCallCount(fcc->callCount());
+        }
+
+        part->invalidate();
+        part->totals()->clear();
+        part->totals()->addCost(part);
+        data->addPart(part);
+        partsAdded++;
+    }
+
+    return partsAdded;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(name);
+    return 0;
+#endif
+}
+
+bool StackSamples::parseInChunks(FixFile& file, const char* separator,
+                                 uint64 minSize, StackSamples& samples,
+                                 const ChunkParser& parse,
+                                 const std::function<void(int)>& progress)
+{
+    // chunks need the whole file in memory
+    if (file.isStreaming()) return false;
+
+    int chunks = ParallelJobs::idealThreadCount();
+    if (file.len() / minSize < (uint64) chunks)
+        chunks = file.len() / minSize;
+    if (chunks < 2) return false;
+
+    const char* data = file.data();
+    const char* end = data + file.len();
+    int sepLen = strlen(separator);
+    QVector<uint64> start;
+    start.append(0);
+    for(int i = 1; i < chunks; i++) {
+        uint64 pos = file.len() * i / chunks;
+        if (pos < start.last()) continue;
+        const char* found = nullptr;
+        const char* p = data + pos;
+        while((p = (const char*) memchr(p, separator[0], end - p)) != nullptr) {
+            if ((end - p >= sepLen) && (memcmp(p, separator, sepLen) == 0)) {
+                found = p + sepLen;
+                break;
+            }
+            p++;
+        }
+        if (!found || (found == end)) break;
+        start.append(found - data);
+    }
+    start.append(file.len());
+    int count = start.count() - 1;
+    if (count < 2) return false;
+
+    QVector<StackSamples*> chunkSamples(count);
+    QVector<QAtomicInt> chunkProgress(count);
+    QAtomicInt* done = chunkProgress.data();
+
+    ParallelJobs jobs;
+    for(int i = 0; i < count; i++) {
+        StackSamples* s = new StackSamples;
+        chunkSamples[i] = s;
+
+        const char* chunkData = data + start.at(i);
+        uint64 len = start.at(i+1) - start.at(i);
+        jobs.add([=, &parse]() {
+            FixFile chunk(chunkData, len, QString());
+            parse(i, chunk, *s, [=](int p) { done[i].storeRelease(p); });
+            done[i].storeRelease(100);
+        });
+    }
+
+    jobs.wait([&]() {
+        uint64 parsed = 0;
+        for(int i = 0; i < count; i++)
+            parsed += (start.at(i+1) - start.at(i)) *
+                      done[i].loadAcquire() / 100;
+        progress((int)(100.0 * parsed / file.len() + .5));
+    });
+
+    for(int i = 0; i < count; i++) {
+        samples.merge(*chunkSamples.at(i));
+        delete chunkSamples.at(i);
+    }
+
+    return true;
+}
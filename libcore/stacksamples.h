@@ -0,0 +1,176 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Aggregation of sampled call stacks, for loaders of sampling profilers
+ */
+
+#ifndef STACKSAMPLES_H
+#define STACKSAMPLES_H
+
+#include <functional>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "addr.h"
+#include "subcost.h"
+#include "symboltable.h"
+
+class TraceData;
+class FixFile;
+
+/**
+ * Costs of sampled call stacks, summed up per frame and per call
+ * between frames in hash tables. Memory needed depends on the number
+ * of distinct frames and calls, not on the number of samples.
+ *
+ * A frame is a position in a function (given by line and/or address).
+ * The source file of a position can differ from the file of its
+ * function, e.g. for code inlined from headers.
+ * Self cost of a sample goes to the innermost frame, and the sample
+ * is added as call cost to every caller/called frame pair of its stack.
+ * The call count of a call is the number of samples containing it.
+ *
+ * This does not use any TraceData: multiple threads can fill separate
+ * instances, to be merged afterwards. addTo() creates the cost items.
+ */
+class StackSamples
+{
+public:
+    StackSamples();
+
+    // index of event type <name>, added if new
+    int event(const QString& name);
+    int eventCount() const { return _events.count(); }
+    QStringList events() const { return _events; }
+
+    // names of frames: parsers intern function, object and file here
+    NameTable& names() { return _names; }
+
+    // index of a frame, added if new, with name IDs from names().
+    // Object and file may be the ID of an empty name. <source> is the
+    // file of the position, -1 if it is the file of the function
+    int frame(int function, int object, int file,
+              uint line = 0, Addr addr = Addr(0), int source = -1);
+    int frameCount() const { return _frames.count(); }
+
+    // index of the part with <key> (e.g. a thread ID), added if new.
+    // Parts are created in order of their keys
+    int part(qint64 key, int threadID = 0);
+
+    /**
+     * Add a sample with call stack <frames> (outermost caller first)
+     * and cost <value> for event <event> to part <part>.
+     */
+    void add(int part, const int* frames, int count,
+             int event, SubCost value);
+
+    // add a sample with costs <values> for all events, in event order
+    void add(int part, const int* frames, int count, const SubCost* values);
+
+    // add all samples of <s>, mapping frames, events and parts
+    void merge(const StackSamples& s);
+
+    /**
+     * Add the costs of all parts of <data> to part <part>, e.g. to merge
+     * many profiles without keeping their cost items. Self costs are
+     * added to the frame at the start of their position range, and call
+     * costs to a call from the calling position to the called function.
+     * Returns the number of parts added.
+     */
+    int add(int part, TraceData* data);
+
+    bool isEmpty() const { return _samples == 0; }
+    uint64 samples() const { return _samples; }
+
+    /**
+     * Create cost items for all parts in <data>, with parts named
+     * <name>. Returns the number of parts added.
+     */
+    int addTo(TraceData* data, const QString& name) const;
+
+    // parser for one chunk, called with chunk index, data of chunk,
+    // samples to fill, and callback for progress in percent
+    typedef std::function<void(int, FixFile&, StackSamples&,
+                               const std::function<void(int)>&)> ChunkParser;
+
+    /**
+     * Split <file> into chunks of at least <minSize> bytes, each
+     * starting after an occurrence of <separator>, and run <parse>
+     * on the chunks in worker threads. Results are merged into
+     * <samples> in order. Returns false if the file is not split;
+     * it then needs to be parsed as a whole by the caller.
+     */
+    static bool parseInChunks(FixFile& file, const char* separator,
+                              uint64 minSize, StackSamples& samples,
+                              const ChunkParser& parse,
+                              const std::function<void(int)>& progress);
+
+private:
+    // names are IDs in _names; <file> is the file of the function,
+    // <source> the file of the position
+    struct Frame {
+        int function, object, file, source;
+        uint line;
+        Addr addr;
+
+        bool operator==(const Frame& f) const
+        {
+            return (function == f.function) && (object == f.object) &&
+                   (file == f.file) && (source == f.source) &&
+                   (line == f.line) && (addr == f.addr);
+        }
+        friend uint qHash(const Frame& f, uint seed = 0)
+        {
+            quint64 key[4] = { ((quint64) f.function << 32) | (uint) f.object,
+                               ((quint64) f.file << 32) | (uint) f.source,
+                               f.line, f.addr.value() };
+            return qHashBits(key, sizeof(key), seed);
+        }
+    };
+
+    // costs of one part: <stride> values per slot; for calls,
+    // the sample count follows
+    struct Part {
+        qint64 key;
+        int threadID;
+        QHash<int, int> selfSlot;
+        QHash<quint64, int> callSlot;
+        QVector<SubCost> self, calls;
+        // per call: last sample added to it
+        QVector<uint64> lastSample;
+    };
+
+    void setStride(int stride);
+    SubCost* selfCost(Part& p, int frame);
+    int callSlot(Part& p, int caller, int called);
+
+    QStringList _events;
+    NameTable _names;
+    QVector<Frame> _frames;
+    QHash<Frame, int> _frameIndex;
+    QVector<Part> _parts;
+    QHash<qint64, int> _partIndex;
+    int _stride;
+    uint64 _samples;
+};
+
+#endif // STACKSAMPLES_H
@@ -0,0 +1,161 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Hash tables for names and named items of profile data
+ */
+
+#include "symboltable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <QHash>
+
+
+//
+// NameTable
+//
+
+// names larger than a quarter of this get their own block
+#define NAMETABLE_BLOCKSIZE 65536
+
+NameTable::NameTable()
+{
+    _free = nullptr;
+    _freeLen = 0;
+    rehash(256);
+}
+
+NameTable::~NameTable()
+{
+    clear();
+}
+
+const char* NameTable::store(const char* str, int len)
+{
+    char* res;
+    if (len == 0) return "";
+    if (len > NAMETABLE_BLOCKSIZE/4) {
+        res = (char*) malloc(len);
+        // keep current block for following small names
+        _blocks.prepend(res);
+    }
+    else {
+        if (len > _freeLen) {
+            _free = (char*) malloc(NAMETABLE_BLOCKSIZE);
+            _freeLen = NAMETABLE_BLOCKSIZE;
+            _blocks.append(_free);
+        }
+        res = _free;
+        _free += len;
+        _freeLen -= len;
+    }
+    memcpy(res, str, len);
+    return res;
+}
+
+int NameTable::slot(const char* str, int len, uint hash) const
+{
+    int mask = _slots.size() - 1;
+    int i = hash & mask;
+    while(_slots[i] >= 0) {
+        const Entry& e = _entries[_slots[i]];
+        if ((e.hash == hash) && (e.len == len) &&
+            (memcmp(e.str, str, len) == 0)) break;
+        i = (i+1) & mask;
+    }
+    return i;
+}
+
+void NameTable::rehash(int size)
+{
+    _slots.fill(-1, size);
+    int mask = size - 1;
+    for(int id = 0; id < _entries.size(); id++) {
+        // all names are distinct: just search for a free slot
+        int i = _entries[id].hash & mask;
+        while(_slots[i] >= 0)
+            i = (i+1) & mask;
+        _slots[i] = id;
+    }
+}
+
+int NameTable::intern(const char* str, int len)
+{
+    uint hash = qHashBits(str, len);
+    int i = slot(str, len, hash);
+    if (_slots[i] >= 0) return _slots[i];
+
+    Entry e;
+    e.str = store(str, len);
+    e.len = len;
+    e.hash = hash;
+
+    int id = _entries.size();
+    _entries.append(e);
+    _slots[i] = id;
+    if (2 * _entries.size() > _slots.size())
+        rehash(2 * _slots.size());
+
+    return id;
+}
+
+int NameTable::intern(const QString& name)
+{
+    QByteArray utf8 = name.toUtf8();
+    return intern(utf8.constData(), utf8.size());
+}
+
+int NameTable::find(const QString& name) const
+{
+    QByteArray utf8 = name.toUtf8();
+    uint hash = qHashBits(utf8.constData(), utf8.size());
+    return _slots[slot(utf8.constData(), utf8.size(), hash)];
+}
+
+QString NameTable::name(int id) const
+{
+    const Entry& e = _entries[id];
+    if (e.len == 0) return QString(QLatin1String(""));
+    return QString::fromUtf8(e.str, e.len);
+}
+
+// byte order of UTF-8 is the order of code points
+int NameTable::compare(int id1, int id2) const
+{
+    if (id1 == id2) return 0;
+
+    const Entry& e1 = _entries[id1];
+    const Entry& e2 = _entries[id2];
+    int res = memcmp(e1.str, e2.str, qMin(e1.len, e2.len));
+    if (res != 0) return res;
+    return e1.len - e2.len;
+}
+
+void NameTable::clear()
+{
+    foreach(char* b, _blocks)
+        free(b);
+    _blocks.clear();
+    _free = nullptr;
+    _freeLen = 0;
+
+    _entries.clear();
+    rehash(256);
+}
@@ -0,0 +1,248 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Hash tables for names and named items of profile data
+ */
+
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <algorithm>
+#include <deque>
+
+#include <qlist.h>
+#include <qpair.h>
+#include <qstring.h>
+#include <qvector.h>
+
+
+/**
+ * Interned names: each distinct name is stored once, UTF-8 encoded,
+ * in an arena of large blocks, and gets an ID. IDs are dense, starting
+ * at 0, and never change. QStrings are only created on request, and
+ * are not kept: compare() orders names without decoding them.
+ *
+ * Reading (find(), name(), compare()) does not change the table.
+ */
+class NameTable
+{
+public:
+    NameTable();
+    ~NameTable();
+
+    // returns ID of <name>, adding it if not yet known
+    int intern(const QString& name);
+    int intern(const char* utf8, int len);
+    // returns -1 if <name> is not known
+    int find(const QString& name) const;
+
+    // decoded on each call
+    QString name(int id) const;
+    // <0, 0 or >0 as for strcmp(), in order of Unicode code points
+    int compare(int id1, int id2) const;
+    const char* utf8(int id) const { return _entries[id].str; }
+    int length(int id) const { return _entries[id].len; }
+    int count() const { return _entries.count(); }
+    void clear();
+
+private:
+    Q_DISABLE_COPY(NameTable)
+
+    struct Entry {
+        const char* str;
+        int len;
+        uint hash;
+    };
+
+    int slot(const char*, int len, uint hash) const;
+    void rehash(int size);
+    const char* store(const char*, int len);
+
+    QVector<Entry> _entries;
+    // open addressing: ID per slot, -1 if empty
+    QVector<int> _slots;
+    // arena
+    QVector<char*> _blocks;
+    char* _free;
+    int _freeLen;
+};
+
+
+/**
+ * Key of an item in a TraceItemTable: up to 3 IDs from a NameTable
+ */
+struct TraceItemKey
+{
+    explicit TraceItemKey(int id0, int id1 = -1, int id2 = -1)
+    { id[0] = id0, id[1] = id1, id[2] = id2; }
+
+    bool operator==(const TraceItemKey& k) const
+    { return (id[0] == k.id[0]) && (id[1] == k.id[1]) && (id[2] == k.id[2]); }
+
+    uint hash() const
+    {
+        uint h = (uint) id[0] * 0x9E3779B1u;
+        h = (h ^ (h >> 15) ^ (uint) id[1]) * 0x85EBCA77u;
+        h = (h ^ (h >> 13) ^ (uint) id[2]) * 0xC2B2AE3Du;
+        return h ^ (h >> 16);
+    }
+
+    int id[3];
+};
+
+
+/**
+ * Iterator over items of a TraceItemTable, in order of creation.
+ * Same usage as QMap iterators: "*it" or "it.value()" is the item.
+ */
+template<class Table, class T>
+class TraceItemIterator
+{
+public:
+    TraceItemIterator() { _table = nullptr, _index = 0; }
+    TraceItemIterator(Table* t, int i) { _table = t, _index = i; }
+
+    T& operator*() const { return _table->at(_index); }
+    T* operator->() const { return &(_table->at(_index)); }
+    T& value() const { return _table->at(_index); }
+
+    TraceItemIterator& operator++() { _index++; return *this; }
+    TraceItemIterator operator++(int)
+    { TraceItemIterator it = *this; _index++; return it; }
+    TraceItemIterator& operator--() { _index--; return *this; }
+    TraceItemIterator operator--(int)
+    { TraceItemIterator it = *this; _index--; return it; }
+
+    bool operator==(const TraceItemIterator& it) const
+    { return (_table == it._table) && (_index == it._index); }
+    bool operator!=(const TraceItemIterator& it) const
+    { return !(*this == it); }
+
+private:
+    Table* _table;
+    int _index;
+};
+
+
+/**
+ * Items of type T, found by a TraceItemKey.
+ *
+ * Items are created in place and never move: pointers to them stay
+ * valid until the table is cleared. Lookup uses open addressing with
+ * linear probing on a table kept at most half full.
+ * Iteration is in order of creation, see sortedByName().
+ */
+template<class T>
+class TraceItemTable
+{
+public:
+    typedef TraceItemIterator<TraceItemTable<T>, T> Iterator;
+    typedef TraceItemIterator<const TraceItemTable<T>, const T> ConstIterator;
+    typedef Iterator iterator;
+    typedef ConstIterator const_iterator;
+
+    TraceItemTable() { rehash(64); }
+
+    // returns nullptr if not found
+    T* find(const TraceItemKey& key) const
+    {
+        int i = slot(key, key.hash());
+        return (_slots[i] < 0) ? nullptr : const_cast<T*>(&_items[_slots[i]]);
+    }
+
+    // returns the item with <key>, created if not found
+    T* insert(const TraceItemKey& key, bool* created = nullptr)
+    {
+        uint h = key.hash();
+        int i = slot(key, h);
+        if (created) *created = (_slots[i] < 0);
+        if (_slots[i] >= 0) return &_items[_slots[i]];
+
+        _slots[i] = (int) _items.size();
+        _keys.append(key);
+        _items.emplace_back();
+        if (2 * (int)_items.size() > _slots.size())
+            rehash(2 * _slots.size());
+        return &_items.back();
+    }
+
+    T& at(int i) { return _items[i]; }
+    const T& at(int i) const { return _items[i]; }
+
+    int count() const { return (int) _items.size(); }
+    int size() const { return (int) _items.size(); }
+    bool isEmpty() const { return _items.empty(); }
+
+    void clear()
+    {
+        _items.clear();
+        _keys.clear();
+        rehash(64);
+    }
+
+    Iterator begin() { return Iterator(this, 0); }
+    Iterator end() { return Iterator(this, count()); }
+    ConstIterator begin() const { return ConstIterator(this, 0); }
+    ConstIterator end() const { return ConstIterator(this, count()); }
+    ConstIterator constBegin() const { return begin(); }
+    ConstIterator constEnd() const { return end(); }
+
+    // items ordered by name, for lists shown to the user
+    QList<T*> sortedByName()
+    {
+        typedef QPair<QString, T*> NamedItem;
+        QVector<NamedItem> named;
+        named.reserve(count());
+        for(int i = 0; i < count(); i++)
+            named.append(NamedItem(_items[i].name(), &_items[i]));
+        std::stable_sort(named.begin(), named.end(),
+                         [](const NamedItem& a, const NamedItem& b)
+                         { return a.first < b.first; });
+
+        QList<T*> items;
+        items.reserve(named.count());
+        foreach(const NamedItem& n, named)
+            items.append(n.second);
+        return items;
+    }
+
+private:
+    int slot(const TraceItemKey& key, uint hash) const
+    {
+        int mask = _slots.size() - 1;
+        int i = hash & mask;
+        while((_slots[i] >= 0) && !(_keys[_slots[i]] == key))
+            i = (i+1) & mask;
+        return i;
+    }
+
+    void rehash(int size)
+    {
+        _slots.fill(-1, size);
+        for(int idx = 0; idx < _keys.size(); idx++)
+            _slots[slot(_keys[idx], _keys[idx].hash())] = idx;
+    }
+
+    // std::deque never moves items when growing
+    std::deque<T> _items;
+    QVector<TraceItemKey> _keys;
+    QVector<int> _slots;
+};
+
+#endif // SYMBOLTABLE_H
@@ -0,0 +1,901 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Binary cache of loaded profile data
+ */
+
+#include "tracecache.h"
+
+#include <string.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+
+#include "fixcost.h"
+#include "logger.h"
+
+#define TRACE_CACHE 0
+
+// only profile data files at least this large get a cache
+#define CACHE_MIN_SIZE (16*1024*1024)
+
+// increment on any change of the file layout
+#define CACHE_VERSION 2
+
+static const char cacheMagic[8] = { 'K', 'C', 'G', 'C', 'A', 'C', 'H', 'E' };
+static const quint32 cacheByteOrder = 0x01020304;
+static const quint32 NoIndex = 0xffffffff;
+
+/*
+ * A cache file has a header followed by sections of records.
+ * Each section starts 8-byte aligned. Indexes refer to records of
+ * the section given in the comments. Lists of costs are stored in
+ * the order the items were created when loading the profile data.
+ */
+enum CacheSection {
+    StringData,    // UTF-8 characters of all strings
+    Strings,       // CacheString
+    Objects,       // quint32: string
+    Files,         // quint32: string
+    Functions,     // CacheFunction
+    Sources,       // CacheSource
+    Parts,         // CachePart
+    Columns,       // quint32: string (event types of parts)
+    EventTypes,    // CacheEventType
+    PartFunctions, // CachePartFunction
+    Costs,         // CacheCost
+    Calls,         // CacheCall
+    CallCosts,     // CacheCallCost
+    Jumps,         // CacheJump
+    Values,        // quint64: cost values
+    SectionCount
+};
+
+struct CacheSectionEntry {
+    quint64 offset, count;
+};
+
+struct CacheHeader {
+    char magic[8];
+    quint32 version, byteOrder;
+    quint64 sourceSize;
+    qint64 sourceTime;
+    quint64 size;
+    quint32 command, architecture;
+    CacheSectionEntry section[SectionCount];
+};
+
+struct CacheString {
+    quint64 offset;
+    quint32 len, pad;
+};
+
+// real event types of the trace, and derived ones defined over them
+struct CacheEventType {
+    quint32 name, longName, formula; // formula is NoIndex for real types
+    quint32 pad;
+};
+
+struct CacheFunction {
+    quint32 name, file, object;
+};
+
+struct CacheSource {
+    quint32 function, file;
+};
+
+struct CachePart {
+    quint32 name, description, trigger, timeframe, version;
+    qint32 number, threadID, processID;
+    quint32 firstColumn, columnCount;
+    quint64 firstPartFunction, partFunctionCount;
+};
+
+struct CachePartFunction {
+    quint32 function, file, object; // object may be NoIndex
+    quint32 costCount, jumpCount, callCount;
+    quint64 firstCost, firstJump, firstCall;
+};
+
+struct CacheCost {
+    quint64 fromAddr, toAddr, firstValue;
+    quint32 fromLine, toLine, source, count;
+};
+
+struct CacheCall {
+    // called function, with file/object of its part function
+    quint32 function, file, object;
+    quint32 callCostCount;
+    quint64 firstCallCost;
+};
+
+struct CacheCallCost {
+    quint64 addr, firstValue; // count+1 values, last is call count
+    quint32 line, source, count, pad;
+};
+
+struct CacheJump {
+    quint64 addr, targetAddr, executed, followed;
+    quint32 line, targetLine, source, targetFunction, targetSource;
+    quint32 isCondJump;
+};
+
+static_assert(sizeof(SubCost) == sizeof(quint64),
+              "cost values are written/used directly");
+
+static quint64 align8(quint64 v)
+{
+    return (v + 7) & ~(quint64)7;
+}
+
+
+//
+// CacheWriter
+//
+
+class CacheWriter
+{
+public:
+    explicit CacheWriter(TraceData*);
+
+    void addPart(TracePart*);
+    void addEventTypes();
+    bool write(QIODevice*, const QFileInfo& source);
+
+private:
+    quint32 string(const QString&);
+    quint32 object(TraceObject*);
+    quint32 file(TraceFile*);
+    quint32 function(TraceFunction*);
+    quint32 source(TraceFunctionSource*);
+    quint64 values(const SubCost*, int count);
+
+    TraceData* _data;
+
+    QByteArray _stringData;
+    QHash<QString, quint32> _stringIndex;
+    QVector<CacheString> _strings;
+    QHash<TraceObject*, quint32> _objectIndex;
+    QVector<quint32> _objects;
+    QHash<TraceFile*, quint32> _fileIndex;
+    QVector<quint32> _files;
+    QHash<TraceFunction*, quint32> _functionIndex;
+    QVector<CacheFunction> _functions;
+    QHash<TraceFunctionSource*, quint32> _sourceIndex;
+    QVector<CacheSource> _sources;
+
+    QVector<CachePart> _parts;
+    QVector<quint32> _columns;
+    QVector<CacheEventType> _eventTypes;
+    QVector<CachePartFunction> _partFunctions;
+    QVector<CacheCost> _costs;
+    QVector<CacheCall> _calls;
+    QVector<CacheCallCost> _callCosts;
+    QVector<CacheJump> _jumps;
+
+    // cost values are written from their original place
+    QVector<const SubCost*> _valueArrays;
+    QVector<int> _valueCounts;
+    quint64 _valueCount;
+};
+
+CacheWriter::CacheWriter(TraceData* d)
+{
+    _data = d;
+    _valueCount = 0;
+}
+
+quint32 CacheWriter::string(const QString& s)
+{
+    QHash<QString, quint32>::const_iterator it = _stringIndex.constFind(s);
+    if (it != _stringIndex.constEnd()) return it.value();
+
+    QByteArray utf8 = s.toUtf8();
+    CacheString cs;
+    cs.offset = _stringData.size();
+    cs.len = utf8.size();
+    cs.pad = 0;
+    _stringData.append(utf8);
+
+    quint32 index = _strings.size();
+    _strings.append(cs);
+    _stringIndex.insert(s, index);
+    return index;
+}
+
+quint32 CacheWriter::object(TraceObject* o)
+{
+    if (!o) return NoIndex;
+
+    QHash<TraceObject*, quint32>::const_iterator it = _objectIndex.constFind(o);
+    if (it != _objectIndex.constEnd()) return it.value();
+
+    quint32 index = _objects.size();
+    _objects.append(string(o->name()));
+    _objectIndex.insert(o, index);
+    return index;
+}
+
+quint32 CacheWriter::file(TraceFile* f)
+{
+    QHash<TraceFile*, quint32>::const_iterator it = _fileIndex.constFind(f);
+    if (it != _fileIndex.constEnd()) return it.value();
+
+    quint32 index = _files.size();
+    _files.append(string(f->name()));
+    _fileIndex.insert(f, index);
+    return index;
+}
+
+quint32 CacheWriter::function(TraceFunction* f)
+{
+    QHash<TraceFunction*, quint32>::const_iterator it = _functionIndex.constFind(f);
+    if (it != _functionIndex.constEnd()) return it.value();
+
+    CacheFunction cf;
+    cf.name = string(f->name());
+    cf.file = file(f->file());
+    cf.object = object(f->object());
+
+    quint32 index = _functions.size();
+    _functions.append(cf);
+    _functionIndex.insert(f, index);
+    return index;
+}
+
+quint32 CacheWriter::source(TraceFunctionSource* fs)
+{
+    if (!fs) return NoIndex;
+
+    QHash<TraceFunctionSource*, quint32>::const_iterator it = _sourceIndex.constFind(fs);
+    if (it != _sourceIndex.constEnd()) return it.value();
+
+    CacheSource cs;
+    cs.function = function(fs->function());
+    cs.file = file(fs->file());
+
+    quint32 index = _sources.size();
+    _sources.append(cs);
+    _sourceIndex.insert(fs, index);
+    return index;
+}
+
+quint64 CacheWriter::values(const SubCost* v, int count)
+{
+    quint64 first = _valueCount;
+    _valueArrays.append(v);
+    _valueCounts.append(count);
+    _valueCount += count;
+    return first;
+}
+
+void CacheWriter::addPart(TracePart* p)
+{
+    CachePart cp;
+    cp.name = string(p->name());
+    cp.description = string(p->description());
+    cp.trigger = string(p->trigger());
+    cp.timeframe = string(p->timeframe());
+    cp.version = string(p->version());
+    cp.number = p->partNumber();
+    cp.threadID = p->threadID();
+    cp.processID = p->processID();
+
+    EventTypeMapping* m = p->eventTypeMapping();
+    cp.firstColumn = _columns.size();
+    cp.columnCount = m->count();
+    for(int i=0; i<m->count(); i++)
+        _columns.append(string(_data->eventTypes()->realType(m->realIndex(i))->name()));
+
+    cp.firstPartFunction = _partFunctions.size();
+    cp.partFunctionCount = p->deps().count();
+    _parts.append(cp);
+
+    QVector<FixCost*> costs;
+    QVector<FixJump*> jumps;
+    QVector<FixCallCost*> callCosts;
+    foreach(ProfileCostArray* dep, p->deps()) {
+        TracePartFunction* pf = (TracePartFunction*) dep;
+
+        CachePartFunction cpf;
+        cpf.function = function(pf->function());
+        cpf.file = file(pf->partFile()->file());
+        cpf.object = pf->partObject() ? object(pf->partObject()->object()) : NoIndex;
+
+        // lists are linked with newest item first
+        costs.clear();
+        for(FixCost* fc = pf->firstFixCost(); fc; fc = fc->nextCostOfPartFunction())
+            costs.append(fc);
+        cpf.firstCost = _costs.size();
+        cpf.costCount = costs.count();
+        for(int i = costs.count()-1; i>=0; i--) {
+            FixCost* fc = costs[i];
+            CacheCost cc;
+            cc.fromAddr = fc->fromAddr().value();
+            cc.toAddr = fc->toAddr().value();
+            cc.fromLine = fc->fromLine();
+            cc.toLine = fc->toLine();
+            cc.source = source(fc->functionSource());
+            cc.count = fc->costCount();
+            cc.firstValue = values(fc->costs(), fc->costCount());
+            _costs.append(cc);
+        }
+
+        jumps.clear();
+        for(FixJump* fj = pf->firstFixJump(); fj; fj = fj->nextJumpOfPartFunction())
+            jumps.append(fj);
+        cpf.firstJump = _jumps.size();
+        cpf.jumpCount = jumps.count();
+        for(int i = jumps.count()-1; i>=0; i--) {
+            FixJump* fj = jumps[i];
+            CacheJump cj;
+            cj.addr = fj->addr().value();
+            cj.targetAddr = fj->targetAddr().value();
+            cj.executed = fj->executedCount();
+            cj.followed = fj->followedCount();
+            cj.line = fj->line();
+            cj.targetLine = fj->targetLine();
+            cj.source = source(fj->source());
+            cj.targetFunction = function(fj->targetFunction());
+            cj.targetSource = source(fj->targetSource());
+            cj.isCondJump = fj->isCondJump() ? 1 : 0;
+            _jumps.append(cj);
+        }
+
+        cpf.firstCall = _calls.size();
+        cpf.callCount = pf->partCallings().count();
+        foreach(TracePartCall* pc, pf->partCallings()) {
+            TraceFunction* called = pc->call()->called(true);
+            TracePartFunction* calledPf;
+            calledPf = (TracePartFunction*) called->findDepFromPart(p);
+
+            CacheCall c;
+            c.function = function(called);
+            c.file = file(calledPf->partFile()->file());
+            c.object = calledPf->partObject() ?
+                           object(calledPf->partObject()->object()) : NoIndex;
+
+            callCosts.clear();
+            for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                fcc = fcc->nextCostOfPartCall())
+                callCosts.append(fcc);
+            c.firstCallCost = _callCosts.size();
+            c.callCostCount = callCosts.count();
+            for(int i = callCosts.count()-1; i>=0; i--) {
+                FixCallCost* fcc = callCosts[i];
+                CacheCallCost ccc;
+                ccc.addr = fcc->addr().value();
+                ccc.line = fcc->line();
+                ccc.source = source(fcc->functionSource());
+                ccc.count = fcc->costCount();
+                ccc.pad = 0;
+                ccc.firstValue = values(fcc->costs(), fcc->costCount() + 1);
+                _callCosts.append(ccc);
+            }
+            _calls.append(c);
+        }
+
+        _partFunctions.append(cpf);
+    }
+}
+
+/* Event types with long names and formulas, as given by "event:" lines
+ * of the profile data, but also defaults. Derived types are those which
+ * addKnownDerivedTypes() would add to the set of the trace, but this
+ * works on copies: known types may be used in other threads meanwhile.
+ */
+void CacheWriter::addEventTypes()
+{
+    EventTypeSet* set = _data->eventTypes();
+    EventTypeSet types;
+    for(int i=0; i<set->realCount(); i++)
+        types.addReal(set->realType(i)->name());
+
+    QList<EventType*> derived;
+    for(int i=0; i<EventType::knownTypeCount(); i++) {
+        EventType* t = EventType::knownType(i);
+        if (t && !t->isReal())
+            derived.append(EventType::cloneKnownDerivedType(t->name()));
+    }
+    derived.removeAll(nullptr);
+
+    while(1) {
+        int added = 0;
+        QList<EventType*>::iterator it = derived.begin();
+        while(it != derived.end()) {
+            (*it)->setEventTypeSet(&types);
+            if ((*it)->parseFormula()) {
+                types.add(*it);
+                it = derived.erase(it);
+                added++;
+            }
+            else
+                ++it;
+        }
+        if (added == 0) break;
+    }
+    qDeleteAll(derived);
+
+    for(int i=0; i<types.realCount(); i++) {
+        CacheEventType ct;
+        ct.name = string(types.realType(i)->name());
+        ct.longName = string(types.realType(i)->longName());
+        ct.formula = NoIndex;
+        ct.pad = 0;
+        _eventTypes.append(ct);
+    }
+    for(int i=0; i<types.derivedCount(); i++) {
+        CacheEventType ct;
+        ct.name = string(types.derivedType(i)->name());
+        ct.longName = string(types.derivedType(i)->longName());
+        ct.formula = string(types.derivedType(i)->formula());
+        ct.pad = 0;
+        _eventTypes.append(ct);
+    }
+}
+
+bool CacheWriter::write(QIODevice* out, const QFileInfo& source)
+{
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, cacheMagic, sizeof(h.magic));
+    h.version = CACHE_VERSION;
+    h.byteOrder = cacheByteOrder;
+    h.sourceSize = source.size();
+    h.sourceTime = source.lastModified().toMSecsSinceEpoch();
+    h.command = string(_data->command());
+    h.architecture = _data->architecture();
+
+    // all strings are known now: layout of sections
+    struct { const void* data; quint64 count, size; } sections[SectionCount] = {
+        { _stringData.constData(), (quint64) _stringData.size(), 1 },
+        { _strings.constData(), (quint64) _strings.size(), sizeof(CacheString) },
+        { _objects.constData(), (quint64) _objects.size(), sizeof(quint32) },
+        { _files.constData(), (quint64) _files.size(), sizeof(quint32) },
+        { _functions.constData(), (quint64) _functions.size(), sizeof(CacheFunction) },
+        { _sources.constData(), (quint64) _sources.size(), sizeof(CacheSource) },
+        { _parts.constData(), (quint64) _parts.size(), sizeof(CachePart) },
+        { _columns.constData(), (quint64) _columns.size(), sizeof(quint32) },
+        { _eventTypes.constData(), (quint64) _eventTypes.size(), sizeof(CacheEventType) },
+        { _partFunctions.constData(), (quint64) _partFunctions.size(), sizeof(CachePartFunction) },
+        { _costs.constData(), (quint64) _costs.size(), sizeof(CacheCost) },
+        { _calls.constData(), (quint64) _calls.size(), sizeof(CacheCall) },
+        { _callCosts.constData(), (quint64) _callCosts.size(), sizeof(CacheCallCost) },
+        { _jumps.constData(), (quint64) _jumps.size(), sizeof(CacheJump) },
+        { nullptr, _valueCount, sizeof(quint64) }
+    };
+
+    quint64 offset = align8(sizeof(h));
+    for(int s=0; s<SectionCount; s++) {
+        h.section[s].offset = offset;
+        h.section[s].count = sections[s].count;
+        offset = align8(offset + sections[s].count * sections[s].size);
+    }
+    h.size = offset;
+
+    static const char padding[8] = { 0 };
+    quint64 written = 0;
+    auto append = [&](const void* data, quint64 len) {
+        if (len == 0) return true;
+        if (out->write((const char*) data, len) != (qint64) len) return false;
+        written += len;
+        return true;
+    };
+    auto pad = [&]() {
+        return append(padding, align8(written) - written);
+    };
+
+    if (!append(&h, sizeof(h)) || !pad()) return false;
+    for(int s=0; s<Values; s++)
+        if (!append(sections[s].data, sections[s].count * sections[s].size) || !pad())
+            return false;
+    for(int i=0; i<_valueArrays.size(); i++)
+        if (!append(_valueArrays[i], _valueCounts[i] * sizeof(quint64)))
+            return false;
+
+    return written == h.size;
+}
+
+
+//
+// CacheReader
+//
+
+class CacheReader
+{
+public:
+    CacheReader(TraceData*, const uchar* base, quint64 size);
+
+    bool isValid(const QFileInfo& source);
+    int load();
+
+private:
+    template<class T> const T* records(int s) const
+    { return (const T*)(_base + _header->section[s].offset); }
+    quint64 count(int s) const { return _header->section[s].count; }
+    bool isIndex(quint32 i, int s) const { return i < count(s); }
+    bool isRange(quint64 first, quint64 n, int s) const
+    { return (first <= count(s)) && (n <= count(s) - first); }
+    bool isValidPart(const CachePart&);
+
+    TraceData* _data;
+    const uchar* _base;
+    quint64 _size;
+    const CacheHeader* _header;
+};
+
+CacheReader::CacheReader(TraceData* d, const uchar* base, quint64 size)
+{
+    _data = d;
+    _base = base;
+    _size = size;
+    _header = (const CacheHeader*) base;
+}
+
+bool CacheReader::isValid(const QFileInfo& source)
+{
+    if (_size < sizeof(CacheHeader)) return false;
+
+    const CacheHeader& h = *_header;
+    if ((memcmp(h.magic, cacheMagic, sizeof(h.magic)) != 0) ||
+        (h.version != CACHE_VERSION) ||
+        (h.byteOrder != cacheByteOrder) ||
+        (h.sourceSize != (quint64) source.size()) ||
+        (h.sourceTime != source.lastModified().toMSecsSinceEpoch()) ||
+        (h.size != _size))
+        return false;
+
+    static const quint64 recordSize[SectionCount] = {
+        1, sizeof(CacheString), sizeof(quint32), sizeof(quint32),
+        sizeof(CacheFunction), sizeof(CacheSource), sizeof(CachePart),
+        sizeof(quint32), sizeof(CacheEventType),
+        sizeof(CachePartFunction), sizeof(CacheCost),
+        sizeof(CacheCall), sizeof(CacheCallCost), sizeof(CacheJump),
+        sizeof(quint64)
+    };
+    for(int s=0; s<SectionCount; s++) {
+        quint64 offset = h.section[s].offset;
+        if ((offset % 8) || (offset > _size) ||
+            (h.section[s].count > (_size - offset) / recordSize[s]))
+            return false;
+    }
+
+    // check all references, so loading never goes wrong
+    if (!isIndex(h.command, Strings)) return false;
+
+    const CacheString* strings = records<CacheString>(Strings);
+    for(quint64 i=0; i<count(Strings); i++)
+        if (!isRange(strings[i].offset, strings[i].len, StringData))
+            return false;
+
+    const quint32* names = records<quint32>(Objects);
+    for(quint64 i=0; i<count(Objects); i++)
+        if (!isIndex(names[i], Strings)) return false;
+    names = records<quint32>(Files);
+    for(quint64 i=0; i<count(Files); i++)
+        if (!isIndex(names[i], Strings)) return false;
+    names = records<quint32>(Columns);
+    for(quint64 i=0; i<count(Columns); i++)
+        if (!isIndex(names[i], Strings)) return false;
+
+    const CacheEventType* eventTypes = records<CacheEventType>(EventTypes);
+    for(quint64 i=0; i<count(EventTypes); i++)
+        if (!isIndex(eventTypes[i].name, Strings) ||
+            !isIndex(eventTypes[i].longName, Strings) ||
+            ((eventTypes[i].formula != NoIndex) &&
+             !isIndex(eventTypes[i].formula, Strings)))
+            return false;
+
+    const CacheFunction* functions = records<CacheFunction>(Functions);
+    for(quint64 i=0; i<count(Functions); i++)
+        if (!isIndex(functions[i].name, Strings) ||
+            !isIndex(functions[i].file, Files) ||
+            !isIndex(functions[i].object, Objects))
+            return false;
+
+    const CacheSource* sources = records<CacheSource>(Sources);
+    for(quint64 i=0; i<count(Sources); i++)
+        if (!isIndex(sources[i].function, Functions) ||
+            !isIndex(sources[i].file, Files))
+            return false;
+
+    const CachePart* parts = records<CachePart>(Parts);
+    for(quint64 i=0; i<count(Parts); i++)
+        if (!isValidPart(parts[i])) return false;
+
+    return count(Parts) > 0;
+}
+
+bool CacheReader::isValidPart(const CachePart& p)
+{
+    if (!isIndex(p.name, Strings) || !isIndex(p.description, Strings) ||
+        !isIndex(p.trigger, Strings) || !isIndex(p.timeframe, Strings) ||
+        !isIndex(p.version, Strings) ||
+        !isRange(p.firstColumn, p.columnCount, Columns) ||
+        (p.columnCount > MaxRealIndexValue) ||
+        !isRange(p.firstPartFunction, p.partFunctionCount, PartFunctions))
+        return false;
+
+    const CachePartFunction* pfs = records<CachePartFunction>(PartFunctions);
+    const CacheCost* costs = records<CacheCost>(Costs);
+    const CacheJump* jumps = records<CacheJump>(Jumps);
+    const CacheCall* calls = records<CacheCall>(Calls);
+    const CacheCallCost* callCosts = records<CacheCallCost>(CallCosts);
+
+    for(quint64 i = p.firstPartFunction;
+        i < p.firstPartFunction + p.partFunctionCount; i++) {
+        const CachePartFunction& pf = pfs[i];
+        if (!isIndex(pf.function, Functions) || !isIndex(pf.file, Files) ||
+            ((pf.object != NoIndex) && !isIndex(pf.object, Objects)) ||
+            !isRange(pf.firstCost, pf.costCount, Costs) ||
+            !isRange(pf.firstJump, pf.jumpCount, Jumps) ||
+            !isRange(pf.firstCall, pf.callCount, Calls))
+            return false;
+
+        for(quint64 j = pf.firstCost; j < pf.firstCost + pf.costCount; j++)
+            if (!isIndex(costs[j].source, Sources) ||
+                (costs[j].count > p.columnCount) ||
+                !isRange(costs[j].firstValue, costs[j].count, Values))
+                return false;
+
+        for(quint64 j = pf.firstJump; j < pf.firstJump + pf.jumpCount; j++)
+            if (!isIndex(jumps[j].source, Sources) ||
+                !isIndex(jumps[j].targetFunction, Functions) ||
+                !isIndex(jumps[j].targetSource, Sources))
+                return false;
+
+        for(quint64 j = pf.firstCall; j < pf.firstCall + pf.callCount; j++) {
+            const CacheCall& c = calls[j];
+            if (!isIndex(c.function, Functions) || !isIndex(c.file, Files) ||
+                ((c.object != NoIndex) && !isIndex(c.object, Objects)) ||
+                !isRange(c.firstCallCost, c.callCostCount, CallCosts))
+                return false;
+
+            for(quint64 k = c.firstCallCost;
+                k < c.firstCallCost + c.callCostCount; k++)
+                if (!isIndex(callCosts[k].source, Sources) ||
+                    (callCosts[k].count > p.columnCount) ||
+                    !isRange(callCosts[k].firstValue, callCosts[k].count + 1, Values))
+                    return false;
+        }
+    }
+    return true;
+}
+
+int CacheReader::load()
+{
+    const char* stringData = records<char>(StringData);
+    const CacheString* cs = records<CacheString>(Strings);
+    auto string = [&](quint32 i) {
+        return QString::fromUtf8(stringData + cs[i].offset, cs[i].len);
+    };
+    // names of items are UTF-8 as in the name table: no conversion
+    NameTable* nameTable = _data->names();
+    auto nameId = [&](quint32 i) {
+        return nameTable->intern(stringData + cs[i].offset, cs[i].len);
+    };
+
+    // as "event:" lines: event types of parts get long names from here
+    const CacheEventType* et = records<CacheEventType>(EventTypes);
+    for(quint64 i=0; i<count(EventTypes); i++) {
+        QString formula;
+        if (et[i].formula != NoIndex) formula = string(et[i].formula);
+        EventType::add(new EventType(string(et[i].name),
+                                     string(et[i].longName), formula));
+    }
+
+    const quint32* names = records<quint32>(Objects);
+    QVector<TraceObject*> objects(count(Objects));
+    for(int i=0; i<objects.size(); i++)
+        objects[i] = _data->object(nameId(names[i]));
+
+    names = records<quint32>(Files);
+    QVector<TraceFile*> files(count(Files));
+    for(int i=0; i<files.size(); i++)
+        files[i] = _data->file(nameId(names[i]));
+
+    const CacheFunction* cf = records<CacheFunction>(Functions);
+    QVector<TraceFunction*> functions(count(Functions));
+    for(int i=0; i<functions.size(); i++)
+        functions[i] = _data->function(nameId(cf[i].name),
+                                       files[cf[i].file], objects[cf[i].object]);
+
+    const CacheSource* csrc = records<CacheSource>(Sources);
+    QVector<TraceFunctionSource*> sources(count(Sources));
+    for(int i=0; i<sources.size(); i++)
+        sources[i] = functions[csrc[i].function]->sourceFile(files[csrc[i].file], true);
+
+    const quint32* columns = records<quint32>(Columns);
+    const CachePart* parts = records<CachePart>(Parts);
+    const CachePartFunction* pfs = records<CachePartFunction>(PartFunctions);
+    const CacheCost* costs = records<CacheCost>(Costs);
+    const CacheJump* jumps = records<CacheJump>(Jumps);
+    const CacheCall* calls = records<CacheCall>(Calls);
+    const CacheCallCost* callCosts = records<CacheCallCost>(CallCosts);
+    const SubCost* values = records<SubCost>(Values);
+
+    FixPool* pool = _data->fixPool();
+    for(quint64 i=0; i<count(Parts); i++) {
+        const CachePart& cp = parts[i];
+
+        TracePart* part = new TracePart(_data);
+        part->setName(string(cp.name));
+        part->setDescription(string(cp.description));
+        part->setTrigger(string(cp.trigger));
+        part->setTimeframe(string(cp.timeframe));
+        part->setVersion(string(cp.version));
+        part->setThreadID(cp.threadID);
+        // without process ID, part numbers get assigned in addPart()
+        if (cp.processID != 0) {
+            part->setProcessID(cp.processID);
+            part->setPartNumber(cp.number);
+        }
+
+        QString types;
+        for(quint32 c=0; c<cp.columnCount; c++)
+            types += string(columns[cp.firstColumn + c]) + ' ';
+        part->setEventMapping(_data->eventTypes()->createMapping(types));
+
+        for(quint64 j = cp.firstPartFunction;
+            j < cp.firstPartFunction + cp.partFunctionCount; j++) {
+            const CachePartFunction& cpf = pfs[j];
+
+            TraceFunction* f = functions[cpf.function];
+            TracePartObject* po = nullptr;
+            if (cpf.object != NoIndex)
+                po = objects[cpf.object]->partObject(part);
+            TracePartFunction* pf;
+            pf = f->partFunction(part, files[cpf.file]->partFile(part), po);
+
+            for(quint64 k = cpf.firstCost; k < cpf.firstCost + cpf.costCount; k++) {
+                const CacheCost& c = costs[k];
+                PositionSpec pos(c.fromLine, c.toLine,
+                                 Addr(c.fromAddr), Addr(c.toAddr));
+                new (pool) FixCost(part, pool, sources[c.source], pos, pf,
+                                   values + c.firstValue, c.count);
+            }
+
+            for(quint64 k = cpf.firstJump; k < cpf.firstJump + cpf.jumpCount; k++) {
+                const CacheJump& cj = jumps[k];
+                new (pool) FixJump(part, pool,
+                                   cj.line, Addr(cj.addr),
+                                   pf, sources[cj.source],
+                                   cj.targetLine, Addr(cj.targetAddr),
+                                   functions[cj.targetFunction],
+                                   sources[cj.targetSource],
+                                   cj.isCondJump != 0,
+                                   cj.executed, cj.followed);
+            }
+
+            for(quint64 k = cpf.firstCall; k < cpf.firstCall + cpf.callCount; k++) {
+                const CacheCall& c = calls[k];
+                TraceFunction* called = functions[c.function];
+                TracePartObject* calledPo = nullptr;
+                if (c.object != NoIndex)
+                    calledPo = objects[c.object]->partObject(part);
+                TracePartFunction* calledPf;
+                calledPf = called->partFunction(part, files[c.file]->partFile(part),
+                                                calledPo);
+                TracePartCall* pc = f->calling(called)->partCall(part, pf, calledPf);
+
+                for(quint64 l = c.firstCallCost;
+                    l < c.firstCallCost + c.callCostCount; l++) {
+                    const CacheCallCost& ccc = callCosts[l];
+                    FixCallCost* fcc;
+                    fcc = new (pool) FixCallCost(part, pool, sources[ccc.source],
+                                                 ccc.line, Addr(ccc.addr), pc,
+                                                 values + ccc.firstValue, ccc.count);
+                    fcc->setMax(_data->callMax());
+                    _data->updateMaxCallCount(fcc->callCount());
+                }
+            }
+        }
+
+        part->invalidate();
+        part->totals()->clear();
+        part->totals()->addCost(part);
+        _data->addPart(part);
+    }
+
+    if (!string(_header->command).isEmpty())
+        _data->setCommand(string(_header->command));
+    if (_header->architecture != TraceData::ArchUnknown)
+        _data->setArchitecture((TraceData::Arch) _header->architecture);
+
+    return count(Parts);
+}
+
+
+//
+// TraceCache
+//
+
+QString TraceCache::cacheName(const QString& filename)
+{
+    return filename + QLatin1String(".kcgcache");
+}
+
+bool TraceCache::isCacheName(const QString& filename)
+{
+    return filename.endsWith(QLatin1String(".kcgcache"));
+}
+
+int TraceCache::load(TraceData* data, const QString& filename)
+{
+    QFileInfo source(filename);
+    QFile file(cacheName(filename));
+    if (!source.exists() || !file.exists() ||
+        !file.open(QIODevice::ReadOnly))
+        return 0;
+
+    uchar* base = file.map(0, file.size());
+    if (!base) return 0;
+
+    CacheReader reader(data, base, file.size());
+    int partsLoaded = 0;
+    if (reader.isValid(source)) {
+        Logger* logger = data->logger();
+        if (logger) logger->loadStart(filename);
+        partsLoaded = reader.load();
+        if (logger) logger->loadFinished(QString());
+    }
+    else if (0) qDebug() << "Ignoring outdated cache for" << filename;
+
+    file.unmap(base);
+    return partsLoaded;
+}
+
+bool TraceCache::save(TraceData* data, const TracePartList& parts,
+                      const QString& filename)
+{
+    QFileInfo source(filename);
+    if (parts.isEmpty() || (source.size() < CACHE_MIN_SIZE))
+        return false;
+
+    // check before spending time on collecting the data
+    QFileInfo cache(cacheName(filename));
+    if (!QFileInfo(source.absolutePath()).isWritable() ||
+        (cache.exists() && !cache.isWritable()))
+        return false;
+
+    QSaveFile out(cache.filePath());
+    if (!out.open(QIODevice::WriteOnly)) return false;
+
+    CacheWriter writer(data);
+    foreach(TracePart* part, parts)
+        writer.addPart(part);
+    writer.addEventTypes();
+
+    if (!writer.write(&out, source)) {
+        out.cancelWriting();
+        return false;
+    }
+    if (!out.commit()) return false;
+
+#if TRACE_CACHE
+    qDebug() << "Written cache for" << filename;
+#endif
+
+    return true;
+}
@@ -0,0 +1,59 @@
+/* This file is part of KCachegrind.
+   Copyright (c) 2026 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+
+   KCachegrind is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation, version 2.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+/*
+ * Binary cache of loaded profile data
+ */
+
+#ifndef TRACECACHE_H
+#define TRACECACHE_H
+
+#include <qstring.h>
+
+#include "tracedata.h"
+
+/**
+ * A binary sidecar file "<file>.kcgcache" of a profile data file,
+ * storing all parts loaded from it. It is valid as long as size and
+ * modification time of the profile data file do not change.
+ *
+ * All records have fixed size and alignment: a cache file is mapped
+ * into memory and used directly without any parsing.
+ */
+class TraceCache
+{
+public:
+    static QString cacheName(const QString& filename);
+    static bool isCacheName(const QString& filename);
+
+    /**
+     * Load parts from the cache of profile data file <filename>.
+     * Returns the number of parts loaded, 0 if there is no valid cache.
+     */
+    static int load(TraceData*, const QString& filename);
+
+    /**
+     * Write cache for <parts> just loaded from <filename>.
+     * This is only done for large files, and if the directory of the
+     * file is writable. Returns true if written.
+     */
+    static bool save(TraceData*, const TracePartList& parts,
+                     const QString& filename);
+};
+
+#endif // TRACECACHE_H
@@ -21,17 +21,30 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <algorithm>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
 
 #include <QFile>
+#include <QBuffer>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include "logger.h"
 #include "loader.h"
 #include "globalconfig.h"
 #include "utils.h"
 #include "fixcost.h"
+#include "parallel.h"
+#include "tracecache.h"
+#include "decompressdevice.h"
+#include "pool.h"
 
 
 #define TRACE_DEBUG      0
@@ -136,6 +149,18 @@ void TraceCallCost::addCallCount(SubCost c)
     invalidate();
 }
 
+void TraceCallCost::updateActivation(ProfileCostArray* item, bool active)
+{
+    if (_dirty) return;
+
+    ProfileCostArray::updateActivation(item, active);
+    SubCost c = ((TraceCallCost*) item)->callCount();
+    if (active)
+        _callCount += c;
+    else
+        _callCount -= c;
+}
+
 
 //---------------------------------------------------
 // TraceInclusiveCost
@@ -174,6 +199,85 @@ void TraceInclusiveCost::addInclusive(ProfileCostArray* c)
     invalidate();
 }
 
+void TraceInclusiveCost::updateActivation(ProfileCostArray* item, bool active)
+{
+    if (_dirty) return;
+
+    ProfileCostArray::updateActivation(item, active);
+    _inclusive.addCostDiff(((TraceInclusiveCost*) item)->inclusive(), !active);
+}
+
+
+//---------------------------------------------------
+// Lookup of dependencies by part
+//
+// With many parts (e.g. one dump per time interval), a linear search
+// in the dependency list makes each lookup O(parts). From DEP_INDEX_MIN
+// entries on, a list gets an index sorted by TracePart::index(), which
+// is searched binary. Items usually have cost in a few parts only, so
+// the index is not an array over all parts.
+
+#define DEP_INDEX_MIN 8
+
+template<class T>
+static bool partIndexLessThan(const QPair<int, T*>& entry, int index)
+{
+    return entry.first < index;
+}
+
+template<class T>
+static void addToDepIndex(TraceDepIndex<T>*& index, const QList<T*>& deps,
+                          T* dep)
+{
+    if (!index) {
+        if (deps.count() < DEP_INDEX_MIN) return;
+
+        // create index from all deps, including <dep>
+        index = new TraceDepIndex<T>;
+        index->reserve(deps.count());
+        foreach(T* d, deps)
+            addToDepIndex(index, deps, d);
+        return;
+    }
+
+    TracePart* part = dep->part();
+    if (!part) return;
+    int i = part->index();
+
+    // parts are loaded in order: usually appended
+    if (index->isEmpty() || (index->last().first < i)) {
+        index->append(qMakePair(i, dep));
+        return;
+    }
+
+    typename TraceDepIndex<T>::iterator it;
+    it = std::lower_bound(index->begin(), index->end(), i,
+                          partIndexLessThan<T>);
+    if ((it != index->end()) && (it->first == i))
+        it->second = dep;
+    else
+        index->insert(it, qMakePair(i, dep));
+}
+
+template<class T>
+static T* findDep(TraceDepIndex<T>* index, const QList<T*>& deps,
+                  TracePart* part)
+{
+    if (index && part) {
+        int i = part->index();
+        typename TraceDepIndex<T>::const_iterator it;
+        it = std::lower_bound(index->constBegin(), index->constEnd(), i,
+                              partIndexLessThan<T>);
+        return ((it != index->constEnd()) && (it->first == i)) ?
+                    it->second : nullptr;
+    }
+
+    foreach(T* dep, deps)
+        if (dep->part() == part)
+            return dep;
+    return nullptr;
+}
+
 
 //---------------------------------------------------
 // TraceListCost
@@ -182,10 +286,13 @@ TraceListCost::TraceListCost(ProfileContext* context)
     : ProfileCostArray(context)
 {
     _lastDep = nullptr;
+    _depIndex = nullptr;
 }
 
 TraceListCost::~TraceListCost()
-{}
+{
+    delete _depIndex;
+}
 
 void TraceListCost::addDep(ProfileCostArray* dep)
 {
@@ -198,6 +305,7 @@ void TraceListCost::addDep(ProfileCostArray* dep)
 #endif
 
     _deps.append(dep);
+    addToDepIndex(_depIndex, _deps, dep);
     _lastDep = dep;
     invalidate();
 
@@ -213,13 +321,9 @@ ProfileCostArray* TraceListCost::findDepFromPart(TracePart* part)
     if (_lastDep && _lastDep->part() == part)
         return _lastDep;
 
-    foreach(ProfileCostArray* dep, _deps) {
-        if (dep->part() == part) {
-            _lastDep = dep;
-            return dep;
-        }
-    }
-    return nullptr;
+    ProfileCostArray* dep = findDep(_depIndex, _deps, part);
+    if (dep) _lastDep = dep;
+    return dep;
 }
 
 
@@ -256,10 +360,13 @@ TraceJumpListCost::TraceJumpListCost(ProfileContext* context)
     : TraceJumpCost(context)
 {
     _lastDep = nullptr;
+    _depIndex = nullptr;
 }
 
 TraceJumpListCost::~TraceJumpListCost()
-{}
+{
+    delete _depIndex;
+}
 
 void TraceJumpListCost::addDep(TraceJumpCost* dep)
 {
@@ -272,6 +379,7 @@ void TraceJumpListCost::addDep(TraceJumpCost* dep)
 #endif
 
     _deps.append(dep);
+    addToDepIndex(_depIndex, _deps, dep);
     _lastDep = dep;
     invalidate();
 
@@ -287,13 +395,9 @@ TraceJumpCost* TraceJumpListCost::findDepFromPart(TracePart* part)
     if (_lastDep && _lastDep->part() == part)
         return _lastDep;
 
-    foreach(TraceJumpCost* dep, _deps) {
-        if (dep->part() == part) {
-            _lastDep = dep;
-            return dep;
-        }
-    }
-    return nullptr;
+    TraceJumpCost* dep = findDep(_depIndex, _deps, part);
+    if (dep) _lastDep = dep;
+    return dep;
 }
 
 
@@ -330,10 +434,13 @@ TraceCallListCost::TraceCallListCost(ProfileContext* context)
     : TraceCallCost(context)
 {
     _lastDep = nullptr;
+    _depIndex = nullptr;
 }
 
 TraceCallListCost::~TraceCallListCost()
-{}
+{
+    delete _depIndex;
+}
 
 void TraceCallListCost::addDep(TraceCallCost* dep)
 {
@@ -346,6 +453,7 @@ void TraceCallListCost::addDep(TraceCallCost* dep)
 #endif
 
     _deps.append(dep);
+    addToDepIndex(_depIndex, _deps, dep);
     _lastDep = dep;
     invalidate();
 
@@ -361,13 +469,9 @@ TraceCallCost* TraceCallListCost::findDepFromPart(TracePart* part)
     if (_lastDep && _lastDep->part() == part)
         return _lastDep;
 
-    foreach(TraceCallCost* dep, _deps) {
-        if (dep->part() == part) {
-            _lastDep = dep;
-            return dep;
-        }
-    }
-    return nullptr;
+    TraceCallCost* dep = findDep(_depIndex, _deps, part);
+    if (dep) _lastDep = dep;
+    return dep;
 }
 
 
@@ -408,10 +512,13 @@ TraceInclusiveListCost::TraceInclusiveListCost(ProfileContext* context)
     : TraceInclusiveCost(context)
 {
     _lastDep = nullptr;
+    _depIndex = nullptr;
 }
 
 TraceInclusiveListCost::~TraceInclusiveListCost()
-{}
+{
+    delete _depIndex;
+}
 
 
 void TraceInclusiveListCost::addDep(TraceInclusiveCost* dep)
@@ -425,6 +532,7 @@ void TraceInclusiveListCost::addDep(TraceInclusiveCost* dep)
 #endif
 
     _deps.append(dep);
+    addToDepIndex(_depIndex, _deps, dep);
     _lastDep = dep;
     invalidate();
 
@@ -440,13 +548,9 @@ TraceInclusiveCost* TraceInclusiveListCost::findDepFromPart(TracePart* part)
     if (_lastDep && _lastDep->part() == part)
         return _lastDep;
 
-    foreach(TraceInclusiveCost* dep, _deps) {
-        if (dep->part() == part) {
-            _lastDep = dep;
-            return dep;
-        }
-    }
-    return nullptr;
+    TraceInclusiveCost* dep = findDep(_depIndex, _deps, part);
+    if (dep) _lastDep = dep;
+    return dep;
 }
 
 void TraceInclusiveListCost::update()
@@ -1181,14 +1285,18 @@ TraceLineCall* TraceCall::lineCall(TraceLine* l)
 
 
 void TraceCall::invalidateDynamicCost()
+{
+    invalidateDetails();
+    invalidate();
+}
+
+void TraceCall::invalidateDetails()
 {
     foreach(TraceLineCall* lc, _lineCalls)
         lc->invalidate();
 
     foreach(TraceInstrCall* ic, _instrCalls)
         ic->invalidate();
-
-    invalidate();
 }
 
 
@@ -1494,11 +1602,27 @@ QString TraceLine::prettyName() const
 TraceCostItem::TraceCostItem(ProfileContext* context)
     : TraceInclusiveListCost(context)
 {
+    _nameId = -1;
 }
 
 TraceCostItem::~TraceCostItem()
 {}
 
+QString TraceCostItem::name() const
+{
+    const TraceData* d = data();
+    if (!d || (_nameId < 0)) return QString();
+
+    return d->names()->name(_nameId);
+}
+
+// position (i.e. TraceData) has to be set before
+void TraceCostItem::setName(const QString& name)
+{
+    TraceData* d = data();
+    _nameId = d ? d->names()->intern(name) : -1;
+}
+
 
 //---------------------------------------------------
 // TraceFunctionSource
@@ -1798,6 +1922,8 @@ TraceFunction::TraceFunction()
     _file = nullptr;
     _cls = nullptr;
     _cycle = nullptr;
+    _index = -1;
+    _callingIndex = nullptr;
 
     _calledCount     = 0;
     _callingCount    = 0;
@@ -1818,6 +1944,7 @@ TraceFunction::~TraceFunction()
     qDeleteAll(_callings);
     qDeleteAll(_sourceFiles);
 
+    delete _callingIndex;
     delete _instrMap;
 }
 
@@ -1888,26 +2015,27 @@ bool TraceFunction::isUniquePrefix(const QString& prefix) const
 
 QString TraceFunction::prettyName() const
 {
-    QString res = _name;
+    const QString n = name();
+    QString res = n;
 
-    if (_name.isEmpty())
+    if (n.isEmpty())
         return prettyEmptyName();
 
     if (GlobalConfig::hideTemplates()) {
 
         res = QString();
         int d = 0;
-        for(int i=0;i<_name.length();i++) {
-            switch(_name[i].toLatin1()) {
+        for(int i=0;i<n.length();i++) {
+            switch(n[i].toLatin1()) {
             case '<':
-                if (d<=0) res.append(_name[i]);
+                if (d<=0) res.append(n[i]);
                 d++;
                 break;
             case '>':
                 d--;
                 // fall through
             default:
-                if (d<=0) res.append(_name[i]);
+                if (d<=0) res.append(n[i]);
                 break;
             }
         }
@@ -1919,15 +2047,15 @@ QString TraceFunction::prettyName() const
     // if the function name is unique in the whole program.
     // However, we only can detect if it is unique in the profile,
     // which makes this "beautification" potentially confusing
-    int p = _name.indexOf('(');
+    int p = n.indexOf('(');
     if (p>0) {
         // handle C++ "operator()" correct
-        if ( (p+2 < _name.size()) && (_name[p+1] == ')') && (_name[p+2] == '(')) p+=2;
+        if ( (p+2 < n.size()) && (n[p+1] == ')') && (n[p+2] == '(')) p+=2;
 
         // we have a C++ symbol with argument types:
         // check for unique function name (inclusive '(' !)
-        if (isUniquePrefix(_name.left(p+1)))
-            res = _name.left(p);
+        if (isUniquePrefix(n.left(p+1)))
+            res = n.left(p);
     }
 #endif
 
@@ -1945,14 +2073,15 @@ QString TraceFunction::prettyName() const
 
 QString TraceFunction::formattedName() const
 {
+    const QString n = name();
     // produce a "rich" name only if templates are hidden
-    if (!GlobalConfig::hideTemplates() || _name.isEmpty()) return QString();
+    if (!GlobalConfig::hideTemplates() || n.isEmpty()) return QString();
 
     // bold, but inside template parameters normal, function arguments italic
     QString rich(QStringLiteral("<b>"));
     int d = 0;
-    for(int i=0;i<_name.length();i++) {
-        switch(_name[i].toLatin1()) {
+    for(int i=0;i<n.length();i++) {
+        switch(n[i].toLatin1()) {
         case '&':
             rich.append("&amp;");
             break;
@@ -1975,7 +2104,7 @@ QString TraceFunction::formattedName() const
             rich.append("</b></i>)<b>");
             break;
         default:
-            rich.append(_name[i]);
+            rich.append(n[i]);
             break;
         }
     }
@@ -2147,15 +2276,33 @@ void TraceFunction::addCaller(TraceCall* caller)
 
 
 
+// a linear search is faster for few calls
+#define CALLING_INDEX_MIN 16
+
 TraceCall* TraceFunction::calling(TraceFunction* called)
 {
-    foreach(TraceCall* calling, _callings)
-        if (calling->called() == called)
-            return calling;
+    if (_callingIndex) {
+        TraceCall* calling = _callingIndex->value(called);
+        if (calling) return calling;
+    }
+    else {
+        foreach(TraceCall* calling, _callings)
+            if (calling->called(true) == called)
+                return calling;
+    }
 
     TraceCall* calling = new TraceCall(this, called);
     _callings.append(calling);
 
+    if (_callingIndex)
+        _callingIndex->insert(called, calling);
+    else if (_callings.count() >= CALLING_INDEX_MIN) {
+        _callingIndex = new QHash<TraceFunction*, TraceCall*>;
+        _callingIndex->reserve(2 * CALLING_INDEX_MIN);
+        foreach(TraceCall* c, _callings)
+            _callingIndex->insert(c->called(true), c);
+    }
+
     // we have to invalidate ourself so invalidations from item propagate up
     invalidate();
 
@@ -2322,21 +2469,41 @@ void TraceFunction::invalidateDynamicCost()
     invalidate();
 }
 
-void TraceFunction::update()
+void TraceFunction::updatePartActivation(TracePartFunction* pf, bool active)
 {
-    if (!_dirty) return;
+    bool valid = !_dirty;
 
-#if TRACE_DEBUG
-    qDebug("Update %s (Callers %d, sourceFiles %d, instrs %d)",
-           qPrintable(_name), _callers.count(),
-           _sourceFiles.count(), _instrMap ? _instrMap->count():0);
-#endif
+    foreach(TraceCall* c, _callings)
+        c->invalidateDetails();
+
+    foreach(TraceFunctionSource* sf, _sourceFiles)
+        sf->invalidateDynamicCost();
 
+    if (_instrMap) {
+        TraceInstrMap::Iterator iit;
+        for ( iit = _instrMap->begin();
+              iit != _instrMap->end(); ++iit )
+            (*iit).invalidate();
+    }
+
+    // calls have no dependent: they can be valid even if we are not
+    foreach(TracePartCall* pc, pf->partCallings())
+        pc->call()->updateActivation(pc, active);
+
+    // function sources propagate invalidation to us, but our own
+    // cost is updated incrementally
+    if (!valid) return;
+    _dirty = false;
+
+    updateActivation(pf, active);
+}
+
+void TraceFunction::updateCallCounts()
+{
     _calledCount    = 0;
     _callingCount    = 0;
     _calledContexts  = 0;
     _callingContexts = 0;
-    clear();
 
     // To calculate context counts, we just use first real event type (FIXME?)
     EventType* e = data() ? data()->eventTypes()->realType(0) : nullptr;
@@ -2353,6 +2520,20 @@ void TraceFunction::update()
             _callingContexts++;
         _callingCount += callee->callCount();
     }
+}
+
+void TraceFunction::update()
+{
+    if (!_dirty) return;
+
+#if TRACE_DEBUG
+    qDebug("Update %s (Callers %d, sourceFiles %d, instrs %d)",
+           qPrintable(name()), _callers.count(),
+           _sourceFiles.count(), _instrMap ? _instrMap->count():0);
+#endif
+
+    clear();
+    updateCallCounts();
 
     if (data()->inFunctionCycleUpdate() || !_cycle) {
         // usual case (no cycle member)
@@ -2412,112 +2593,8 @@ bool TraceFunction::isCycleMember()
 void TraceFunction::cycleReset()
 {
     _cycle = nullptr;
-    _cycleStackDown = nullptr;
-    _cycleLow = 0;
 }
 
-// this does not mark functions calling themself !
-void TraceFunction::cycleDFS(int d, int& pNo, TraceFunction** pTop)
-{
-    if (_cycleLow != 0) return;
-
-    // initialize with prefix order
-    pNo++;
-    int prefixNo = pNo;
-    _cycleLow = prefixNo;
-
-    // put myself on stack
-    _cycleStackDown = *pTop;
-    *pTop = this;
-
-    /* cycle cut heuristic:
-     * skip calls for cycle detection if they make less than _cycleCut
-     * percent of the cost of the function.
-     * FIXME: Which cost type to use for this heuristic ?!
-     */
-    Q_ASSERT((data() != nullptr) && (data()->eventTypes()->realCount()>0));
-    EventType* e = data()->eventTypes()->realType(0);
-
-    SubCost base = 0;
-    if (_callers.count()>0) {
-        foreach(TraceCall* caller, _callers)
-            if (caller->subCost(e) > base)
-                base = caller->subCost(e);
-    }
-    else base = inclusive()->subCost(e);
-
-    SubCost cutLimit = SubCost(base * GlobalConfig::cycleCut());
-
-    if (0) {
-        qDebug("%s (%d) Visiting %s",
-               qPrintable(QString().fill(' ', d)),
-               pNo, qPrintable(prettyName()));
-        qDebug("%s       Cum. %s, Max Caller %s, cut limit %s",
-               qPrintable(QString().fill(' ', d)),
-               qPrintable(inclusive()->subCost(e).pretty()),
-               qPrintable(base.pretty()),
-               qPrintable(cutLimit.pretty()));
-    }
-
-    foreach(TraceCall *callee, _callings) {
-        TraceFunction* called = callee->called();
-
-        // cycle cut heuristic
-        if (callee->subCost(e) < cutLimit) {
-            if (0) qDebug("%s       Cut call to %s (cum. %s)",
-                          qPrintable(QString().fill(' ', d)),
-                          qPrintable(called->prettyName()),
-                          qPrintable(callee->subCost(e).pretty()));
-
-            continue;
-        }
-
-        if (called->_cycleLow==0) {
-            // not visited yet
-            called->cycleDFS(d+1, pNo, pTop);
-            if (called->_cycleLow < _cycleLow)
-                _cycleLow = called->_cycleLow;
-        }
-        else if (called->_cycleStackDown) {
-            // backlink to same SCC (still in stack)
-            if (called->_cycleLow < _cycleLow)
-                _cycleLow = called->_cycleLow;
-
-            if (0) qDebug("%s (low %d) Back to %s",
-                          qPrintable(QString().fill(' ', d)),
-                          _cycleLow, qPrintable(called->prettyName()));
-        }
-    }
-
-    if (prefixNo == _cycleLow) {
-        // this is the base of a SCC.
-
-        if (*pTop == this) {
-            *pTop = _cycleStackDown;
-            _cycleStackDown = nullptr;
-        }
-        else {
-            // a SCC with >1 members
-
-            TraceFunctionCycle* cycle = data()->functionCycle(this);
-            if (0) qDebug("Found Cycle %d with base %s:",
-                          cycle->cycleNo(), qPrintable(prettyName()));
-            while(*pTop) {
-                TraceFunction* top = *pTop;
-                cycle->add(top);
-
-                // remove from stack
-                *pTop = top->_cycleStackDown;
-                top->_cycleStackDown = nullptr;
-
-                if (0) qDebug("  %s", qPrintable(top->prettyName()));
-                if (top == this) break;
-            }
-        }
-    }
-}
-
-
 TraceInstrMap* TraceFunction::instrMap()
 {
 #if USE_FIXCOST
@@ -2661,6 +2738,8 @@ void TraceFunctionCycle::init()
     _callers.clear();
     // this deletes all TraceCall's to members
     _callings.clear();
+    delete _callingIndex;
+    _callingIndex = nullptr;
 
     invalidate();
 }
@@ -2709,9 +2788,10 @@ TraceClass::~TraceClass()
 
 QString TraceClass::prettyName() const
 {
-    if (_name.isEmpty())
+    const QString n = name();
+    if (n.isEmpty())
         return prettyEmptyName();
-    return _name;
+    return n;
 }
 
 QString TraceClass::prettyEmptyName()
@@ -2759,7 +2839,9 @@ void TraceClass::addFunction(TraceFunction* function)
 
 TraceFile::TraceFile()
     : TraceCostItem(ProfileContext::context(ProfileContext::File))
-{}
+{
+    _shortNameId = -1;
+}
 
 TraceFile::~TraceFile()
 {
@@ -2835,24 +2917,26 @@ QString TraceFile::directory()
 {
     if (!_dir.isEmpty()) return _dir;
 
+    const QString n = name();
     int lastIndex = 0, index;
-    while ( (index=_name.indexOf(QLatin1Char('/'), lastIndex)) >=0)
+    while ( (index=n.indexOf(QLatin1Char('/'), lastIndex)) >=0)
         lastIndex = index+1;
 
     if (lastIndex==0) return QString();
 
     // without ending "/"
-    return _name.left(lastIndex-1);
+    return n.left(lastIndex-1);
 }
 
 
 QString TraceFile::shortName() const
 {
+    const QString n = name();
     int lastIndex = 0, index;
-    while ( (index=_name.indexOf(QLatin1Char('/'), lastIndex)) >=0)
+    while ( (index=n.indexOf(QLatin1Char('/'), lastIndex)) >=0)
         lastIndex = index+1;
 
-    return _name.mid(lastIndex);
+    return n.mid(lastIndex);
 }
 
 QString TraceFile::prettyName() const
@@ -2872,9 +2956,10 @@ QString TraceFile::prettyEmptyName()
 
 QString TraceFile::prettyLongName() const
 {
-    if (_name.isEmpty())
+    const QString n = name();
+    if (n.isEmpty())
         return prettyEmptyName();
-    return _name;
+    return n;
 }
 
 
@@ -2883,7 +2968,9 @@ QString TraceFile::prettyLongName() const
 
 TraceObject::TraceObject()
     : TraceCostItem(ProfileContext::context(ProfileContext::Object))
-{}
+{
+    _shortNameId = -1;
+}
 
 TraceObject::~TraceObject()
 {
@@ -2936,24 +3023,26 @@ QString TraceObject::directory()
 {
     if (!_dir.isEmpty()) return _dir;
 
+    const QString n = name();
     int lastIndex = 0, index;
-    while ( (index=_name.indexOf(QLatin1Char('/'), lastIndex)) >=0)
+    while ( (index=n.indexOf(QLatin1Char('/'), lastIndex)) >=0)
         lastIndex = index+1;
 
     if (lastIndex==0) return QString();
 
     // without ending "/"
-    return _name.left(lastIndex-1);
+    return n.left(lastIndex-1);
 }
 
 
 QString TraceObject::shortName() const
 {
+    const QString n = name();
     int lastIndex = 0, index;
-    while ( (index=_name.indexOf(QLatin1Char('/'), lastIndex)) >=0)
+    while ( (index=n.indexOf(QLatin1Char('/'), lastIndex)) >=0)
         lastIndex = index+1;
 
-    return _name.mid(lastIndex);
+    return n.mid(lastIndex);
 }
 
 QString TraceObject::prettyName() const
@@ -2982,6 +3071,7 @@ TracePart::TracePart(TraceData* data)
     _dep = data;
     _active = true;
     _number = 0;
+    _index = data->newPartIndex();
     _tid = 0;
     _pid = 0;
 
@@ -3078,6 +3168,8 @@ void TraceData::init()
 
     _maxThreadID = 0;
     _maxPartNumber = 0;
+    _partIndexCount = 0;
+    _writeCache = true;
     _fixPool = nullptr;
     _dynPool = nullptr;
 
@@ -3133,6 +3225,10 @@ int TraceData::load(QStringList files)
 {
     if (files.isEmpty()) return 0;
 
+    QElapsedTimer timer;
+    timer.start();
+    _loadStats = LoadStats();
+
     _traceName = files[0];
     if (files.count() == 1) {
         QFileInfo finfo(_traceName);
@@ -3143,10 +3239,16 @@ int TraceData::load(QStringList files)
             _traceName += QLatin1String("/callgrind.out");
         }
 
+        _followPrefix = dir.path() + '/' + prefix;
         files = dir.entryList(QStringList() << prefix + '*', QDir::Files);
         QStringList::Iterator it = files.begin();
-        for (; it != files.end(); ++it ) {
+        while (it != files.end()) {
+            if (TraceCache::isCacheName(*it)) {
+                it = files.erase(it);
+                continue;
+            }
             *it = dir.path() + '/' + *it;
+            ++it;
         }
     }
 
@@ -3155,17 +3257,20 @@ int TraceData::load(QStringList files)
         return 0;
     }
 
-    QStringList::const_iterator it;
     int partsLoaded = 0;
-    for (it = files.constBegin(); it != files.constEnd(); ++it ) {
-        QFile file(*it);
-        partsLoaded += internalLoad(&file, *it);
+    if ((files.count() > 1) && (ParallelJobs::idealThreadCount() > 1))
+        partsLoaded = parallelLoad(files);
+    else {
+        QStringList::const_iterator it;
+        for (it = files.constBegin(); it != files.constEnd(); ++it ) {
+            QFile file(*it);
+            partsLoaded += internalLoad(&file, *it);
+        }
     }
     if (partsLoaded == 0) return 0;
 
     std::sort(_parts.begin(), _parts.end(), partLessThan);
-    invalidateDynamicCost();
-    updateFunctionCycles();
+    finishLoad(timer);
 
     return partsLoaded;
 }
@@ -3177,22 +3282,102 @@ int TraceData::load(QString file)
 
 int TraceData::load(QIODevice* file, const QString& filename)
 {
+    QElapsedTimer timer;
+    timer.start();
+    _loadStats = LoadStats();
+
     _traceName = filename;
     int partsLoaded = internalLoad(file, filename);
-    if (partsLoaded>0) {
-        invalidateDynamicCost();
-        updateFunctionCycles();
-    }
+    if (partsLoaded>0)
+        finishLoad(timer);
     return partsLoaded;
 }
 
+// peak resident set size of this process in bytes, 0 if unknown
+static qint64 peakRSS()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss;
+#else
+    return (qint64) usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/* Updates after loading, timed as phases after parsing (which started
+ * with <timer>), and report of load statistics.
+ */
+void TraceData::finishLoad(QElapsedTimer& timer)
+{
+    _loadStats.phases.append(qMakePair(QStringLiteral("parse"),
+                                       timer.nsecsElapsed() / 1000000.0));
+    timer.restart();
+    invalidateDynamicCost();
+    _loadStats.phases.append(qMakePair(QStringLiteral("invalidate"),
+                                       timer.nsecsElapsed() / 1000000.0));
+    timer.restart();
+    updateFunctionCycles();
+    _loadStats.phases.append(qMakePair(QStringLiteral("cycles"),
+                                       timer.nsecsElapsed() / 1000000.0));
+
+    _loadStats.name = _traceName;
+    _loadStats.parts = _parts.count();
+    _loadStats.functions = _functionMap.count();
+    _loadStats.calls = 0;
+    TraceFunctionMap::Iterator it;
+    for ( it = _functionMap.begin(); it != _functionMap.end(); ++it )
+        _loadStats.calls += (*it).callings().count();
+    if (_fixPool) {
+        _loadStats.poolObjects = _fixPool->objects();
+        _loadStats.poolBytes = _fixPool->bytes();
+        _loadStats.poolChunks = _fixPool->chunks();
+    }
+    _loadStats.peakRSS = peakRSS();
+
+    if (_logger) _logger->loadStats(_loadStats);
+}
+
 int TraceData::internalLoad(QIODevice* device, const QString& filename)
 {
+#if USE_FIXCOST
+    // a valid cache of a file is much faster to load than parsing it
+    QFile* file = qobject_cast<QFile*>(device);
+    if (file) {
+        // for follow mode: data appended later is loaded separately
+        _loadedSizes[file->fileName()] = file->size();
+
+        int partsLoaded = TraceCache::load(this, file->fileName());
+        if (partsLoaded > 0) return partsLoaded;
+    }
+#endif
+
     if (!device->open( QIODevice::ReadOnly ) ) {
         _logger->loadStart(filename);
         _logger->loadFinished(QString::fromLocal8Bit(strerror( errno )));
         return 0;
     }
+    if (!device->isSequential())
+        _loadStats.bytes += device->size();
+
+    // compressed data is decompressed on the fly
+    QIODevice* source = device;
+    DecompressDevice::Format format = DecompressDevice::detect(device);
+    DecompressDevice decompressed(source, format);
+    if (format != DecompressDevice::None) {
+        if (!DecompressDevice::isSupported(format) ||
+            !decompressed.open(QIODevice::ReadOnly)) {
+            _logger->loadStart(filename);
+            _logger->loadFinished(QObject::tr("Unsupported compression: %1")
+                                  .arg(DecompressDevice::formatName(format)));
+            return 0;
+        }
+        device = &decompressed;
+    }
 
     Loader* l = Loader::matchingLoader(device);
     if (!l) {
@@ -3203,50 +3388,535 @@ int TraceData::internalLoad(QIODevice* device, const QString& filename)
         _logger->loadFinished(QStringLiteral("Unknown file format"));
         return 0;
     }
-    l->setLogger(_logger);
-
+    // loaders are shared between threads: they take the logger from us
+    int oldCount = _parts.count();
     int partsLoaded = l->load(this, device, filename);
 
-    l->setLogger(nullptr);
+    // loaders close the device given to them
+    if (device != source) source->close();
+
+    if (!decompressed.errorMessage().isEmpty()) {
+        // data up to the error was loaded: warn, but keep it
+        _logger->loadError(0, decompressed.errorMessage());
+#if USE_FIXCOST
+        file = nullptr; // no cache for incomplete data
+#endif
+    }
+
+#if USE_FIXCOST
+    if (file && (partsLoaded > 0) && _writeCache && GlobalConfig::writeCache())
+        TraceCache::save(this, _parts.mid(oldCount), file->fileName());
+#endif
 
     return partsLoaded;
 }
 
-bool TraceData::activateParts(const TracePartList& l)
+/**
+ * Load multiple files in parallel, each one into a separate TraceData
+ * in a worker thread. Results are merged in order of <files>, giving
+ * the same trace as loading sequentially.
+ *
+ * Workers cannot use our logger: progress is summed up and reported
+ * from this thread. Other notifications of a file are forwarded when it
+ * is merged, in between notifications for the whole trace.
+ */
+int TraceData::parallelLoad(const QStringList& files)
 {
-    bool changed = false;
+#if USE_FIXCOST
+    int count = files.count();
+    QVector<TraceData*> traces(count, nullptr);
+    QVector<LogBuffer*> logs(count);
+    QVector<QAtomicInt> done(count);
+
+    TraceData** trace = traces.data();
+    QAtomicInt* finished = done.data();
+    for(int i=0; i<count; i++)
+        logs[i] = new LogBuffer;
+
+    if (_logger) _logger->loadStart(_traceName);
+
+    ParallelJobs jobs;
+    for(int i=0; i<count; i++) {
+        QString filename = files.at(i);
+        LogBuffer* log = logs[i];
+        _loadedSizes[filename] = QFileInfo(filename).size();
+        bool writeCache = _writeCache;
+        jobs.add([=]() {
+            TraceData* d = new TraceData(log);
+            d->setWriteCache(writeCache);
+            QFile file(filename);
+            d->internalLoad(&file, filename);
+            trace[i] = d;
+            finished[i].storeRelease(1);
+        });
+    }
 
-    foreach(TracePart* part, _parts)
-        if (part->activate(l.contains(part)))
-            changed = true;
+    int partsLoaded = 0, merged = 0;
+    jobs.wait([&]() {
+        while((merged < count) && finished[merged].loadAcquire()) {
+            partsLoaded += mergeParts(trace[merged]);
+            delete trace[merged];
+
+            // messages refer to the file, not the whole trace
+            logs[merged]->forward(_logger);
+            if (_logger) _logger->loadStart(_traceName);
+            merged++;
+        }
+        if (!_logger || (merged == count)) return;
 
-    if (changed) {
-        // because active parts have changed, throw away calculated
-        // costs...
+        int progress = 100 * merged;
+        for(int i = merged; i<count; i++)
+            progress += logs[i]->progress();
+        _logger->loadProgress(progress / count);
+    });
+
+    if (_logger) _logger->loadFinished(QString());
+    qDeleteAll(logs);
+
+    return partsLoaded;
+#else
+    int partsLoaded = 0;
+    foreach(const QString& filename, files) {
+        QFile file(filename);
+        partsLoaded += internalLoad(&file, filename);
+    }
+    return partsLoaded;
+#endif
+}
+
+int TraceData::loadNewParts()
+{
+    // current sizes of grown and new files
+    QHash<QString, qint64> changed;
+
+    QHash<QString, qint64>::const_iterator it;
+    for(it = _loadedSizes.constBegin(); it != _loadedSizes.constEnd(); ++it) {
+        qint64 size = QFileInfo(it.key()).size();
+        if (size > it.value())
+            changed.insert(it.key(), size);
+    }
+
+    if (!_followPrefix.isEmpty()) {
+        QFileInfo finfo(_followPrefix);
+        QDir dir = finfo.dir();
+        QStringList files = dir.entryList(QStringList() << finfo.fileName() + '*',
+                                          QDir::Files);
+        foreach(const QString& name, files) {
+            if (TraceCache::isCacheName(name)) continue;
+            QString path = dir.path() + '/' + name;
+            if (!_loadedSizes.contains(path))
+                changed.insert(path, QFileInfo(path).size());
+        }
+    }
+
+    int oldCount = _parts.count();
+    QHash<QString, qint64> pending;
+    for(it = changed.constBegin(); it != changed.constEnd(); ++it) {
+        // still written to?
+        if (_pendingSizes.value(it.key(), -1) != it.value()) {
+            pending.insert(it.key(), it.value());
+            continue;
+        }
+
+        qint64 offset = _loadedSizes.value(it.key(), 0);
+        if (offset > 0)
+            _loadedSizes[it.key()] = loadAppended(it.key(), offset, it.value());
+        else {
+            // also records the loaded size
+            QFile file(it.key());
+            internalLoad(&file, it.key());
+        }
+    }
+    _pendingSizes = pending;
+
+    if (_parts.count() == oldCount) return 0;
+
+    TracePartList added = _parts.mid(oldCount);
+    std::sort(_parts.begin(), _parts.end(), partLessThan);
+    invalidateNewParts(added);
+
+    return added.count();
+}
+
+QString TraceData::followDirectory() const
+{
+    if (_followPrefix.isEmpty()) return QString();
+    return QFileInfo(_followPrefix).path();
+}
+
+// lines only found in the header of a callgrind dump
+static bool isDumpHeaderLine(const char* s, int len)
+{
+    static const char* const keys[] = {
+        "# callgrind format", "version:", "creator:", "pid:", "cmd:",
+        "part:", "thread:", "desc:", "positions:", "events:", nullptr
+    };
+    for(int i = 0; keys[i]; i++) {
+        int klen = qstrlen(keys[i]);
+        if ((len >= klen) && (qstrncmp(s, keys[i], klen) == 0))
+            return true;
+    }
+    return false;
+}
+
+// start of first line in <data> from <pos> on for which <header> is
+// true, or <len> if there is none
+static int findLine(const QByteArray& data, int pos, int len, bool header)
+{
+    while (pos < len) {
+        int end = data.indexOf('\n', pos);
+        if ((end < 0) || (end > len)) end = len;
+        if (isDumpHeaderLine(data.constData() + pos, end - pos) == header)
+            return pos;
+        pos = end + 1;
+    }
+    return len;
+}
+
+// part number given in dump header lines from <start> to <end>, or 0
+static int dumpPartNumber(const QByteArray& data, int start, int end)
+{
+    while (start < end) {
+        int next = data.indexOf('\n', start);
+        if ((next < 0) || (next > end)) next = end;
+        if (data.mid(start, 5) == "part:")
+            return data.mid(start + 5, next - start - 5).trimmed().toInt();
+        start = next + 1;
+    }
+    return 0;
+}
+
+/**
+ * Callgrind appends a dump to an existing file with a new header, which
+ * starts a new part. Thus, the appended data can be parsed on its own.
+ *
+ * The size recorded before a previous load may be smaller than the
+ * data the parser actually got, as the file may have grown meanwhile.
+ * Thus, parsing resyncs to the next dump header after <offset>, and
+ * skips dumps with part numbers already loaded from this file.
+ * Only complete lines up to <size> are parsed.
+ * Returns the offset up to which the file was consumed.
+ */
+qint64 TraceData::loadAppended(const QString& filename,
+                               qint64 offset, qint64 size)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return offset;
+
+    // compressed data cannot be continued, and the loader is
+    // detected from the file header
+    Loader* l = nullptr;
+    if (DecompressDevice::detect(&file) == DecompressDevice::None)
+        l = Loader::matchingLoader(&file);
+    if (!l || !file.seek(offset)) return size;
+
+    QByteArray data = file.read(size - offset);
+    file.close();
+    int len = data.lastIndexOf('\n') + 1;
+
+    int lastPart = 0;
+    foreach(TracePart* p, _parts)
+        if ((p->name() == filename) && (p->partNumber() > lastPart))
+            lastPart = p->partNumber();
+
+    int start = findLine(data, 0, len, true);
+    while (start < len) {
+        int body = findLine(data, start, len, false);
+        int number = dumpPartNumber(data, start, body);
+        if ((number == 0) || (number > lastPart)) break;
+
+        // already loaded
+        start = findLine(data, body, len, true);
+    }
+    if (start >= len) return offset + len;
+
+    data.truncate(len);
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    buffer.seek(start);
+    l->load(this, &buffer, filename);
+
+    return offset + len;
+}
+
+void TraceData::invalidateNewParts(const TracePartList& parts)
+{
+    // totals of active parts
+    invalidate();
+
+    // function cycles may have changed with new calls
+    if (GlobalConfig::showCycles()) {
         invalidateDynamicCost();
         updateFunctionCycles();
+        return;
+    }
+
+    // items with costs in new parts already were invalidated when
+    // getting new dependencies; all others keep their cached costs
+    foreach(TracePart* part, parts)
+        foreach(ProfileCostArray* dep, part->deps()) {
+#if USE_FIXCOST
+            ((TracePartFunction*) dep)->function()->invalidateDynamicCost();
+#else
+            // without fix costs, parts depend on their lines
+            TraceLine* line = ((TracePartLine*) dep)->line();
+            line->functionSource()->function()->invalidateDynamicCost();
+#endif
+        }
+}
+
+int TraceData::mergeParts(TraceData* d, TracePart* target)
+{
+#if USE_FIXCOST
+    FixPool* pool = fixPool();
+    _loadStats.add(d->loadStats());
+
+    // mapping of cost items of <d> to ours
+    QHash<TraceObject*, TraceObject*> objects;
+    QHash<TraceFile*, TraceFile*> files;
+    QHash<TraceFunction*, TraceFunction*> functions;
+    QHash<TraceFunctionSource*, TraceFunctionSource*> sources;
+
+    auto mapObject = [&](TraceObject* o) {
+        TraceObject*& res = objects[o];
+        if (!res) res = object(o->name());
+        return res;
+    };
+    auto mapFile = [&](TraceFile* f) {
+        TraceFile*& res = files[f];
+        if (!res) res = file(f->name());
+        return res;
+    };
+    auto mapFunction = [&](TraceFunction* f) {
+        TraceFunction*& res = functions[f];
+        if (!res)
+            res = function(f->name(), mapFile(f->file()), mapObject(f->object()));
+        return res;
+    };
+    auto mapSource = [&](TraceFunctionSource* fs) -> TraceFunctionSource* {
+        if (!fs) return nullptr;
+        TraceFunctionSource*& res = sources[fs];
+        if (!res)
+            res = mapFunction(fs->function())->sourceFile(mapFile(fs->file()), true);
+        return res;
+    };
+    auto mapPartFunction = [&](TracePart* part, TracePartFunction* pf) {
+        TraceFunction* f = mapFunction(pf->function());
+        TraceFile* fl = mapFile(pf->partFile()->file());
+        TracePartObject* po = nullptr;
+        if (pf->partObject())
+            po = mapObject(pf->partObject()->object())->partObject(part);
+        return f->partFunction(part, fl->partFile(part), po);
+    };
+
+    if (!d->command().isEmpty()) _command = d->command();
+    if (d->architecture() != ArchUnknown) _arch = d->architecture();
+
+    int partsAdded = 0;
+    foreach(TracePart* p, d->parts()) {
+        TracePart* part = target;
+        if (!part) {
+            part = new TracePart(this);
+            part->setName(p->name());
+            part->setDescription(p->description());
+            part->setTrigger(p->trigger());
+            part->setTimeframe(p->timeframe());
+            part->setVersion(p->version());
+            part->setThreadID(p->threadID());
+            // without process ID, part numbers get assigned in addPart()
+            if (p->processID() != 0) {
+                part->setProcessID(p->processID());
+                part->setPartNumber(p->partNumber());
+            }
+
+            // same event columns, so fix costs can be copied verbatim
+            EventTypeMapping* m = p->eventTypeMapping();
+            QString types;
+            for(int i=0; i<m->count(); i++)
+                types += d->eventTypes()->realType(m->realIndex(i))->name() + ' ';
+            part->setEventMapping(_eventTypes.createMapping(types));
+        }
+
+        QVector<FixCost*> costs;
+        QVector<FixCallCost*> callCosts;
+        QVector<FixJump*> jumps;
+        foreach(ProfileCostArray* dep, p->deps()) {
+            TracePartFunction* pf = (TracePartFunction*) dep;
+            TracePartFunction* newPf = mapPartFunction(part, pf);
+
+            // keep order of the linked lists (new items get prepended)
+            costs.clear();
+            for(FixCost* fc = pf->firstFixCost(); fc;
+                fc = fc->nextCostOfPartFunction())
+                costs.append(fc);
+            for(int i = costs.count()-1; i>=0; i--)
+                new (pool) FixCost(part, pool,
+                                   mapSource(costs[i]->functionSource()),
+                                   newPf, *costs[i]);
+
+            jumps.clear();
+            for(FixJump* fj = pf->firstFixJump(); fj;
+                fj = fj->nextJumpOfPartFunction())
+                jumps.append(fj);
+            for(int i = jumps.count()-1; i>=0; i--) {
+                FixJump* fj = jumps[i];
+                new (pool) FixJump(part, pool,
+                                   fj->line(), fj->addr(),
+                                   newPf, mapSource(fj->source()),
+                                   fj->targetLine(), fj->targetAddr(),
+                                   mapFunction(fj->targetFunction()),
+                                   mapSource(fj->targetSource()),
+                                   fj->isCondJump(),
+                                   fj->executedCount(), fj->followedCount());
+            }
+
+            foreach(TracePartCall* pc, pf->partCallings()) {
+                TraceFunction* called = pc->call()->called(true);
+                TracePartFunction* calledPf;
+                calledPf = (TracePartFunction*) called->findDepFromPart(p);
+                TraceCall* call = newPf->function()->calling(mapFunction(called));
+                TracePartCall* newPc = call->partCall(part, newPf,
+                                                      mapPartFunction(part, calledPf));
+
+                callCosts.clear();
+                for(FixCallCost* fcc = pc->firstFixCallCost(); fcc;
+                    fcc = fcc->nextCostOfPartCall())
+                    callCosts.append(fcc);
+                for(int i = callCosts.count()-1; i>=0; i--) {
+                    FixCallCost* fcc;
+                    fcc = new (pool) FixCallCost(part, pool,
+                                                 mapSource(callCosts[i]->functionSource()),
+                                                 newPc, *callCosts[i]);
+                    fcc->setMax(callMax());
+                    updateMaxCallCount(fcc->callCount());
+                }
+            }
+        }
+
+        partsAdded++;
+        if (target) continue;
+
+        part->invalidate();
+        part->totals()->clear();
+        part->totals()->addCost(part);
+        addPart(part);
     }
 
-    return changed;
+    return partsAdded;
+#else
+    Q_UNUSED(d);
+    qDebug("TraceData::mergeParts: not supported without fix costs");
+    return 0;
+#endif
+}
+
+bool TraceData::activateParts(const TracePartList& l)
+{
+    TracePartList changed;
+
+    foreach(TracePart* part, _parts)
+        if (part->activate(l.contains(part)))
+            changed.append(part);
+
+    if (changed.isEmpty()) return false;
+
+    updateActivation(changed);
+
+    return true;
 }
 
 
 bool TraceData::activateParts(TracePartList l, bool active)
 {
-    bool changed = false;
+    TracePartList changed;
 
     foreach(TracePart* part, l) {
         if (_parts.contains(part))
             if (part->activate(active))
-                changed = true;
+                changed.append(part);
     }
 
-    if (changed) {
-        invalidateDynamicCost();
-        updateFunctionCycles();
+    if (changed.isEmpty()) return false;
+
+    updateActivation(changed);
+
+    return true;
+}
+
+/**
+ * Instead of recalculating all costs from the costs of active parts,
+ * add or subtract the costs of parts with changed active status.
+ * This only touches items with cost in these parts.
+ *
+ * Function cycles are detected on costs of active parts: they are
+ * detected again afterwards, and only costs of cycle members before
+ * and after are invalidated.
+ */
+void TraceData::updateActivation(const TracePartList& parts)
+{
+    // functions whose call counts have to be updated afterwards
+    QSet<TraceFunction*> functions;
+
+    foreach(TracePart* part, parts) {
+        bool active = part->isActive();
+
+        // part objects, classes and files of this part
+        QSet<TraceInclusiveCost*> groups;
+
+        // part functions of this part
+        TracePartFunctionList partFunctions;
+#if USE_FIXCOST
+        foreach(ProfileCostArray* dep, part->deps())
+            partFunctions.append((TracePartFunction*) dep);
+#else
+        // without fix costs, parts depend on their lines
+        QSet<TracePartFunction*> found;
+        foreach(ProfileCostArray* dep, part->deps()) {
+            TraceLine* line = ((TracePartLine*) dep)->line();
+            TraceFunction* f = line->functionSource()->function();
+            TracePartFunction* pf;
+            pf = (TracePartFunction*) f->findDepFromPart(part);
+            if (!pf || found.contains(pf)) continue;
+            found.insert(pf);
+            partFunctions.append(pf);
+        }
+#endif
+
+        foreach(TracePartFunction* pf, partFunctions) {
+            TraceFunction* f = pf->function();
+
+            f->updatePartActivation(pf, active);
+            functions.insert(f);
+            foreach(TracePartCall* pc, pf->partCallings())
+                functions.insert(pc->call()->called(true));
+
+            if (pf->partObject()) groups.insert(pf->partObject());
+            if (pf->partClass()) groups.insert(pf->partClass());
+            if (pf->partFile()) groups.insert(pf->partFile());
+        }
+
+        foreach(TraceInclusiveCost* g, groups)
+            ((TraceInclusiveCost*) g->dependent())->updateActivation(g, active);
     }
 
-    return changed;
+    foreach(TraceFunction* f, functions)
+        f->updateCallCounts();
+
+    // totals of active parts
+    invalidate();
+
+    if (!GlobalConfig::showCycles()) return;
+
+    // costs of members are calculated from their calls
+    foreach(TraceFunctionCycle* cycle, _functionCycles)
+        foreach(TraceFunction* f, cycle->members())
+            f->invalidate();
+
+    detectFunctionCycles();
+
+    foreach(TraceFunctionCycle* cycle, _functionCycles)
+        foreach(TraceFunction* f, cycle->members())
+            f->invalidate();
 }
 
 bool TraceData::activatePart(TracePart* p, bool active)
@@ -3337,35 +4007,47 @@ void TraceData::invalidateDynamicCost()
 
 TraceObject* TraceData::object(const QString& name)
 {
-    TraceObject& o = _objectMap[name];
-    if (!o.data()) {
-        // was created
-        o.setPosition(this);
-        o.setName(name);
+    return object(_names.intern(name));
+}
+
+TraceObject* TraceData::object(int nameId)
+{
+    bool created;
+    TraceObject* o = _objectMap.insert(TraceItemKey(nameId), &created);
+    if (created) {
+        o->setPosition(this);
+        o->setNameId(nameId);
+        o->setShortNameId(_names.intern(o->shortName()));
 
 #if TRACE_DEBUG
         qDebug("Created %s [TraceData::object]",
-               qPrintable(o.fullName()));
+               qPrintable(o->fullName()));
 #endif
     }
-    return &o;
+    return o;
 }
 
 
 TraceFile* TraceData::file(const QString& name)
 {
-    TraceFile& f = _fileMap[name];
-    if (!f.data()) {
-        // was created
-        f.setPosition(this);
-        f.setName(name);
+    return file(_names.intern(name));
+}
+
+TraceFile* TraceData::file(int nameId)
+{
+    bool created;
+    TraceFile* f = _fileMap.insert(TraceItemKey(nameId), &created);
+    if (created) {
+        f->setPosition(this);
+        f->setNameId(nameId);
+        f->setShortNameId(_names.intern(f->shortName()));
 
 #if TRACE_DEBUG
         qDebug("Created %s [TraceData::file]",
-               qPrintable(f.fullName()));
+               qPrintable(f->fullName()));
 #endif
     }
-    return &f;
+    return f;
 }
 
 
@@ -3393,18 +4075,19 @@ TraceClass* TraceData::cls(const QString& fnName, QString& shortName)
                                         fnName.left(lastIndex-2);
     shortName = fnName.mid(lastIndex);
 
-    TraceClass& c = _classMap[clsName];
-    if (!c.data()) {
-        // was created
-        c.setPosition(this);
-        c.setName(clsName);
+    bool created;
+    int nameId = _names.intern(clsName);
+    TraceClass* c = _classMap.insert(TraceItemKey(nameId), &created);
+    if (created) {
+        c->setPosition(this);
+        c->setNameId(nameId);
 
 #if TRACE_DEBUG
         qDebug("Created %s [TraceData::cls]",
-               qPrintable(c.fullName()));
+               qPrintable(c->fullName()));
 #endif
     }
-    return &c;
+    return c;
 }
 
 
@@ -3412,12 +4095,15 @@ TraceClass* TraceData::cls(const QString& fnName, QString& shortName)
 TraceFunction* TraceData::function(const QString& name,
                                    TraceFile* file, TraceObject* object)
 {
-    // strip class name
-    QString shortName;
-    TraceClass* c = cls(name, shortName);
+    return function(_names.intern(name), file, object);
+}
 
-    if (!file || !object || !c) {
-        qDebug("ERROR - no file/object/class for %s ?!", qPrintable(name));
+TraceFunction* TraceData::function(int nameId,
+                                   TraceFile* file, TraceObject* object)
+{
+    if (!file || !object) {
+        qDebug("ERROR - no file/object for %s ?!",
+               qPrintable(_names.name(nameId)));
         return nullptr;
     }
 
@@ -3443,47 +4129,37 @@ TraceFunction* TraceData::function(const QString& name,
     // or the ordering of costs specified.
     // Previously, the file name was left out from the key.
     // The change was motivated by bug ID 3014067 (on SourceForge).
-    QString key = name + file->shortName() + object->shortName();
-
-    TraceFunctionMap::Iterator it;
-    it = _functionMap.find(key);
-    if (it == _functionMap.end()) {
-        it = _functionMap.insert(key, TraceFunction());
-        TraceFunction& f = it.value();
-
-        f.setPosition(this);
-        f.setName(name);
-        f.setClass(c);
-        f.setObject(object);
-        f.setFile(file);
-        //f.setMapIterator(it);
+    // The key uses IDs of interned names: no string concatenation or
+    // comparison is needed for looking up an existing function.
+    TraceItemKey key(nameId, file->shortNameId(), object->shortNameId());
+
+    bool created;
+    TraceFunction* f = _functionMap.insert(key, &created);
+    if (created) {
+        // strip class name
+        QString shortName;
+        TraceClass* c = cls(_names.name(nameId), shortName);
+
+        f->setPosition(this);
+        f->setIndex(_functionMap.count() - 1);
+        f->setNameId(nameId);
+        f->setClass(c);
+        f->setObject(object);
+        f->setFile(file);
 
 #if TRACE_DEBUG
         qDebug("Created %s [TraceData::function]\n  for %s, %s, %s",
-               qPrintable(f.fullName()),
+               qPrintable(f->fullName()),
                qPrintable(c->fullName()), qPrintable(file->fullName()),
                object ? qPrintable(object->fullName()) : "(unknown object)");
 #endif
 
-        c->addFunction(&f);
-        object->addFunction(&f);
-        file->addFunction(&f);
+        c->addFunction(f);
+        object->addFunction(f);
+        file->addFunction(f);
     }
 
-    return &(it.value());
-}
-
-TraceFunctionMap::Iterator TraceData::functionIterator(TraceFunction* f)
-{
-
-    // IMPORTANT: build as SAME key as used in function() above !!
-    QString key;
-
-    if (f->cls()) key = f->cls()->name() + "::";
-    key += f->name();
-    key += f->object()->shortName();
-
-    return _functionMap.find(key);
+    return f;
 }
 
 TraceFunctionMap::ConstIterator TraceData::functionBeginIterator() const
@@ -3538,13 +4214,16 @@ ProfileCostArray* TraceData::search(ProfileContext::Type t, QString name,
     switch(t) {
     case ProfileContext::Function:
     {
+        int id = _names.find(name);
+        if (id < 0) break;
+
         TraceFunction *f;
         TraceFunctionMap::Iterator it;
         for ( it = _functionMap.begin();
               it != _functionMap.end(); ++it ) {
             f = &(*it);
 
-            if (f->name() != name) continue;
+            if (f->nameId() != id) continue;
 
             if ((pt == ProfileContext::Class) && (parent != f->cls())) continue;
             if ((pt == ProfileContext::File) && (parent != f->file())) continue;
@@ -3561,57 +4240,29 @@ ProfileCostArray* TraceData::search(ProfileContext::Type t, QString name,
     }
         break;
 
+    // names of files, classes and objects are unique: use lookup
     case ProfileContext::File:
     {
-        TraceFile *f;
-        TraceFileMap::Iterator it;
-        for ( it = _fileMap.begin();
-              it != _fileMap.end(); ++it ) {
-            f = &(*it);
-            if (f->name() != name) continue;
-            if (ct) {
-                sc = f->subCost(ct);
-                if (sc <= scTop) continue;
-                scTop = sc;
-            }
-            result = f;
-        }
+        int id = _names.find(name);
+        if (id >= 0) result = _fileMap.find(TraceItemKey(id));
+        // as for functions: with event type given, need some cost
+        if (result && ct && (result->subCost(ct) == 0)) result = nullptr;
     }
         break;
 
     case ProfileContext::Class:
     {
-        TraceClass *c;
-        TraceClassMap::Iterator it;
-        for ( it = _classMap.begin();
-              it != _classMap.end(); ++it ) {
-            c = &(*it);
-            if (c->name() != name) continue;
-            if (ct) {
-                sc = c->subCost(ct);
-                if (sc <= scTop) continue;
-                scTop = sc;
-            }
-            result = c;
-        }
+        int id = _names.find(name);
+        if (id >= 0) result = _classMap.find(TraceItemKey(id));
+        if (result && ct && (result->subCost(ct) == 0)) result = nullptr;
     }
         break;
 
     case ProfileContext::Object:
     {
-        TraceObject *o;
-        TraceObjectMap::Iterator it;
-        for ( it = _objectMap.begin();
-              it != _objectMap.end(); ++it ) {
-            o = &(*it);
-            if (o->name() != name) continue;
-            if (ct) {
-                sc = o->subCost(ct);
-                if (sc <= scTop) continue;
-                scTop = sc;
-            }
-            result = o;
-        }
+        int id = _names.find(name);
+        if (id >= 0) result = _objectMap.find(TraceItemKey(id));
+        if (result && ct && (result->subCost(ct) == 0)) result = nullptr;
     }
         break;
 
@@ -3681,6 +4332,18 @@ TraceFunctionCycle* TraceData::functionCycle(TraceFunction* f)
 
 
 void TraceData::updateFunctionCycles()
+{
+    detectFunctionCycles();
+
+    // we have to invalidate costs because cycles are now taken into account
+    invalidateDynamicCost();
+}
+
+/* Sets up function cycles from the calls of active parts.
+ * Costs calculated while detecting are without cycles: afterwards,
+ * costs of cycle members have to be invalidated.
+ */
+void TraceData::detectFunctionCycles()
 {
     //qDebug("Updating cycles...");
 
@@ -3696,31 +4359,152 @@ void TraceData::updateFunctionCycles()
 
     _inFunctionCycleUpdate = true;
 
+    int fCount = _functionMap.size();
+    // not a load: keep file name of logger for later load messages
+    QString what = QObject::tr("function cycles of %1").arg(_traceName);
+    if (_logger) _logger->updateProgress(what, 0);
+
+    // Call graph as compact adjacency arrays, using the function index:
+    // calls of function i are edges first[i] .. first[i+1]-1
+    QVector<int> first(fCount + 1);
+    int eCount = 0;
+    for(int i = 0; i < fCount; i++) {
+        first[i] = eCount;
+        eCount += _functionMap.at(i).callings().count();
+    }
+    first[fCount] = eCount;
 
-#if 0
-    int fCount = _functionMap.size(), fNo = 0, progress=0, p;
-    QString msg = tr("Recalculating Function Cycles...");
-    if (_topLevel) _topLevel->showStatus(msg,0);
-#endif
-
-    // DFS and collapse strong connected components (Tarjan)
-    int pNo = 0;
-    TraceFunction* stackTop;
-    for ( it = _functionMap.begin(); it != _functionMap.end(); ++it ) {
+    QVector<TraceCall*> edgeCall(eCount);
+    for(int i = 0; i < fCount; i++) {
+        int e = first[i];
+        foreach(TraceCall* call, _functionMap.at(i).callings())
+            edgeCall[e++] = call;
+    }
 
-#if 0
-        if (_topLevel) {
-            fNo++;
-            p = 100*fNo/fCount;
-            if (p> progress) {
-                progress = p;
-                _topLevel->showStatus(msg, p);
+    /* cycle cut heuristic:
+     * skip calls for cycle detection if they make less than _cycleCut
+     * percent of the cost of the function.
+     * FIXME: Which cost type to use for this heuristic ?!
+     */
+    Q_ASSERT(eventTypes()->realCount()>0);
+    EventType* et = eventTypes()->realType(0);
+
+    // Call costs, in parallel: each call only updates itself and its
+    // part calls when getting its cost
+    QVector<SubCost> edgeCost(eCount);
+    SubCost* costs = edgeCost.data();
+    TraceCall* const * calls = edgeCall.constData();
+    ParallelJobs::forRanges(eCount, 10000, [=](int begin, int end) {
+        for(int e = begin; e < end; e++)
+            costs[e] = calls[e]->subCost(et);
+    });
+    if (_logger) _logger->updateProgress(what, 30);
+
+    // base is the maximal cost of calls to a function, or its
+    // inclusive cost if never called
+    QVector<SubCost> base(fCount);
+    QVector<bool> called(fCount, false);
+    for(int e = 0; e < eCount; e++) {
+        int t = edgeCall[e]->called()->index();
+        called[t] = true;
+        if (edgeCost[e] > base[t]) base[t] = edgeCost[e];
+    }
+    for(int i = 0; i < fCount; i++)
+        if (!called[i])
+            base[i] = _functionMap.at(i).inclusive()->subCost(et);
+
+    // drop cut calls, keeping the call order of each function:
+    // remaining edges of function i are target[first[i]] .. target[last[i]-1]
+    QVector<int> target(eCount), last(fCount);
+    int* targets = target.data();
+    int* ends = last.data();
+    const int* starts = first.constData();
+    const SubCost* bases = base.constData();
+    double cycleCut = GlobalConfig::cycleCut();
+    ParallelJobs::forRanges(fCount, 10000, [=](int begin, int end) {
+        for(int i = begin; i < end; i++) {
+            SubCost cutLimit = SubCost(bases[i] * cycleCut);
+            int t = starts[i];
+            for(int e = starts[i]; e < starts[i+1]; e++) {
+                if (costs[e] < cutLimit) continue;
+                targets[t++] = calls[e]->called()->index();
             }
+            ends[i] = t;
         }
-#endif
+    });
+    if (_logger) _logger->updateProgress(what, 40);
+
+    // Iterative DFS collapsing strongly connected components (Tarjan).
+    // A prefix number of 0 means "not visited yet".
+    // This does not mark functions calling themself !
+    QVector<int> prefix(fCount, 0), low(fCount), next(fCount);
+    QVector<bool> onStack(fCount, false);
+    QVector<int> path, stack;
+    int pNo = 0, progress = 40;
+
+    for(int root = 0; root < fCount; root++) {
+        if (prefix[root] != 0) continue;
+
+        if (_logger && (40 + 60 * root / fCount > progress)) {
+            progress = 40 + 60 * root / fCount;
+            _logger->updateProgress(what, progress);
+        }
+
+        path.append(root);
+        prefix[root] = low[root] = ++pNo;
+        next[root] = first[root];
+        stack.append(root);
+        onStack[root] = true;
+
+        while(!path.isEmpty()) {
+            int v = path.last();
+
+            if (next[v] < last[v]) {
+                int w = target[next[v]++];
+                if (prefix[w] == 0) {
+                    // not visited yet: descend
+                    path.append(w);
+                    prefix[w] = low[w] = ++pNo;
+                    next[w] = first[w];
+                    stack.append(w);
+                    onStack[w] = true;
+                }
+                else if (onStack[w]) {
+                    // backlink to same SCC
+                    if (low[w] < low[v]) low[v] = low[w];
+                }
+                continue;
+            }
 
-        stackTop = nullptr;
-        (*it).cycleDFS(1, pNo, &stackTop);
+            // all calls of v done: return to caller
+            path.removeLast();
+            if (!path.isEmpty() && (low[v] < low[path.last()]))
+                low[path.last()] = low[v];
+
+            if (low[v] != prefix[v]) continue;
+
+            // v is the base of a SCC
+            if (stack.last() == v) {
+                stack.removeLast();
+                onStack[v] = false;
+                continue;
+            }
+
+            // a SCC with >1 members
+            TraceFunctionCycle* cycle = functionCycle(&_functionMap.at(v));
+            if (0) qDebug("Found Cycle %d with base %s:",
+                          cycle->cycleNo(),
+                          qPrintable(_functionMap.at(v).prettyName()));
+            while(1) {
+                int m = stack.takeLast();
+                onStack[m] = false;
+                cycle->add(&_functionMap.at(m));
+
+                if (0) qDebug("  %s",
+                              qPrintable(_functionMap.at(m).prettyName()));
+                if (m == v) break;
+            }
+        }
     }
 
     // postprocess cycles
@@ -3728,12 +4512,8 @@ void TraceData::updateFunctionCycles()
         cycle->setup();
 
     _inFunctionCycleUpdate = false;
-    // we have to invalidate costs because cycles are now taken into account
-    invalidateDynamicCost();
 
-#if 0
-    if (0) if (_topLevel) _topLevel->showStatus(QString(), 0);
-#endif
+    if (_logger) _logger->updateProgress(what, 100);
 }
 
 void TraceData::updateObjectCycles()
@@ -28,6 +28,9 @@
 #include <qstring.h>
 #include <qstringlist.h>
 #include <qmap.h>
+#include <qhash.h>
+#include <qpair.h>
+#include <qvector.h>
 
 #include "costitem.h"
 #include "subcost.h"
@@ -35,8 +38,11 @@
 #include "addr.h"
 #include "context.h"
 #include "eventtype.h"
+#include "symboltable.h"
+#include "logger.h"
 
 class QFile;
+class QElapsedTimer;
 
 /**
  * All cost items are classes prefixed with "Trace".
@@ -187,10 +193,10 @@ typedef QList<TraceLineRegion*> TraceLineRegionList;
 typedef QList<TraceFunctionSource*> TraceFunctionSourceList;
 typedef QList<TraceFunction*> TraceFunctionList;
 typedef QList<TraceFunctionCycle*> TraceFunctionCycleList;
-typedef QMap<QString, TraceObject> TraceObjectMap;
-typedef QMap<QString, TraceClass> TraceClassMap;
-typedef QMap<QString, TraceFile> TraceFileMap;
-typedef QMap<QString, TraceFunction> TraceFunctionMap;
+typedef TraceItemTable<TraceObject> TraceObjectMap;
+typedef TraceItemTable<TraceClass> TraceClassMap;
+typedef TraceItemTable<TraceFile> TraceFileMap;
+typedef TraceItemTable<TraceFunction> TraceFunctionMap;
 typedef QMap<uint, TraceLine> TraceLineMap;
 typedef QMap<Addr, TraceInstr> TraceInstrMap;
 
@@ -240,6 +246,9 @@ public:
     QString prettyCallCount();
     void addCallCount(SubCost c);
 
+    // also updates call count: <item> has to be a TraceCallCost
+    void updateActivation(ProfileCostArray* item, bool active) override;
+
 protected:
     SubCost _callCount;
 };
@@ -262,11 +271,21 @@ public:
     ProfileCostArray* inclusive();
     void addInclusive(ProfileCostArray*);
 
+    // also updates inclusive cost: <item> has to be a TraceInclusiveCost
+    void updateActivation(ProfileCostArray* item, bool active) override;
+
 protected:
     ProfileCostArray _inclusive;
 };
 
 
+/**
+ * Dependencies of a list cost as (part index, dependency), sorted by
+ * part index. Only parts with cost take space.
+ */
+template<class T>
+using TraceDepIndex = QVector<QPair<int, T*> >;
+
 /**
  * Cost Item
  * depends on a list of cost items.
@@ -293,6 +312,8 @@ protected:
 private:
     // very temporary: cached
     ProfileCostArray* _lastDep;
+    // deps by part index, for lists with many parts
+    TraceDepIndex<ProfileCostArray>* _depIndex;
 };
 
 
@@ -322,6 +343,8 @@ protected:
 private:
     // very temporary: cached
     TraceJumpCost* _lastDep;
+    // deps by part index, for lists with many parts
+    TraceDepIndex<TraceJumpCost>* _depIndex;
 };
 
 
@@ -353,6 +376,8 @@ protected:
 private:
     // very temporary: cached
     TraceCallCost* _lastDep;
+    // deps by part index, for lists with many parts
+    TraceDepIndex<TraceCallCost>* _depIndex;
 };
 
 
@@ -381,6 +406,8 @@ protected:
 private:
     // very temporary: cached
     TraceInclusiveCost* _lastDep;
+    // deps by part index, for lists with many parts
+    TraceDepIndex<TraceInclusiveCost>* _depIndex;
 };
 
 
@@ -670,6 +697,8 @@ public:
     QString timeframe() const { return _timeframe; }
     QString version() const { return _version; }
     int partNumber() const { return _number; }
+    // dense number of parts created for a TraceData, starting at 0
+    int index() const { return _index; }
     int threadID() const { return _tid; }
     int processID() const { return _pid; }
     void setDescription(const QString& d) { _descr = d; }
@@ -700,6 +729,7 @@ private:
     QString _version;
 
     int _number, _tid, _pid;
+    int _index;
 
     bool _active;
 
@@ -848,6 +878,8 @@ public:
     void update() override;
 
     void invalidateDynamicCost();
+    // only costs of line/instruction calls
+    void invalidateDetails();
 
     // factories
     TracePartCall* partCall(TracePart*,
@@ -982,14 +1014,17 @@ public:
     explicit TraceCostItem(ProfileContext*);
     ~TraceCostItem() override;
 
-    QString name() const override { return _name; }
-    virtual void setName(const QString& name) { _name = name; }
+    // names are stored in the name table of TraceData, see NameTable
+    QString name() const override;
+    virtual void setName(const QString& name);
+    int nameId() const { return _nameId; }
+    void setNameId(int id) { _nameId = id; }
 
 protected:
     bool onlyActiveParts() override { return true; }
 
 protected:
-    QString _name;
+    int _nameId;
 };
 
 
@@ -1132,6 +1167,15 @@ public:
     // active status of parts
     void invalidateDynamicCost();
 
+    /**
+     * Incremental update for changed active status of the part of <pf>:
+     * adds/subtracts cost of <pf> and its calls. Costs of source lines,
+     * instructions and line/instruction calls are invalidated.
+     * Call counts have to be updated afterwards.
+     */
+    void updatePartActivation(TracePartFunction* pf, bool active);
+    void updateCallCounts();
+
     void addCaller(TraceCall*);
 
     // factories
@@ -1185,6 +1229,9 @@ public:
     void setFile(TraceFile* file) { _file = file; }
     void setObject(TraceObject* object) { _object = object; }
     void setClass(TraceClass* cls) { _cls = cls; }
+    // dense index in function table of TraceData, -1 for cycles
+    void setIndex(int i) { _index = i; }
+    int index() const { return _index; }
     //void setMapIterator(TraceFunctionMap::Iterator it) { _myMapIterator = it; }
 
     // see TraceFunctionAssociation
@@ -1200,11 +1247,12 @@ public:
     bool isCycle();
     bool isCycleMember();
     void cycleReset();
-    void cycleDFS(int d, int& pNo, TraceFunction** pTop);
 
 protected:
     TraceCallList _callers; // list of calls we are called from
     TraceCallList _callings; // list of calls we are calling (we are owner)
+    // lookup of calls by called function, only for many calls
+    QHash<TraceFunction*, TraceCall*>* _callingIndex;
     TraceFunctionCycle* _cycle;
 
 private:
@@ -1214,6 +1262,7 @@ private:
     TraceClass* _cls;
     TraceObject* _object;
     TraceFile* _file;
+    int _index;
 
     TraceFunctionSourceList _sourceFiles; // we are owner
     TraceInstrMap* _instrMap; // we are owner
@@ -1222,10 +1271,6 @@ private:
     // see TraceAssociation
     TraceAssociationList _associations;
 
-    // for cycle detection
-    int _cycleLow;
-    TraceFunction* _cycleStackDown;
-
     // cached
     SubCost _calledCount, _callingCount;
     int _calledContexts, _callingContexts;
@@ -1308,6 +1353,9 @@ public:
     QString shortName() const;
     QString prettyName() const override;
     QString prettyLongName() const;
+    // ID of shortName() in the name table of TraceData
+    int shortNameId() const { return _shortNameId; }
+    void setShortNameId(int id) { _shortNameId = id; }
     static QString prettyEmptyName();
     const TraceFunctionList& functions() const { return _functions; }
     const TraceFunctionSourceList& sourceFiles() const
@@ -1320,6 +1368,7 @@ private:
     TraceFunctionList _functions;
     TraceFunctionSourceList _sourceFiles;
     QString _dir;
+    int _shortNameId;
 };
 
 
@@ -1343,6 +1392,9 @@ public:
     QString prettyName() const override;
     static QString prettyEmptyName();
     const TraceFunctionList& functions() const { return _functions; }
+    // ID of shortName() in the name table of TraceData
+    int shortNameId() const { return _shortNameId; }
+    void setShortNameId(int id) { _shortNameId = id; }
 
     // part factory
     TracePartObject* partObject(TracePart*);
@@ -1350,6 +1402,7 @@ public:
 private:
     TraceFunctionList _functions;
     QString _dir;
+    int _shortNameId;
 };
 
 
@@ -1382,6 +1435,36 @@ public:
     int load(QString file);
     int load(QIODevice*, const QString&);
 
+    /**
+     * Copies all parts of trace <d> into this trace, matching cost items
+     * by name. Used for parallel loading: every file is loaded into a
+     * separate TraceData in a worker thread, merged in afterwards.
+     * <d> can be deleted afterwards. Returns the number of parts added.
+     *
+     * If <target> is given, the costs of all parts of <d> are added to
+     * this part instead, which must use the same event mapping. Such
+     * partial results come from loading one file in chunks; the target
+     * is not added to the trace and its totals are not updated.
+     */
+    int mergeParts(TraceData* d, TracePart* target = nullptr);
+
+    /**
+     * Follow mode, for profile data growing while being looked at:
+     * loads parts appended to already loaded files, and new files
+     * matching the prefix given to load(). As new or grown files may
+     * be written to at the moment, they only are loaded if their size
+     * did not change since the last call.
+     * Only costs of items touched by new parts are invalidated.
+     * Returns the number of parts added.
+     */
+    int loadNewParts();
+    // true if loadNewParts() has seen files with data not yet loaded
+    bool hasPendingParts() const { return !_pendingSizes.isEmpty(); }
+    // files to watch for follow mode
+    QStringList loadedFiles() const { return _loadedSizes.keys(); }
+    // directory to watch for new files in follow mode (can be empty)
+    QString followDirectory() const;
+
     /** returns true if something changed. These do NOT
      * invalidate the dynamic costs on a activation change,
      * i.e. all cost items depends on active parts.
@@ -1396,6 +1479,18 @@ public:
     // to be used by loader
     void addPart(TracePart*);
 
+    /**
+     * Write cache files for loaded files (default), if also enabled by
+     * GlobalConfig::writeCache(). Switch off for temporary loads.
+     */
+    void setWriteCache(bool w) { _writeCache = w; }
+    bool writeCache() const { return _writeCache; }
+
+    // receiver of notifications while loading
+    Logger* logger() const { return _logger; }
+    // statistics of the last load, also reported to the logger
+    LoadStats& loadStats() { return _loadStats; }
+
     TracePartList parts() const { return _parts; }
     TracePart* partWithName(const QString& name);
 
@@ -1412,12 +1507,20 @@ public:
     FixPool* fixPool();
     DynPool* dynPool();
 
+    // interned names of all items
+    NameTable* names() { return &_names; }
+    const NameTable* names() const { return &_names; }
+
     // factories for object/file/class/function/line instances
     TraceObject* object(const QString& name);
     TraceFile* file(const QString& name);
     TraceClass* cls(const QString& fnName, QString& shortName);
     // function creation involves class creation if needed
     TraceFunction* function(const QString& name, TraceFile*, TraceObject*);
+    // same, with ID of name in names()
+    TraceObject* object(int nameId);
+    TraceFile* file(int nameId);
+    TraceFunction* function(int nameId, TraceFile*, TraceObject*);
     // factory for function cycles
     TraceFunctionCycle* functionCycle(TraceFunction*);
 
@@ -1433,7 +1536,6 @@ public:
                              EventType* ct = nullptr, ProfileCostArray* parent = nullptr);
 
     // for pretty function names without signature if unique...
-    TraceFunctionMap::Iterator functionIterator(TraceFunction*);
     TraceFunctionMap::ConstIterator functionBeginIterator() const;
     TraceFunctionMap::ConstIterator functionEndIterator() const;
 
@@ -1457,6 +1559,8 @@ public:
     int maxThreadID() const { return _maxThreadID; }
     void setMaxPartNumber(int n) { _maxPartNumber = n; }
     int maxPartNumber() const { return _maxPartNumber; }
+    // dense index for a new part, see TracePart::index()
+    int newPartIndex() { return _partIndexCount++; }
 
     // reset all manually set directories for source files
     void resetSourceDirs();
@@ -1477,9 +1581,23 @@ private:
     void init();
     // add profile parts from one file
     int internalLoad(QIODevice* file, const QString& filename);
+    // load files in worker threads
+    int parallelLoad(const QStringList& files);
+    void finishLoad(QElapsedTimer& timer);
+    // incremental update of costs for parts with changed active status
+    void updateActivation(const TracePartList& parts);
+    // updateFunctionCycles() without invalidation of costs
+    void detectFunctionCycles();
+    // load data appended to file <filename> from <offset> up to <size>,
+    // returns offset of data consumed
+    qint64 loadAppended(const QString& filename, qint64 offset, qint64 size);
+    // invalidate costs of items with cost in new <parts>
+    void invalidateNewParts(const TracePartList& parts);
 
     // for notification callbacks
     Logger* _logger;
+    LoadStats _loadStats;
+    bool _writeCache;
 
     TracePartList _parts;
 
@@ -1493,7 +1611,10 @@ private:
     ProfileCostArray _totals;
     int _maxThreadID;
     int _maxPartNumber;
+    int _partIndexCount;
 
+    // interned names, keys for the item tables below
+    NameTable _names;
     TraceObjectMap _objectMap;
     TraceClassMap _classMap;
     TraceFileMap _fileMap;
@@ -1502,6 +1623,11 @@ private:
     Arch _arch;
     QString _traceName;
 
+    // follow mode: parsed size of loaded files, and size of files with
+    // new data seen on last loadNewParts(). Path prefix of new files.
+    QHash<QString, qint64> _loadedSizes, _pendingSizes;
+    QString _followPrefix;
+
     // Max of all costs of calls: This allows to see if the incl. cost can
     // be hidden for a cost type, as it is always the same as self cost
     ProfileCostArray _callMax;
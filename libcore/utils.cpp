@@ -23,15 +23,61 @@
 #include "utils.h"
 
 #include <errno.h>
+#include <string.h>
 
 #include <QIODevice>
+#include <QtAlgorithms>
 #include <QFile>
 
+#include "decompressdevice.h"
+
+// buffer size of FixFile in streaming mode
+#define STREAM_BUFFER_SIZE (4*1024*1024)
+
 
 
 // class FixString
 
-FixString::FixString(const char* str, int len)
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
+static const uint64 powersOf10[9] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL };
+
+/**
+ * Parse up to 8 decimal digits at <s> at once, reading 8 bytes:
+ * SWAR ("SIMD within a register") on a 64bit word.
+ * Returns the number of digits, their value in <value>.
+ */
+static inline int parseDigits8(const char* s, uint64& value)
+{
+    uint64 x;
+    memcpy(&x, s, 8);
+
+    // high bit set in bytes which are no digits. Only bytes after
+    // the first non-digit can be wrong due to carries, which is fine
+    uint64 noDigit = ((x - 0x3030303030303030ULL) |
+                      (x + 0x4646464646464646ULL) | x) & 0x8080808080808080ULL;
+    int n = noDigit ? (qCountTrailingZeroBits(noDigit) >> 3) : 8;
+    if (n == 0) return 0;
+
+    // digit values; move to the top bytes, giving leading zeros
+    uint64 d = x - 0x3030303030303030ULL;
+    if (n < 8) d <<= 8 * (8 - n);
+
+    // combine neighbours: 2 digits, 4 digits, 8 digits
+    d = (d * 10 + (d >> 8)) & 0x00FF00FF00FF00FFULL;
+    d = (d * 100 + (d >> 16)) & 0x0000FFFF0000FFFFULL;
+    d = (d * 10000 + (d >> 32)) & 0x00000000FFFFFFFFULL;
+
+    value = d;
+    return n;
+}
+
+#define HAVE_PARSE_DIGITS8 1
+#endif
+
+FixString::FixString(const char* str, int64 len)
 {
     _str = str;
     _len = len;
@@ -56,7 +102,7 @@ bool FixString::stripPrefix(const char* p)
     if (!p || (*p != *_str)) return false;
 
     const char* s = _str+1;
-    int l = _len-1;
+    int64 l = _len-1;
     p++;
     while(*p) {
         if (l==0) return false;
@@ -87,7 +133,7 @@ bool FixString::stripUInt(unsigned int& v, bool stripSpaces)
 
     v = c-'0';
     const char* s = _str+1;
-    int l = _len-1;
+    int64 l = _len-1;
     c = *s;
 
     if ((l>0) && (c == 'x') && (v==0)) {
@@ -112,7 +158,18 @@ bool FixString::stripUInt(unsigned int& v, bool stripSpaces)
     }
     else {
         // decimal
-
+#if HAVE_PARSE_DIGITS8
+        // up to 8 digits at once, as long as 8 bytes are left
+        uint64 digits;
+        int n;
+        while((l >= 8) && ((n = parseDigits8(s, digits)) > 0)) {
+            v = (unsigned int) (v * powersOf10[n] + digits);
+            s += n;
+            l -= n;
+            if (n < 8) break;
+        }
+        c = (l > 0) ? *s : 0;
+#endif
         while(l>0) {
             if (c<'0' || c>'9') break;
             v = 10*v + (c-'0');
@@ -167,7 +224,7 @@ bool FixString::stripName(FixString& s)
     // first char has to be a letter or "_"
     if (!QChar(*_str).isLetter() && (*_str != '_')) return false;
 
-    int newLen = 1;
+    int64 newLen = 1;
     const char* newStr = _str;
 
     _str++;
@@ -191,7 +248,7 @@ FixString FixString::stripUntil(char c)
     if (_len == 0) return FixString();
 
     const char* newStr = _str;
-    int newLen = 0;
+    int64 newLen = 0;
 
     while(_len>0) {
         if (*_str == c) {
@@ -222,7 +279,7 @@ bool FixString::stripUInt64(uint64& v, bool stripSpaces)
 
     v = c-'0';
     const char* s = _str+1;
-    int l = _len-1;
+    int64 l = _len-1;
     c = *s;
 
     if ((l>0) && (c == 'x') && (v==0)) {
@@ -247,6 +304,18 @@ bool FixString::stripUInt64(uint64& v, bool stripSpaces)
     }
     else {
         // decimal
+#if HAVE_PARSE_DIGITS8
+        // up to 8 digits at once, as long as 8 bytes are left
+        uint64 digits;
+        int n;
+        while((l >= 8) && ((n = parseDigits8(s, digits)) > 0)) {
+            v = v * powersOf10[n] + digits;
+            s += n;
+            l -= n;
+            if (n < 8) break;
+        }
+        c = (l > 0) ? *s : 0;
+#endif
         while(l>0) {
             if (c<'0' || c>'9') break;
             v = 10*v + (c-'0');
@@ -285,7 +354,7 @@ bool FixString::stripInt64(int64& v, bool stripSpaces)
 
     v = c-'0';
     const char* s = _str+1;
-    int l = _len-1;
+    int64 l = _len-1;
     c = *s;
 
     if ((l>0) && (c == 'x') && (v==0)) {
@@ -310,7 +379,18 @@ bool FixString::stripInt64(int64& v, bool stripSpaces)
     }
     else {
         // decimal
-
+#if HAVE_PARSE_DIGITS8
+        // up to 8 digits at once, as long as 8 bytes are left
+        uint64 digits;
+        int n;
+        while((l >= 8) && ((n = parseDigits8(s, digits)) > 0)) {
+            v = (int64) (v * powersOf10[n] + digits);
+            s += n;
+            l -= n;
+            if (n < 8) break;
+        }
+        c = (l > 0) ? *s : 0;
+#endif
         while(l>0) {
             if (c<'0' || c>'9') break;
             v = 10*v + (c-'0');
@@ -340,6 +420,9 @@ bool FixString::stripInt64(int64& v, bool stripSpaces)
 FixFile::FixFile(QIODevice* file, const QString& filename)
 {
     _file = file;
+    _consumed = 0;
+    _streaming = false;
+    _sourceEnd = false;
 
     if (!file) {
         _len = 0;
@@ -361,14 +444,29 @@ FixFile::FixFile(QIODevice* file, const QString& filename)
     _openError = false;
     _used_mmap = false;
 
+    if (file->isSequential()) {
+        // data is read on demand in nextLine()
+        _streaming = true;
+        _data.resize(STREAM_BUFFER_SIZE);
+        _base = _data.data();
+        _current = _base;
+        _len = 0;
+        _currentLeft = 0;
+        refill();
+        return;
+    }
+
     uchar* addr = nullptr;
 
+    // data before the current position is skipped (e.g. already loaded)
+    qint64 start = file->pos();
+
 #if QT_VERSION >= 0x040400
     // QFile::map was introduced with Qt 4.4
-    if (file->size() >0) {
+    if (file->size() > start) {
         QFile* mappableDevice = dynamic_cast<QFile*>(file);
         if (mappableDevice) {
-            addr = mappableDevice->map( 0, file->size() );
+            addr = mappableDevice->map( start, file->size() - start );
         }
     }
 #endif
@@ -376,14 +474,14 @@ FixFile::FixFile(QIODevice* file, const QString& filename)
     if (addr) {
         // map succeeded
         _base = (char*) addr;
-        _len = file->size();
+        _len = file->size() - start;
         _used_mmap = true;
 
         if (0) qDebug("Mapped '%s'", qPrintable( _filename ));
     }
     else {
         // try reading the data into memory instead
-        file->seek(0);
+        file->seek(start);
         _data = file->readAll();
         _base = _data.data();
         _len  = _data.size();
@@ -393,6 +491,24 @@ FixFile::FixFile(QIODevice* file, const QString& filename)
     _currentLeft = _len;
 }
 
+FixFile::FixFile(const char* data, uint64 len, const QString& filename)
+{
+    _file = nullptr;
+    _filename = filename;
+    _openError = false;
+    _used_mmap = false;
+    _consumed = 0;
+    _streaming = false;
+    _sourceEnd = true;
+
+    // we never write into the data
+    _base = const_cast<char*>(data);
+    _len = len;
+
+    _current     = _base;
+    _currentLeft = _len;
+}
+
 FixFile::~FixFile()
 {
     // if the file was read into _data, it will be deleted automatically
@@ -408,30 +524,71 @@ FixFile::~FixFile()
     }
 }
 
+// Streaming: move unread data to the buffer start and append more data
+// from the device. Returns false if nothing was added.
+bool FixFile::refill()
+{
+    if (_sourceEnd) return false;
+
+    uint64 keep = _currentLeft;
+    _consumed += _current - _base;
+    memmove(_base, _current, keep);
+
+    // a line longer than the buffer
+    if (keep == (uint64) _data.size()) {
+        _data.resize(2 * _data.size());
+        _base = _data.data();
+    }
+
+    qint64 read = _file->read(_base + keep, _data.size() - keep);
+    if (read <= 0) {
+        if (read < 0)
+            qWarning("%s: %s", (const char*)QFile::encodeName(_filename),
+                     qPrintable(_file->errorString()));
+        _sourceEnd = true;
+        read = 0;
+    }
+
+    _current = _base;
+    _currentLeft = keep + read;
+    _len = _consumed + _currentLeft;
+    return read > 0;
+}
+
 bool FixFile::nextLine(FixString& str)
 {
-    if (_currentLeft == 0) return false;
+    if ((_currentLeft == 0) && !(_streaming && refill())) return false;
 
-    unsigned left = _currentLeft;
+    uint64 left = _currentLeft;
     char* current = _current;
 
-    while(left>0) {
-        if (*current == 0 || *current == '\n') break;
-        current++;
-        left--;
+    // NUL bytes (e.g. holes of sparse files) are part of a line: stopping
+    // at them without skipping would return empty lines forever
+    while(1) {
+        while(left>0) {
+            if (*current == '\n') break;
+            current++;
+            left--;
+        }
+        // in streaming mode, make sure to get the complete line
+        if ((left > 0) || !_streaming) break;
+        uint64 scanned = current - _current;
+        if (!refill()) break;
+        current = _current + scanned;
+        left = _currentLeft - scanned;
     }
 
     if (0) {
         char tmp[200];
-        int l = _currentLeft-left;
+        uint64 l = _currentLeft-left;
         if (l>199) l = 199;
         strncpy(tmp, _current, l);
         tmp[l] = 0;
-        qDebug("[FixFile::nextLine] At %lu, len %u: '%s'",
-               (unsigned long) (_current - _base), _currentLeft-left, tmp);
+        qDebug("[FixFile::nextLine] At %llu, len %llu: '%s'",
+               (uint64) (_current - _base), _currentLeft-left, tmp);
     }
 
-    int len =  _currentLeft-left;
+    int64 len =  _currentLeft-left;
     // get rid of any carriage return at end
     if ((len>0) && (*(current-1) == '\r')) len--;
     str.set(_current, len);
@@ -446,15 +603,28 @@ bool FixFile::nextLine(FixString& str)
     return true;
 }
 
-bool FixFile::setCurrent(unsigned pos)
+bool FixFile::setCurrent(uint64 pos)
 {
-    if (pos > _len) return false;
+    // in streaming mode, data before the buffer is gone
+    if ((pos < _consumed) || (pos > _len)) return false;
 
-    _current = _base + pos;
+    _current = _base + (pos - _consumed);
     _currentLeft = _len - pos;
     return true;
 }
 
+int FixFile::progress() const
+{
+    if (_streaming) {
+        DecompressDevice* d = dynamic_cast<DecompressDevice*>(_file);
+        if (d) return d->progress();
+        return _sourceEnd ? 100 : 0;
+    }
+
+    if (_len == 0) return 100;
+    return (int)(100.0 * (_current - _base) / _len + .5);
+}
+
 
 #if 0
 
@@ -46,9 +46,9 @@ public:
      * the string starting at the char pointer is valid through the
      * lifetime of FixString.
      */
-    FixString(const char*, int len);
+    FixString(const char*, int64 len);
 
-    int len() { return _len; }
+    int64 len() { return _len; }
     const char* ascii() { return _str; }
     bool isEmpty() { return _len == 0; }
     bool isValid() { return _str != nullptr; }
@@ -57,7 +57,7 @@ public:
     bool first(char& c)
     { if (_len==0) return false; c=_str[0]; return true; }
 
-    void set(const char* s, int l) { _str=s; _len=l; }
+    void set(const char* s, int64 l) { _str=s; _len=l; }
     bool stripFirst(char&);
     bool stripPrefix(const char*);
 
@@ -86,21 +86,28 @@ public:
     bool stripInt64(int64&, bool stripSpaces = true);
 
     operator QString() const
-    { return QString::fromLocal8Bit(_str,_len); }
+    { return QString::fromLocal8Bit(_str, (int)_len); }
 
 private:
     const char* _str;
-    int _len;
+    int64 _len;
 };
 
 
 /**
  * A class for fast line by line reading of a read-only ASCII file
+ *
+ * Sequential devices (e.g. decompressing ones) are read in streaming
+ * mode through a buffer: a line returned by nextLine() is only valid
+ * until the next call, and len() is the amount of data seen so far.
+ * Other devices are read from their current position on.
  */
 class FixFile {
 
 public:
     FixFile(QIODevice*, const QString&);
+    // read-only view on data of another FixFile, e.g. for parallel parsing
+    FixFile(const char* data, uint64 len, const QString&);
     ~FixFile();
 
     /**
@@ -110,15 +117,25 @@ public:
      */
     bool nextLine(FixString& str);
     bool exists() { return !_openError; }
-    unsigned len() { return _len; }
-    unsigned current() { return _current - _base; }
-    bool setCurrent(unsigned pos);
+    uint64 len() { return _len; }
+    uint64 current() { return _consumed + (_current - _base); }
+    bool setCurrent(uint64 pos);
     void rewind() { setCurrent(0); }
+    // only valid if not streaming
+    const char* data() const { return _base; }
+    bool isStreaming() const { return _streaming; }
+    // percentage of input read
+    int progress() const;
 
 private:
+    bool refill();
+
     char *_base, *_current;
     QByteArray _data;
-    unsigned _len, _currentLeft;
+    uint64 _len, _currentLeft;
+    // streaming: data before buffer start, end of device reached
+    uint64 _consumed;
+    bool _streaming, _sourceEnd;
     bool _used_mmap, _openError;
     QIODevice* _file;
     QString _filename;
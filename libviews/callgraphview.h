@@ -25,6 +25,7 @@
 
 #include <qwidget.h>
 #include <qmap.h>
+#include <qhash.h>
 #include <qtimer.h>
 
 #include <QGraphicsView>
@@ -230,7 +231,7 @@ private:
 
 
 typedef QMap<TraceFunction*, GraphNode> GraphNodeMap;
-typedef QMap<QPair<TraceFunction*, TraceFunction*>, GraphEdge> GraphEdgeMap;
+typedef QHash<QPair<TraceFunction*, TraceFunction*>, GraphEdge> GraphEdgeMap;
 
 
 /* Abstract Interface for graph options */
@@ -429,6 +429,16 @@ QString FunctionListModel::getCallCount(TraceFunction *f) const
 //
 // FunctionListModel::FunctionLessThan
 //
+
+// compares interned names without decoding them
+static bool nameLessThan(TraceCostItem* i1, TraceCostItem* i2)
+{
+    const TraceData* d = i1->data();
+    if (!d || (i1->nameId() < 0) || (i2->nameId() < 0))
+        return i1->name() < i2->name();
+    return d->names()->compare(i1->nameId(), i2->nameId()) < 0;
+}
+
 bool FunctionListModel::FunctionLessThan::operator()(TraceFunction *left,
                                                      TraceFunction *right)
 {
@@ -461,10 +471,10 @@ bool FunctionListModel::FunctionLessThan::operator()(TraceFunction *left,
         return f1->calledCount() < f2->calledCount();
 
     case 3:
-        return f1->name() < f2->name();
+        return nameLessThan(f1, f2);
 
     case 4:
-        return f1->object()->name() < f2->object()->name();
+        return nameLessThan(f1->object(), f2->object());
     }
 
     return false;
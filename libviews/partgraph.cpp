@@ -342,10 +342,8 @@ TreeMapItemList* PartItem::children()
 
     case ProfileContext::Object:
     {
-        TraceObjectMap::Iterator it;
-        for ( it = _p->data()->objectMap().begin();
-              it != _p->data()->objectMap().end(); ++it ) {
-            c = (*it).findDepFromPart(_p);
+        foreach(TraceObject* o, _p->data()->objectMap().sortedByName()) {
+            c = o->findDepFromPart(_p);
             if (c)
                 addItem(new SubPartItem(c));
         }
@@ -354,10 +352,8 @@ TreeMapItemList* PartItem::children()
 
     case ProfileContext::Class:
     {
-        TraceClassMap::Iterator it;
-        for ( it = _p->data()->classMap().begin();
-              it != _p->data()->classMap().end(); ++it ) {
-            c = (*it).findDepFromPart(_p);
+        foreach(TraceClass* cls, _p->data()->classMap().sortedByName()) {
+            c = cls->findDepFromPart(_p);
             if (c)
                 addItem(new SubPartItem(c));
         }
@@ -366,10 +362,8 @@ TreeMapItemList* PartItem::children()
 
     case ProfileContext::File:
     {
-        TraceFileMap::Iterator it;
-        for ( it = _p->data()->fileMap().begin();
-              it != _p->data()->fileMap().end(); ++it ) {
-            c = (*it).findDepFromPart(_p);
+        foreach(TraceFile* f, _p->data()->fileMap().sortedByName()) {
+            c = f->findDepFromPart(_p);
             if (c)
                 addItem(new SubPartItem(c));
         }
@@ -378,10 +372,8 @@ TreeMapItemList* PartItem::children()
 
     case ProfileContext::Function:
     {
-        TraceFunctionMap::Iterator it;
-        for ( it = _p->data()->functionMap().begin();
-              it != _p->data()->functionMap().end(); ++it ) {
-            c = (*it).findDepFromPart(_p);
+        foreach(TraceFunction* f, _p->data()->functionMap().sortedByName()) {
+            c = f->findDepFromPart(_p);
             if (c)
                 addItem(new SubPartItem(c));
         }
@@ -36,6 +36,7 @@
 #include <QProgressBar>
 #include <QFile>
 #include <QFileDialog>
+#include <QSaveFile>
 #include <QEventLoop>
 #include <QToolBar>
 #include <QComboBox>
@@ -52,6 +53,7 @@
 #include "stackselection.h"
 #include "stackbrowser.h"
 #include "tracedata.h"
+#include "callgrindwriter.h"
 #include "config.h"
 #include "globalguiconfig.h"
 #include "multiview.h"
@@ -361,6 +363,10 @@ void QCGTopLevel::createActions()
     _exportAction->setStatusTip(tr("Generate GraphViz file 'callgraph.dot'"));
     connect(_exportAction, &QAction::triggered, this, &QCGTopLevel::exportGraph);
 
+    _saveAction = new QAction(tr("&Save Active Parts As..."), this);
+    _saveAction->setStatusTip(tr("Write active parts merged into one callgrind file"));
+    connect(_saveAction, &QAction::triggered, this, &QCGTopLevel::saveProfile);
+
     _recentFilesMenuAction = new QAction(tr("Open &Recent"), this);
     _recentFilesMenuAction->setMenu(new QMenu(this));
     connect(_recentFilesMenuAction->menu(), &QMenu::aboutToShow,
@@ -576,6 +582,7 @@ void QCGTopLevel::createMenu()
     fileMenu->addAction(_recentFilesMenuAction);
     fileMenu->addAction(_addAction);
     fileMenu->addSeparator();
+    fileMenu->addAction(_saveAction);
     fileMenu->addAction(_exportAction);
     fileMenu->addSeparator();
     fileMenu->addAction(_exitAction);
@@ -911,6 +918,25 @@ void QCGTopLevel::exportGraph()
 #endif
 }
 
+void QCGTopLevel::saveProfile()
+{
+    if (!_data || _activeParts.isEmpty()) return;
+
+    QString file;
+    file = QFileDialog::getSaveFileName(this,
+                                        tr("Save Active Parts"),
+                                        _lastFile + QStringLiteral(".merged"),
+                                        tr("Callgrind Files (callgrind.*);;All Files (*)"));
+    if (file.isEmpty()) return;
+
+    QSaveFile out(file);
+    CallgrindWriter writer(_data);
+    writer.setParts(_activeParts);
+    if (!out.open(QIODevice::WriteOnly) || !writer.write(&out) || !out.commit())
+        QMessageBox::warning(this, tr("Save Active Parts"),
+                             tr("Could not write the file \"%1\".").arg(file));
+}
+
 
 bool QCGTopLevel::setEventType(QString s)
 {
@@ -2065,6 +2091,14 @@ void QCGTopLevel::loadProgress(int progress)
     showStatus(QStringLiteral("Loading %1").arg(_filename), progress);
 }
 
+void QCGTopLevel::updateProgress(const QString& what, int progress)
+{
+    if (progress < 100)
+        showStatus(QStringLiteral("Updating %1").arg(what), progress);
+    else
+        showStatus(QString(), 0);
+}
+
 void QCGTopLevel::loadError(int line, const QString& msg)
 {
     qCritical() << "Loading" << _filename
@@ -83,6 +83,7 @@ public:
     void loadWarning(int line, const QString& msg) override;
     void loadError(int line, const QString& msg) override;
     void loadFinished(const QString& msg) override; // msg could be error
+    void updateProgress(const QString& what, int progress) override;
 
 public Q_SLOTS:
     void load();
@@ -95,6 +96,7 @@ public Q_SLOTS:
     void loadDelayed(QStringList files, bool addToRecentFiles = true);
 
     void exportGraph();
+    void saveProfile();
     void newWindow();
     void configure(QString page = QString());
     void about();
@@ -219,7 +221,7 @@ private:
 
     // menu/toolbar actions
     QAction *_newAction, *_openAction, *_addAction, *_reloadAction;
-    QAction *_exportAction, *_dumpToggleAction, *_exitAction;
+    QAction *_exportAction, *_saveAction, *_dumpToggleAction, *_exitAction;
     QAction *_sidebarMenuAction, *_recentFilesMenuAction;
     QAction *_cyclesToggleAction, *_percentageToggleAction;
     QAction *_expandedToggleAction, *_hideTemplatesToggleAction;
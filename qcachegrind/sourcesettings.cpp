@@ -57,10 +57,8 @@ SourceSettings::SourceSettings(TraceData* data, QWidget* parent)
 
     QStringList objItems(_always);
     if (data) {
-        TraceObjectMap::Iterator oit;
-        for ( oit = data->objectMap().begin();
-              oit != data->objectMap().end(); ++oit ) {
-            QString n = (*oit).name();
+        foreach(TraceObject* o, data->objectMap().sortedByName()) {
+            QString n = o->name();
             if (n.isEmpty()) continue;
             objItems << n;
 